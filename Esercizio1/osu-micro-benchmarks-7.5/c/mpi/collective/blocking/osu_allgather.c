@@ -17,6 +17,7 @@ int main(int argc, char *argv[])
     double timer = 0.0;
     double avg_time = 0.0, max_time = 0.0, min_time = 0.0;
     char *sendbuf, *recvbuf;
+    void *sbuf = NULL, *rbuf = NULL;
     int po_ret;
     int errors = 0, local_errors = 0;
     size_t bufsize;
@@ -29,6 +30,7 @@ int main(int argc, char *argv[])
     MPI_Datatype omb_curr_datatype = MPI_CHAR;
     size_t omb_ddt_transmit_size = 0;
     int mpi_type_itr = 0, mpi_type_size = 0, mpi_type_name_length = 0;
+    int omb_sweep_itr = 0, omb_sweep_num = 0;
     char mpi_type_name_str[OMB_DATATYPE_STR_MAX_LEN];
     MPI_Datatype mpi_type_list[OMB_NUM_DATATYPES];
     MPI_Comm omb_comm = MPI_COMM_NULL;
@@ -108,113 +110,133 @@ int main(int argc, char *argv[])
     print_preamble(rank);
     omb_papi_init(&papi_eventset);
 
-    for (mpi_type_itr = 0; mpi_type_itr < options.omb_dtype_itr;
-         mpi_type_itr++) {
-        MPI_CHECK(MPI_Type_size(mpi_type_list[mpi_type_itr], &mpi_type_size));
-        MPI_CHECK(MPI_Type_get_name(mpi_type_list[mpi_type_itr],
-                                    mpi_type_name_str, &mpi_type_name_length));
-        omb_curr_datatype = mpi_type_list[mpi_type_itr];
-        OMB_MPI_RUN_AT_RANK_ZERO(
-            fprintf(stdout, "# Datatype: %s.\n", mpi_type_name_str));
-        fflush(stdout);
-        print_only_header(rank);
-        for (size = options.min_message_size; size <= options.max_message_size;
-             size *= 2) {
-            num_elements = size / mpi_type_size;
-            if (0 == num_elements) {
-                continue;
-            }
-            if (size > LARGE_MESSAGE_SIZE) {
-                options.skip = options.skip_large;
-                options.iterations = options.iterations_large;
-            }
-
-            omb_graph_allocate_and_get_data_buffer(
-                &omb_graph_data, &omb_graph_options, size, options.iterations);
-            MPI_CHECK(MPI_Barrier(omb_comm));
-            timer = 0.0;
-            omb_ddt_transmit_size =
-                omb_ddt_assign(&omb_curr_datatype, mpi_type_list[mpi_type_itr],
-                               num_elements) *
-                mpi_type_size;
-            num_elements = omb_ddt_get_size(num_elements);
-            for (i = 0; i < options.iterations + options.skip; i++) {
-                if (i == options.skip) {
-                    omb_papi_start(&papi_eventset);
+    omb_sweep_num = omb_sweep_init(omb_init_h.omb_comm, rank);
+    for (omb_sweep_itr = 0; omb_sweep_itr < omb_sweep_num; omb_sweep_itr++) {
+        omb_comm = omb_sweep_select(omb_sweep_itr, omb_init_h.omb_comm, rank);
+        if (MPI_COMM_NULL == omb_comm) {
+            continue;
+        }
+        MPI_CHECK(MPI_Comm_rank(omb_comm, &rank));
+        MPI_CHECK(MPI_Comm_size(omb_comm, &numprocs));
+        for (mpi_type_itr = 0; mpi_type_itr < options.omb_dtype_itr;
+             mpi_type_itr++) {
+            MPI_CHECK(MPI_Type_size(mpi_type_list[mpi_type_itr],
+                                    &mpi_type_size));
+            MPI_CHECK(MPI_Type_get_name(mpi_type_list[mpi_type_itr],
+                                        mpi_type_name_str,
+                                        &mpi_type_name_length));
+            omb_curr_datatype = mpi_type_list[mpi_type_itr];
+            OMB_MPI_RUN_AT_RANK_ZERO(
+                fprintf(stdout, "# Datatype: %s.\n", mpi_type_name_str));
+            fflush(stdout);
+            print_only_header(rank);
+            for (size = options.min_message_size;
+                 size <= options.max_message_size; size *= 2) {
+                num_elements = size / mpi_type_size;
+                if (0 == num_elements) {
+                    continue;
                 }
-                if (options.validate) {
-                    set_buffer_validation(sendbuf, recvbuf, size, options.accel,
-                                          i, omb_curr_datatype,
-                                          omb_buffer_sizes);
-                    for (j = 0; j < options.warmup_validation; j++) {
+                if (size > LARGE_MESSAGE_SIZE) {
+                    options.skip = options.skip_large;
+                    options.iterations = options.iterations_large;
+                }
+
+                omb_graph_allocate_and_get_data_buffer(&omb_graph_data,
+                                                       &omb_graph_options, size,
+                                                       options.iterations);
+                MPI_CHECK(MPI_Barrier(omb_comm));
+                timer = 0.0;
+                omb_ddt_transmit_size =
+                    omb_ddt_assign(&omb_curr_datatype,
+                                   mpi_type_list[mpi_type_itr], num_elements) *
+                    mpi_type_size;
+                num_elements = omb_ddt_get_size(num_elements);
+                for (i = 0; i < options.iterations + options.skip; i++) {
+                    if (i == options.skip) {
+                        omb_papi_start(&papi_eventset);
+                    }
+                    if (options.validate) {
+                        set_buffer_validation(
+                            sendbuf, recvbuf, size, options.accel, i,
+                            omb_curr_datatype, omb_buffer_sizes);
+                        for (j = 0; j < options.warmup_validation; j++) {
+                            MPI_CHECK(MPI_Barrier(omb_comm));
+                            MPI_CHECK(MPI_Allgather(
+                                sendbuf, num_elements, omb_curr_datatype,
+                                recvbuf, num_elements, omb_curr_datatype,
+                                omb_comm));
+                        }
                         MPI_CHECK(MPI_Barrier(omb_comm));
-                        MPI_CHECK(MPI_Allgather(
-                            sendbuf, num_elements, omb_curr_datatype, recvbuf,
-                            num_elements, omb_curr_datatype, omb_comm));
                     }
-                    MPI_CHECK(MPI_Barrier(omb_comm));
-                }
 
-                t_start = MPI_Wtime();
-                MPI_CHECK(MPI_Allgather(
-                    sendbuf, num_elements, omb_curr_datatype, recvbuf,
-                    num_elements, omb_curr_datatype, omb_comm));
+                    sbuf = omb_cache_buf(sendbuf, size, i, OMB_CACHE_SBUF);
+                    rbuf = omb_cache_buf(recvbuf, size * numprocs, i,
+                                         OMB_CACHE_RBUF);
+                    t_start = omb_sync_start_wait(omb_comm, i);
+                    MPI_CHECK(MPI_Allgather(
+                        sbuf, num_elements, omb_curr_datatype, rbuf,
+                        num_elements, omb_curr_datatype, omb_comm));
 
-                t_stop = MPI_Wtime();
-                MPI_CHECK(MPI_Barrier(omb_comm));
+                    t_stop = MPI_Wtime();
 
-                if (options.validate) {
-                    local_errors +=
-                        validate_data(recvbuf, size, numprocs, options.accel, i,
-                                      omb_curr_datatype);
-                }
-                if (i >= options.skip) {
-                    timer += t_stop - t_start;
-                    if (options.omb_tail_lat) {
-                        omb_lat_arr[i - options.skip] =
-                            (t_stop - t_start) * 1e6;
+                    omb_sync_start_end(i, t_start, t_stop);
+                    MPI_CHECK(MPI_Barrier(omb_comm));
+
+                    if (options.validate) {
+                        local_errors += validate_data(recvbuf, size, numprocs,
+                                                      options.accel, i,
+                                                      omb_curr_datatype);
                     }
-                    if (options.graph && 0 == rank) {
-                        omb_graph_data->data[i - options.skip] =
-                            (t_stop - t_start) * 1e6;
+                    if (i >= options.skip) {
+                        timer += t_stop - t_start;
+                        if (options.omb_tail_lat) {
+                            omb_lat_arr[i - options.skip] =
+                                (t_stop - t_start) * 1e6;
+                        }
+                        if (options.graph && 0 == rank) {
+                            omb_graph_data->data[i - options.skip] =
+                                (t_stop - t_start) * 1e6;
+                        }
                     }
                 }
-            }
 
-            MPI_CHECK(MPI_Barrier(omb_comm));
-            omb_papi_stop_and_print(&papi_eventset, size);
+                MPI_CHECK(MPI_Barrier(omb_comm));
+                omb_papi_stop_and_print(&papi_eventset, size);
 
-            latency = (double)(timer * 1e6) / options.iterations;
+                latency = (double)(timer * 1e6) / options.iterations;
 
-            MPI_CHECK(MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0,
-                                 omb_comm));
-            MPI_CHECK(MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0,
-                                 omb_comm));
-            MPI_CHECK(MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM, 0,
-                                 omb_comm));
-            avg_time = avg_time / numprocs;
-            omb_stat = omb_get_stats(omb_lat_arr);
+                MPI_CHECK(MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE,
+                                     MPI_MIN, 0, omb_comm));
+                MPI_CHECK(MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE,
+                                     MPI_MAX, 0, omb_comm));
+                MPI_CHECK(MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE,
+                                     MPI_SUM, 0, omb_comm));
+                avg_time = avg_time / numprocs;
+                omb_sync_start_record(omb_comm, size);
+                omb_stat = omb_get_stats(omb_lat_arr);
 
-            if (options.validate) {
-                MPI_CHECK(MPI_Allreduce(&local_errors, &errors, 1, MPI_INT,
-                                        MPI_SUM, omb_comm));
-            }
+                if (options.validate) {
+                    MPI_CHECK(MPI_Allreduce(&local_errors, &errors, 1, MPI_INT,
+                                            MPI_SUM, omb_comm));
+                }
 
-            if (options.validate) {
-                print_stats_validate(rank, size, avg_time, min_time, max_time,
-                                     errors, omb_stat);
-            } else {
-                print_stats(rank, size, avg_time, min_time, max_time, omb_stat);
-            }
-            if (options.graph && 0 == rank) {
-                omb_graph_data->avg = avg_time;
-            }
-            omb_ddt_append_stats(omb_ddt_transmit_size);
-            omb_ddt_free(&omb_curr_datatype);
-            MPI_CHECK(MPI_Barrier(omb_comm));
+                if (options.validate) {
+                    print_stats_validate(rank, size, avg_time, min_time,
+                                         max_time, errors, omb_stat);
+                } else {
+                    print_stats(rank, size, avg_time, min_time, max_time,
+                                omb_stat);
+                }
+                if (options.graph && 0 == rank) {
+                    omb_graph_data->avg = avg_time;
+                }
+                omb_ddt_append_stats(omb_ddt_transmit_size);
+                omb_ddt_free(&omb_curr_datatype);
+                MPI_CHECK(MPI_Barrier(omb_comm));
 
-            if (0 != errors) {
-                break;
+                if (0 != errors) {
+                    break;
+                }
             }
         }
     }
@@ -230,6 +252,8 @@ int main(int argc, char *argv[])
     }
     free_buffer(recvbuf, options.accel);
     free(omb_lat_arr);
+    omb_sync_start_finalize(rank);
+    omb_sweep_finalize(omb_init_h.omb_comm, rank);
     omb_mpi_finalize(omb_init_h);
 
     if (NONE != options.accel) {
@@ -18,6 +18,7 @@ int main(int argc, char *argv[])
     double latency = 0.0, t_start = 0.0, t_stop = 0.0;
     double timer = 0.0;
     int po_ret;
+    int omb_sweep_itr = 0, omb_sweep_num = 0;
     omb_graph_options_t omb_graph_options;
     omb_graph_data_t *omb_graph_data = NULL;
     int papi_eventset = OMB_PAPI_NULL;
@@ -85,46 +86,55 @@ int main(int argc, char *argv[])
     omb_graph_allocate_and_get_data_buffer(&omb_graph_data, &omb_graph_options,
                                            1, options.iterations);
     print_preamble(rank);
-    print_only_header(rank);
     omb_papi_init(&papi_eventset);
 
-    timer = 0.0;
-
-    for (i = 0; i < options.iterations + options.skip; i++) {
-        if (i == options.skip) {
-            omb_papi_start(&papi_eventset);
+    omb_sweep_num = omb_sweep_init(omb_init_h.omb_comm, rank);
+    for (omb_sweep_itr = 0; omb_sweep_itr < omb_sweep_num; omb_sweep_itr++) {
+        omb_comm = omb_sweep_select(omb_sweep_itr, omb_init_h.omb_comm, rank);
+        if (MPI_COMM_NULL == omb_comm) {
+            continue;
         }
-        t_start = MPI_Wtime();
-        MPI_CHECK(MPI_Barrier(omb_comm));
-        t_stop = MPI_Wtime();
-
-        if (i >= options.skip) {
-            timer += t_stop - t_start;
-            if (options.omb_tail_lat) {
-                omb_lat_arr[i - options.skip] = (t_stop - t_start) * 1e6;
+        MPI_CHECK(MPI_Comm_rank(omb_comm, &rank));
+        MPI_CHECK(MPI_Comm_size(omb_comm, &numprocs));
+        print_only_header(rank);
+        timer = 0.0;
+
+        for (i = 0; i < options.iterations + options.skip; i++) {
+            if (i == options.skip) {
+                omb_papi_start(&papi_eventset);
             }
-            if (options.graph && 0 == rank) {
-                omb_graph_data->data[i - options.skip] =
-                    (t_stop - t_start) * 1e6;
+            t_start = MPI_Wtime();
+            MPI_CHECK(MPI_Barrier(omb_comm));
+            t_stop = MPI_Wtime();
+
+            if (i >= options.skip) {
+                timer += t_stop - t_start;
+                if (options.omb_tail_lat) {
+                    omb_lat_arr[i - options.skip] = (t_stop - t_start) * 1e6;
+                }
+                if (options.graph && 0 == rank) {
+                    omb_graph_data->data[i - options.skip] =
+                        (t_stop - t_start) * 1e6;
+                }
             }
         }
-    }
 
-    MPI_CHECK(MPI_Barrier(omb_comm));
-    omb_papi_stop_and_print(&papi_eventset, 0);
+        MPI_CHECK(MPI_Barrier(omb_comm));
+        omb_papi_stop_and_print(&papi_eventset, 0);
 
-    latency = (timer * 1e6) / options.iterations;
+        latency = (timer * 1e6) / options.iterations;
 
-    MPI_CHECK(
-        MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0, omb_comm));
-    MPI_CHECK(
-        MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0, omb_comm));
-    MPI_CHECK(
-        MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM, 0, omb_comm));
-    avg_time = avg_time / numprocs;
-    omb_stat = omb_get_stats(omb_lat_arr);
+        MPI_CHECK(MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0,
+                             omb_comm));
+        MPI_CHECK(MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0,
+                             omb_comm));
+        MPI_CHECK(MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM, 0,
+                             omb_comm));
+        avg_time = avg_time / numprocs;
+        omb_stat = omb_get_stats(omb_lat_arr);
 
-    print_stats(rank, 0, avg_time, min_time, max_time, omb_stat);
+        print_stats(rank, 0, avg_time, min_time, max_time, omb_stat);
+    }
     if (0 == rank && options.graph) {
         omb_graph_data->avg = avg_time;
         omb_graph_plot(&omb_graph_options, benchmark_name);
@@ -132,6 +142,7 @@ int main(int argc, char *argv[])
         omb_graph_free_data_buffers(&omb_graph_options);
     }
     omb_papi_free(&papi_eventset);
+    omb_sweep_finalize(omb_init_h.omb_comm, rank);
     omb_mpi_finalize(omb_init_h);
     free(omb_lat_arr);
 
@@ -0,0 +1,806 @@
+#define BENCHMARK "OSU MPI%s Collective Tuning Test"
+/*
+ * Copyright (c) 2002-2024 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * Picks the fastest algorithm of Open MPI's tuned component for every
+ * collective, communicator size and message size, and writes the picks as
+ * a dynamic rules file the library can load:
+ *
+ *   mpirun --mca coll_tuned_use_dynamic_rules 1 osu_coll_tune -S 16,64
+ *   mpirun --mca coll_tuned_use_dynamic_rules 1 \
+ *          --mca coll_tuned_dynamic_rules_filename osu_tune.rules ./app
+ *
+ * Every algorithm of -A (by default all but the library's own choice) is
+ * tried with every segment size of -E, each pair on a communicator
+ * duplicated after forcing it through the MPI tool interface. The pairs
+ * race in rounds of -i iterations: after the first round the pairs more
+ * than TUNE_DROP_RATIO times slower than the best drop out, from round
+ * TUNE_MIN_ROUNDS on the pairs whose 95% confidence interval lies above
+ * the best's. The race stops with one pair left or after TUNE_MAX_ROUNDS
+ * rounds, and the pick is then marked as not confident; a tie keeps the
+ * pick of the previous message size if it is still in. A pair losing by
+ * TUNE_RETIRE_RATIO at TUNE_RETIRE_SIZES message sizes in a row is not
+ * tried on larger ones. Samples are the slowest rank's average, so all
+ * ranks take the same decisions.
+ *
+ * As in Open MPI, rules match gather, scatter, allgather and alltoall on
+ * the size summed over the processes and the others on the size per rank.
+ * PREFIX.json keeps every pick with its latency and interval.
+ */
+#include <osu_util_mpi.h>
+
+#define TUNE_MIN_ROUNDS    3
+#define TUNE_MAX_ROUNDS    10
+#define TUNE_DROP_RATIO    2.0
+#define TUNE_RETIRE_RATIO  4.0
+#define TUNE_RETIRE_SIZES  3
+#define TUNE_MAX_SEGSIZES  16
+#define TUNE_LABEL_WIDTH   28
+#define TUNE_SEGSIZE_CVAR  "%s_segmentsize"
+#define TUNE_RULES_SUFFIX  ".rules"
+#define TUNE_JSON_SUFFIX   ".json"
+
+enum tune_coll {
+    TUNE_BCAST,
+    TUNE_REDUCE,
+    TUNE_ALLREDUCE,
+    TUNE_GATHER,
+    TUNE_SCATTER,
+    TUNE_ALLGATHER,
+    TUNE_ALLTOALL,
+    NUM_COLLS
+};
+
+static const char *coll_names[NUM_COLLS] = {
+    "bcast",   "reduce",    "allreduce", "gather",
+    "scatter", "allgather", "alltoall"};
+
+/* Collective ids of the rules file, COLLTYPE_T of Open MPI's coll_base */
+static const int coll_ids[NUM_COLLS] = {7, 11, 2, 9, 15, 0, 3};
+
+/* 97.5% quantiles of Student's t distribution by degrees of freedom */
+static const double t_quantiles[TUNE_MAX_ROUNDS - 1] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262};
+
+struct tune_config {
+    int algo;
+    int segsize;
+    char name[OMB_ALGO_NAME_MAX_LEN];
+    MPI_Comm comm;
+    int alive;
+    int retired;
+    int dominated; /* message sizes in a row lost by TUNE_RETIRE_RATIO */
+    int n;
+    double sum;
+    double sumsq;
+};
+
+struct tune_pick {
+    int coll;
+    int nprocs;
+    int size;
+    int algo;
+    int segsize;
+    int rounds;
+    int confident;
+    double mean;
+    double ci; /* negative after a single round */
+    char name[OMB_ALGO_NAME_MAX_LEN];
+};
+
+static struct tune_pick *picks = NULL;
+static int num_picks = 0;
+
+static int is_reduction(int coll)
+{
+    return TUNE_REDUCE == coll || TUNE_ALLREDUCE == coll;
+}
+
+static int rule_bytes(const struct tune_pick *pick)
+{
+    return pick->size * (pick->coll >= TUNE_GATHER ? pick->nprocs : 1);
+}
+
+static int in_list(const int *list, int n, int value)
+{
+    int itr = 0;
+
+    for (itr = 0; itr < n; itr++) {
+        if (list[itr] == value) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int parse_colls(const char *list, int *colls, int rank)
+{
+    int n = 0, c = 0;
+    char copy[OMB_ALGO_LIST_MAX_LEN], *token = NULL;
+
+    strcpy(copy, list);
+    for (token = strtok(copy, ","); NULL != token; token = strtok(NULL, ",")) {
+        for (c = 0; c < NUM_COLLS && 0 != strcasecmp(token, coll_names[c]);
+             c++) {
+        }
+        if (NUM_COLLS == c) {
+            if (0 == rank) {
+                fprintf(stderr, "Cannot tune collective %s\n", token);
+            }
+            return -1;
+        }
+        if (!in_list(colls, n, c)) {
+            colls[n++] = c;
+        }
+    }
+    if (0 == n && 0 == rank) {
+        fprintf(stderr, "No collective to tune\n");
+    }
+    return n;
+}
+
+static int parse_segsizes(const char *list, int *segsizes, int rank)
+{
+    int n = 0;
+    char copy[OMB_ALGO_LIST_MAX_LEN], *token = NULL;
+
+    strcpy(copy, list);
+    for (token = strtok(copy, ","); NULL != token; token = strtok(NULL, ",")) {
+        if (TUNE_MAX_SEGSIZES == n) {
+            if (0 == rank) {
+                fprintf(stderr, "At most %d segment sizes\n",
+                        TUNE_MAX_SEGSIZES);
+            }
+            return -1;
+        }
+        segsizes[n++] = atoi(token);
+    }
+    if (0 == n) {
+        segsizes[n++] = 0;
+    }
+    return n;
+}
+
+/* Reads or writes an integer control variable */
+static void cvar_access(int cvar_index, int *value, int write)
+{
+    int count = 0;
+    MPI_T_cvar_handle handle;
+
+    MPI_CHECK(MPI_T_cvar_handle_alloc(cvar_index, NULL, &handle, &count));
+    if (write) {
+        MPI_CHECK(MPI_T_cvar_write(handle, value));
+    } else {
+        MPI_CHECK(MPI_T_cvar_read(handle, value));
+    }
+    MPI_CHECK(MPI_T_cvar_handle_free(&handle));
+}
+
+static void add_algo(int *algos, char (*names)[OMB_ALGO_NAME_MAX_LEN],
+                     int *num_algos, int value, const char *name)
+{
+    if (in_list(algos, *num_algos, value)) {
+        return;
+    }
+    if (OMB_ALGO_MAX_NUM == *num_algos) {
+        OMB_ERROR_EXIT("Too many algorithms");
+    }
+    algos[*num_algos] = value;
+    snprintf(names[*num_algos], OMB_ALGO_NAME_MAX_LEN, "%s", name);
+    (*num_algos)++;
+}
+
+/*
+ * Resolves the algorithm list against the control variable of the
+ * collective, by number or by the names the library reports, and makes a
+ * communicator for each algorithm and segment size.
+ */
+static int init_configs(int coll, MPI_Comm comm, const char *algo_list,
+                        const int *segsizes, int num_segsizes,
+                        struct tune_config **configs)
+{
+    int nprocs = 0, algo_index = 0, seg_index = -1, name_len = 0;
+    int desc_len = 0, verbosity = 0, bind = 0, scope = 0, num_items = 0;
+    int item = 0, value = 0, item_value = 0, found = 0, all = 0;
+    int algos[OMB_ALGO_MAX_NUM], num_algos = 0, a = 0, s = 0, n = 0;
+    int algo_default = 0, seg_default = 0;
+    char names[OMB_ALGO_MAX_NUM][OMB_ALGO_NAME_MAX_LEN];
+    char cvar_name[OMB_ALGO_NAME_MAX_LEN], seg_name[OMB_ALGO_NAME_MAX_LEN];
+    char item_name[OMB_ALGO_NAME_MAX_LEN], desc[OMB_ALGO_NAME_MAX_LEN];
+    char message[2 * OMB_ALGO_NAME_MAX_LEN];
+    char list[OMB_ALGO_LIST_MAX_LEN], *token = NULL, *end = NULL;
+    MPI_Datatype cvar_type;
+    MPI_T_enum enum_type = MPI_T_ENUM_NULL;
+    struct tune_config *config = NULL;
+
+    MPI_CHECK(MPI_Comm_size(comm, &nprocs));
+    snprintf(cvar_name, sizeof(cvar_name), OMB_ALGO_CVAR_FORMAT,
+             coll_names[coll]);
+    if (MPI_SUCCESS != MPI_T_cvar_get_index(cvar_name, &algo_index)) {
+        snprintf(message, sizeof(message),
+                 "Control variable %s not found, this test needs Open MPI's"
+                 " tuned component",
+                 cvar_name);
+        OMB_ERROR_EXIT(message);
+    }
+    name_len = desc_len = OMB_ALGO_NAME_MAX_LEN;
+    MPI_CHECK(MPI_T_cvar_get_info(algo_index, item_name, &name_len,
+                                  &verbosity, &cvar_type, &enum_type, desc,
+                                  &desc_len, &bind, &scope));
+    if (MPI_T_ENUM_NULL != enum_type) {
+        name_len = OMB_ALGO_NAME_MAX_LEN;
+        MPI_CHECK(MPI_T_enum_get_info(enum_type, &num_items, item_name,
+                                      &name_len));
+    }
+
+    strcpy(list, algo_list);
+    for (token = strtok(list, ","); NULL != token; token = strtok(NULL, ",")) {
+        all = (0 == strcasecmp(token, "all"));
+        value = strtol(token, &end, 10);
+        found = 0;
+        for (item = 0; item < num_items; item++) {
+            name_len = OMB_ALGO_NAME_MAX_LEN;
+            MPI_CHECK(MPI_T_enum_get_item(enum_type, item, &item_value,
+                                          item_name, &name_len));
+            if (all) {
+                /* 0 leaves the choice to the library, two_proc needs two */
+                if (0 == item_value ||
+                    (2 != nprocs && NULL != strstr(item_name, "two_proc"))) {
+                    continue;
+                }
+            } else if ('\0' == *end ? item_value != value :
+                                      0 != strcasecmp(item_name, token)) {
+                continue;
+            }
+            add_algo(algos, names, &num_algos, item_value, item_name);
+            found = 1;
+        }
+        if (!found && !all && MPI_T_ENUM_NULL == enum_type && '\0' == *end) {
+            add_algo(algos, names, &num_algos, value, token);
+            found = 1;
+        }
+        if (!found && !all) {
+            snprintf(message, sizeof(message), "Unknown algorithm %s for %s",
+                     token, cvar_name);
+            OMB_ERROR_EXIT(message);
+        }
+    }
+    if (0 == num_algos) {
+        snprintf(message, sizeof(message), "No algorithm to try for %s",
+                 cvar_name);
+        OMB_ERROR_EXIT(message);
+    }
+
+    /* Without a segment size variable only the default one is tried */
+    if ((int)sizeof(seg_name) <= snprintf(seg_name, sizeof(seg_name),
+                                          TUNE_SEGSIZE_CVAR, cvar_name) ||
+        MPI_SUCCESS != MPI_T_cvar_get_index(seg_name, &seg_index)) {
+        seg_index = -1;
+        num_segsizes = 1;
+    }
+    *configs = malloc(num_algos * num_segsizes * sizeof(struct tune_config));
+    OMB_CHECK_NULL_AND_EXIT(*configs, "Unable to allocate memory");
+    cvar_access(algo_index, &algo_default, 0);
+    if (0 <= seg_index) {
+        cvar_access(seg_index, &seg_default, 0);
+    }
+    for (a = 0; a < num_algos; a++) {
+        for (s = 0; s < num_segsizes; s++) {
+            config = &(*configs)[n++];
+            memset(config, 0, sizeof(struct tune_config));
+            config->algo = algos[a];
+            config->segsize = (0 <= seg_index) ? segsizes[s] : 0;
+            strcpy(config->name, names[a]);
+            cvar_access(algo_index, &config->algo, 1);
+            if (0 <= seg_index) {
+                cvar_access(seg_index, &config->segsize, 1);
+            }
+            /* The tuned component reads the forced values here */
+            MPI_CHECK(MPI_Comm_dup(comm, &config->comm));
+        }
+    }
+    cvar_access(algo_index, &algo_default, 1);
+    if (0 <= seg_index) {
+        cvar_access(seg_index, &seg_default, 1);
+    }
+    return n;
+}
+
+static void call_coll(int coll, MPI_Comm comm, char *sbuf, char *rbuf,
+                      int size)
+{
+    int count = MAX(size / (int)sizeof(float), 1);
+
+    switch (coll) {
+        case TUNE_BCAST:
+            MPI_CHECK(MPI_Bcast(sbuf, size, MPI_CHAR, 0, comm));
+            break;
+        case TUNE_REDUCE:
+            MPI_CHECK(
+                MPI_Reduce(sbuf, rbuf, count, MPI_FLOAT, MPI_SUM, 0, comm));
+            break;
+        case TUNE_ALLREDUCE:
+            MPI_CHECK(
+                MPI_Allreduce(sbuf, rbuf, count, MPI_FLOAT, MPI_SUM, comm));
+            break;
+        case TUNE_GATHER:
+            MPI_CHECK(MPI_Gather(sbuf, size, MPI_CHAR, rbuf, size, MPI_CHAR, 0,
+                                 comm));
+            break;
+        case TUNE_SCATTER:
+            MPI_CHECK(MPI_Scatter(sbuf, size, MPI_CHAR, rbuf, size, MPI_CHAR,
+                                  0, comm));
+            break;
+        case TUNE_ALLGATHER:
+            MPI_CHECK(MPI_Allgather(sbuf, size, MPI_CHAR, rbuf, size, MPI_CHAR,
+                                    comm));
+            break;
+        case TUNE_ALLTOALL:
+            MPI_CHECK(MPI_Alltoall(sbuf, size, MPI_CHAR, rbuf, size, MPI_CHAR,
+                                   comm));
+            break;
+    }
+}
+
+/* One round: the slowest rank's average time per call */
+static double sample(int coll, MPI_Comm comm, char *sbuf, char *rbuf,
+                     int size, int warmup)
+{
+    int i = 0;
+    double t_start = 0.0, latency = 0.0;
+
+    for (i = 0; i < warmup; i++) {
+        call_coll(coll, comm, sbuf, rbuf, size);
+    }
+    MPI_CHECK(MPI_Barrier(comm));
+    t_start = MPI_Wtime();
+    for (i = 0; i < options.iterations; i++) {
+        call_coll(coll, comm, sbuf, rbuf, size);
+    }
+    latency = (MPI_Wtime() - t_start) * 1e6 / options.iterations;
+    MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &latency, 1, MPI_DOUBLE, MPI_MAX,
+                            comm));
+    return latency;
+}
+
+static double config_mean(const struct tune_config *config)
+{
+    return config->sum / config->n;
+}
+
+static double config_ci(const struct tune_config *config)
+{
+    double mean = 0.0, var = 0.0;
+
+    if (2 > config->n) {
+        return -1.0;
+    }
+    mean = config_mean(config);
+    var = (config->sumsq - config->n * mean * mean) / (config->n - 1);
+    return t_quantiles[config->n - 2] * sqrt(MAX(var, 0.0) / config->n);
+}
+
+static int best_config(const struct tune_config *configs, int num_configs)
+{
+    int c = 0, best = -1;
+
+    for (c = 0; c < num_configs; c++) {
+        if (configs[c].alive &&
+            (0 > best ||
+             config_mean(&configs[c]) < config_mean(&configs[best]))) {
+            best = c;
+        }
+    }
+    return best;
+}
+
+/*
+ * Races the configurations left on one message size and returns the pick.
+ * When the race ends undecided and the pick of the previous size is still
+ * in, that one is kept, so that ties do not split the rules.
+ */
+static int race(int coll, struct tune_config *configs, int num_configs,
+                char *sbuf, char *rbuf, int size, int prev,
+                struct tune_pick *pick)
+{
+    int c = 0, round = 0, best = 0, num_alive = 0;
+    double x = 0.0, best_upper = 0.0;
+    struct tune_config *config = NULL;
+
+    for (c = 0; c < num_configs; c++) {
+        configs[c].alive = !configs[c].retired;
+        configs[c].n = 0;
+        configs[c].sum = configs[c].sumsq = 0.0;
+    }
+    for (round = 0; round < TUNE_MAX_ROUNDS; round++) {
+        for (c = 0; c < num_configs; c++) {
+            config = &configs[c];
+            if (!config->alive) {
+                continue;
+            }
+            x = sample(coll, config->comm, sbuf, rbuf, size,
+                       (0 == round) ? options.skip : 0);
+            config->n++;
+            config->sum += x;
+            config->sumsq += x * x;
+        }
+        best = best_config(configs, num_configs);
+        best_upper = config_mean(&configs[best]) +
+                     MAX(config_ci(&configs[best]), 0.0);
+        num_alive = 0;
+        for (c = 0; c < num_configs; c++) {
+            config = &configs[c];
+            if (!config->alive || c == best) {
+                num_alive += config->alive;
+                continue;
+            }
+            if (0 == round) {
+                config->alive = (config_mean(config) <=
+                                 TUNE_DROP_RATIO * config_mean(&configs[best]));
+            } else if (round + 1 >= TUNE_MIN_ROUNDS) {
+                config->alive =
+                    (config_mean(config) - config_ci(config) <= best_upper);
+            }
+            num_alive += config->alive;
+        }
+        if (1 == num_alive) {
+            break;
+        }
+    }
+
+    if (1 < num_alive && 0 <= prev && configs[prev].alive) {
+        best = prev;
+    }
+    for (c = 0; c < num_configs; c++) {
+        config = &configs[c];
+        if (config->retired || c == best) {
+            continue;
+        }
+        if (config_mean(config) >
+            TUNE_RETIRE_RATIO * config_mean(&configs[best])) {
+            config->retired = (++config->dominated >= TUNE_RETIRE_SIZES);
+        } else {
+            config->dominated = 0;
+        }
+    }
+    config = &configs[best];
+    pick->algo = config->algo;
+    pick->segsize = config->segsize;
+    pick->rounds = config->n;
+    pick->confident = (1 == num_alive);
+    pick->mean = config_mean(config);
+    pick->ci = config_ci(config);
+    snprintf(pick->name, OMB_ALGO_NAME_MAX_LEN, "%s", config->name);
+    return best;
+}
+
+static void print_pick(const struct tune_pick *pick)
+{
+    char label[OMB_ALGO_NAME_MAX_LEN + 16];
+
+    snprintf(label, sizeof(label), "%s (%d)", pick->name, pick->algo);
+    fprintf(stdout, "%-*d%-*s%*d%*.*f", 10, pick->size, TUNE_LABEL_WIDTH,
+            label, 10, pick->segsize, FIELD_WIDTH, FLOAT_PRECISION,
+            pick->mean);
+    if (0 > pick->ci) {
+        fprintf(stdout, "%*s", FIELD_WIDTH, "-");
+    } else {
+        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, pick->ci);
+    }
+    fprintf(stdout, "%*d%*s\n", 8, pick->rounds, 12,
+            pick->confident ? "yes" : "no");
+    fflush(stdout);
+}
+
+static void tune_coll(int coll, MPI_Comm comm, const char *algo_list,
+                      const int *segsizes, int num_segsizes, char *sbuf,
+                      char *rbuf, int rank)
+{
+    int c = 0, size = 0, nprocs = 0, num_configs = 0, prev = -1;
+    struct tune_config *configs = NULL;
+    struct tune_pick *pick = NULL;
+
+    MPI_CHECK(MPI_Comm_size(comm, &nprocs));
+    num_configs = init_configs(coll, comm, algo_list, segsizes, num_segsizes,
+                               &configs);
+    if (0 == rank) {
+        fprintf(stdout, "# Collective: %s, %d processes, %d configurations\n",
+                coll_names[coll], nprocs, num_configs);
+        fprintf(stdout, "%-*s%-*s%*s%*s%*s%*s%*s\n", 10, "# Size",
+                TUNE_LABEL_WIDTH, "Algorithm", 10, "Segment", FIELD_WIDTH,
+                "Avg Latency(us)", FIELD_WIDTH, "95% CI(us)", 8, "Rounds", 12,
+                "Confident");
+        fflush(stdout);
+    }
+    for (size = MAX(options.min_message_size, 1);
+         size <= options.max_message_size; size *= 2) {
+        if (is_reduction(coll) && size < (int)sizeof(float)) {
+            continue;
+        }
+        picks = realloc(picks, (num_picks + 1) * sizeof(struct tune_pick));
+        OMB_CHECK_NULL_AND_EXIT(picks, "Unable to allocate memory");
+        pick = &picks[num_picks++];
+        pick->coll = coll;
+        pick->nprocs = nprocs;
+        pick->size = is_reduction(coll) ?
+                         (size / (int)sizeof(float)) * (int)sizeof(float) :
+                         size;
+        prev = race(coll, configs, num_configs, sbuf, rbuf, size, prev, pick);
+        if (0 == rank) {
+            print_pick(pick);
+        }
+    }
+    for (c = 0; c < num_configs; c++) {
+        MPI_CHECK(MPI_Comm_free(&configs[c].comm));
+    }
+    free(configs);
+}
+
+static int compare_int(const void *a, const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
+
+/* Consecutive sizes with the same pick share one rule, the first from 0 */
+static int write_msg_rules(FILE *fp, int coll, int nprocs, int write)
+{
+    int p = 0, n = 0;
+    const struct tune_pick *prev = NULL, *pick = NULL;
+
+    for (p = 0; p < num_picks; p++) {
+        pick = &picks[p];
+        if (pick->coll != coll || pick->nprocs != nprocs ||
+            (NULL != prev && prev->algo == pick->algo &&
+             prev->segsize == pick->segsize)) {
+            continue;
+        }
+        if (write) {
+            fprintf(fp, "%d %d 0 %d\n", (NULL == prev) ? 0 : rule_bytes(pick),
+                    pick->algo, pick->segsize);
+        }
+        prev = pick;
+        n++;
+    }
+    return n;
+}
+
+/*
+ * Open MPI's classic rules format: the number of collectives, then for each
+ * its id and number of communicator sizes, for each size the number of
+ * message size rules, each "bytes algorithm fan-in/out segment-size".
+ * Comments carry no digits, the library reads every number it meets.
+ */
+static int write_rules(const char *path, const int *colls, int num_colls)
+{
+    int c = 0, p = 0, i = 0, num_sizes = 0, num_rules = 0;
+    int *nprocs = NULL;
+    FILE *fp = fopen(path, "w");
+
+    if (NULL == fp) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return -1;
+    }
+    nprocs = malloc(MAX(num_picks, 1) * sizeof(int));
+    OMB_CHECK_NULL_AND_EXIT(nprocs, "Unable to allocate memory");
+    fprintf(fp, "# Open MPI coll_tuned dynamic rules written by "
+                "osu_coll_tune\n");
+    fprintf(fp, "%-16d# collectives\n", num_colls);
+    for (c = 0; c < num_colls; c++) {
+        num_sizes = 0;
+        for (p = 0; p < num_picks; p++) {
+            if (picks[p].coll == colls[c]) {
+                nprocs[num_sizes++] = picks[p].nprocs;
+            }
+        }
+        qsort(nprocs, num_sizes, sizeof(int), compare_int);
+        for (p = 0, i = 0; p < num_sizes; p++) {
+            if (0 == i || nprocs[i - 1] != nprocs[p]) {
+                nprocs[i++] = nprocs[p];
+            }
+        }
+        num_sizes = i;
+        fprintf(fp, "%-16d# %s\n", coll_ids[colls[c]], coll_names[colls[c]]);
+        fprintf(fp, "%-16d# communicator sizes\n", num_sizes);
+        for (i = 0; i < num_sizes; i++) {
+            num_rules = write_msg_rules(fp, colls[c], nprocs[i], 0);
+            fprintf(fp, "%-16d# processes\n", nprocs[i]);
+            fprintf(fp, "%-16d# message sizes\n", num_rules);
+            fprintf(fp, "# bytes, algorithm, fan in/out, segment size\n");
+            write_msg_rules(fp, colls[c], nprocs[i], 1);
+        }
+    }
+    free(nprocs);
+    fclose(fp);
+    return 0;
+}
+
+static int write_json(const char *path)
+{
+    int p = 0, len = 0;
+    char version[MPI_MAX_LIBRARY_VERSION_STRING];
+    const struct tune_pick *pick = NULL;
+    FILE *fp = fopen(path, "w");
+
+    if (NULL == fp) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return -1;
+    }
+    MPI_CHECK(MPI_Get_library_version(version, &len));
+    for (p = 0; p < len; p++) {
+        if ('"' == version[p] || '\\' == version[p] || ' ' > version[p]) {
+            version[p] = ' ';
+        }
+    }
+    while (0 < len && ' ' == version[len - 1]) {
+        version[--len] = '\0';
+    }
+    fprintf(fp, "{\n  \"library\": \"%s\",\n", version);
+    fprintf(fp, "  \"iterations_per_round\": %zu,\n", options.iterations);
+    fprintf(fp, "  \"latency\": \"slowest rank average per call in us\",\n");
+    fprintf(fp, "  \"decisions\": [\n");
+    for (p = 0; p < num_picks; p++) {
+        pick = &picks[p];
+        fprintf(fp,
+                "    {\"collective\": \"%s\", \"processes\": %d, "
+                "\"bytes\": %d, \"rule_bytes\": %d, \"algorithm\": %d, "
+                "\"name\": \"%s\", \"segment_size\": %d, "
+                "\"avg_latency_us\": %.3f, ",
+                coll_names[pick->coll], pick->nprocs, pick->size,
+                rule_bytes(pick), pick->algo, pick->name, pick->segsize,
+                pick->mean);
+        if (0 > pick->ci) {
+            fprintf(fp, "\"ci95_us\": null, ");
+        } else {
+            fprintf(fp, "\"ci95_us\": %.3f, ", pick->ci);
+        }
+        fprintf(fp, "\"rounds\": %d, \"confident\": %s}%s\n", pick->rounds,
+                pick->confident ? "true" : "false",
+                (p + 1 < num_picks) ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+    fclose(fp);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int rank, numprocs, c, po_ret = 0, provided = 0, err = 0;
+    int dynamic_index = 0, dynamic_rules = 1;
+    int colls[NUM_COLLS], num_colls = 0;
+    int segsizes[TUNE_MAX_SEGSIZES], num_segsizes = 0;
+    int omb_sweep_itr = 0, omb_sweep_num = 0;
+    size_t bufsize = 0;
+    char *sendbuf = NULL, *recvbuf = NULL;
+    char algo_list[OMB_ALGO_LIST_MAX_LEN];
+    char rules_path[OMB_FILE_PATH_MAX_LENGTH + sizeof(TUNE_RULES_SUFFIX)];
+    char json_path[OMB_FILE_PATH_MAX_LENGTH + sizeof(TUNE_JSON_SUFFIX)];
+    MPI_Comm omb_comm = MPI_COMM_NULL;
+    omb_mpi_init_data omb_init_h;
+    options.bench = COLLECTIVE;
+    options.subtype = TUNE;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_coll_tune");
+
+    po_ret = process_options(argc, argv);
+
+    omb_init_h = omb_mpi_init(&argc, &argv);
+    omb_comm = omb_init_h.omb_comm;
+    if (MPI_COMM_NULL == omb_comm) {
+        OMB_ERROR_EXIT("Cant create communicator");
+    }
+    MPI_CHECK(MPI_Comm_rank(omb_comm, &rank));
+    MPI_CHECK(MPI_Comm_size(omb_comm, &numprocs));
+
+    switch (po_ret) {
+        case PO_BAD_USAGE:
+            print_bad_usage_message(rank);
+            omb_mpi_finalize(omb_init_h);
+            exit(EXIT_FAILURE);
+        case PO_HELP_MESSAGE:
+            print_help_message(rank);
+            omb_mpi_finalize(omb_init_h);
+            exit(EXIT_SUCCESS);
+        case PO_VERSION_MESSAGE:
+            print_version_message(rank);
+            omb_mpi_finalize(omb_init_h);
+            exit(EXIT_SUCCESS);
+        case PO_OKAY:
+            break;
+    }
+
+    if (numprocs < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+
+        omb_mpi_finalize(omb_init_h);
+        exit(EXIT_FAILURE);
+    }
+
+    num_colls = parse_colls(options.omb_tune_colls, colls, rank);
+    num_segsizes = parse_segsizes(options.omb_tune_segsizes, segsizes, rank);
+    MPI_CHECK(MPI_T_init_thread(MPI_THREAD_SINGLE, &provided));
+    if (MPI_SUCCESS ==
+        MPI_T_cvar_get_index(OMB_ALGO_DYNAMIC_CVAR, &dynamic_index)) {
+        cvar_access(dynamic_index, &dynamic_rules, 0);
+    }
+    if (0 == dynamic_rules && 0 == rank) {
+        fprintf(stderr,
+                "This test forces algorithms through %s, which can only be"
+                " set at launch: relaunch with --mca %s 1\n",
+                OMB_ALGO_DYNAMIC_CVAR, OMB_ALGO_DYNAMIC_CVAR);
+    }
+    err = (0 >= num_colls || 0 > num_segsizes || 0 == dynamic_rules);
+    if (err) {
+        MPI_CHECK(MPI_T_finalize());
+        omb_mpi_finalize(omb_init_h);
+        exit(EXIT_FAILURE);
+    }
+
+    bufsize = (size_t)options.max_message_size * numprocs;
+    if (allocate_memory_coll((void **)&sendbuf, bufsize, options.accel) ||
+        allocate_memory_coll((void **)&recvbuf, bufsize, options.accel)) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_CHECK(MPI_Abort(omb_comm, EXIT_FAILURE));
+    }
+    /* Zeroed floats keep the reductions off denormals */
+    set_buffer(sendbuf, options.accel, 0, bufsize);
+    set_buffer(recvbuf, options.accel, 0, bufsize);
+
+    /* -S drives the communicator sizes, the algorithms are raced here */
+    strcpy(algo_list,
+           '\0' == options.omb_algo_list[0] ? "all" : options.omb_algo_list);
+    options.omb_algo_list[0] = '\0';
+
+    print_preamble(rank);
+    if (0 == rank) {
+        fprintf(stdout,
+                "# Segment sizes %s, %zu iterations per round, at most %d"
+                " rounds\n",
+                options.omb_tune_segsizes, options.iterations,
+                TUNE_MAX_ROUNDS);
+        fflush(stdout);
+    }
+    omb_sweep_num = omb_sweep_init(omb_init_h.omb_comm, rank);
+    for (omb_sweep_itr = 0; omb_sweep_itr < omb_sweep_num; omb_sweep_itr++) {
+        omb_comm = omb_sweep_select(omb_sweep_itr, omb_init_h.omb_comm, rank);
+        if (MPI_COMM_NULL == omb_comm) {
+            continue;
+        }
+        for (c = 0; c < num_colls; c++) {
+            tune_coll(colls[c], omb_comm, algo_list, segsizes, num_segsizes,
+                      sendbuf, recvbuf, rank);
+        }
+    }
+    omb_sweep_finalize(omb_init_h.omb_comm, rank);
+
+    if (0 == rank) {
+        snprintf(rules_path, sizeof(rules_path), "%s" TUNE_RULES_SUFFIX,
+                 options.omb_tune_output);
+        snprintf(json_path, sizeof(json_path), "%s" TUNE_JSON_SUFFIX,
+                 options.omb_tune_output);
+        if (0 == write_rules(rules_path, colls, num_colls) &&
+            0 == write_json(json_path)) {
+            fprintf(stdout, "\n# Rules written to %s, decisions to %s\n",
+                    rules_path, json_path);
+        }
+        fflush(stdout);
+    }
+
+    free(picks);
+    free_buffer(sendbuf, options.accel);
+    free_buffer(recvbuf, options.accel);
+    MPI_CHECK(MPI_T_finalize());
+    omb_mpi_finalize(omb_init_h);
+
+    return EXIT_SUCCESS;
+}
@@ -725,22 +725,13 @@ void allocate_memory_get_acc_lat(int rank, char *rbuf, int size,
 
 void print_header_get_acc_lat(int rank, enum WINDOW win, enum SYNC sync)
 {
-    int itr = 0;
     if (rank == 0) {
         fprintf(stdout, HEADER);
         fprintf(stdout, "# Window creation: %s\n", win_info[win]);
         fprintf(stdout, "# Synchronization: %s\n", sync_info[sync]);
         fprintf(stdout, "%-*s%*s", 10, "# Size", FIELD_WIDTH, "Latency (us)");
         if (options.omb_tail_lat) {
-            itr = 0;
-            while (itr < OMB_STAT_MAX_NUM &&
-                   -1 != options.omb_stat_percentiles[itr]) {
-                fprintf(stdout, "%*sP%d Tail Lat(us)",
-                        FIELD_WIDTH - strlen("Px Tail Lat(us)") -
-                            (options.omb_stat_percentiles[itr] > 9),
-                        "", options.omb_stat_percentiles[itr]);
-                itr++;
-            }
+            omb_print_tail_header();
         }
         fprintf(stdout, "\n");
         fflush(stdout);
@@ -0,0 +1,790 @@
+/*
+ * Copyright (c) 2002-2024 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * PMPI profiler, to see what an application actually communicates before
+ * choosing benchmarks and message sizes. Link it before the MPI library
+ * or preload it:
+ *
+ *   mpirun -x LD_PRELOAD=libosu_prof.so ./app
+ *
+ * For every communicator it counts calls, time and bytes per MPI function,
+ * the message size histograms of point to point and collective calls and
+ * the messages and bytes sent to every peer. Each rank writes its profile
+ * to PREFIX.RANK.txt at MPI_Finalize and rank 0 prints a job summary.
+ * With OSU_PROF_TRACE=1 every call is also recorded in per-thread buffers
+ * written to PREFIX.RANK.trace at MPI_Finalize (see osu_prof.h and
+ * osu_prof_dump). OSU_PROF_PREFIX sets PREFIX, osu_prof by default.
+ *
+ * A call costs two clock reads, an attribute lookup and a few relaxed
+ * atomic adds. Only the C bindings of the functions in osu_prof.h are
+ * wrapped; time in other calls, e.g. nonblocking collectives, shows up in
+ * the waits.
+ */
+#include <mpi.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "osu_prof.h"
+
+#define PROF_NUM_BINS      33
+#define PROF_CHUNK_RECORDS 65536
+#define PROF_MAX_MEMBERS   16
+#define PROF_PATH_LEN      1024
+
+#define PROF_ADD(counter, value)                                               \
+    __atomic_fetch_add(&(counter), (value), __ATOMIC_RELAXED)
+
+struct prof_comm {
+    int index;
+    int size; /* of the remote group for intercommunicators */
+    int rank;
+    int *world;
+    uint64_t calls[OSU_PROF_NUM_FUNCS];
+    uint64_t ns[OSU_PROF_NUM_FUNCS];
+    uint64_t bytes[OSU_PROF_NUM_FUNCS];
+    uint64_t p2p_hist[PROF_NUM_BINS];
+    uint64_t coll_hist[PROF_NUM_BINS];
+    uint64_t *peer_msgs;
+    uint64_t *peer_bytes;
+    struct prof_comm *next;
+};
+
+struct prof_chunk {
+    int count;
+    struct prof_chunk *next;
+    struct osu_prof_record records[PROF_CHUNK_RECORDS];
+};
+
+struct prof_thread {
+    int index;
+    int dropped;
+    uint64_t num_records;
+    struct prof_chunk *head;
+    struct prof_chunk *tail;
+    struct prof_thread *next;
+};
+
+static const char *func_names[OSU_PROF_NUM_FUNCS] = OSU_PROF_FUNC_NAMES;
+
+static pthread_mutex_t prof_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct prof_comm *comms = NULL, **comms_tail = &comms;
+static struct prof_thread *threads = NULL;
+static __thread struct prof_thread *my_thread = NULL;
+static int num_comms = 0, num_threads = 0;
+static int prof_keyval = MPI_KEYVAL_INVALID;
+static int prof_active = 0, prof_trace = 0;
+static uint64_t t_init = 0;
+static char prof_prefix[PROF_PATH_LEN] = "osu_prof";
+
+static inline uint64_t prof_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* Bin 0 holds empty messages, bin k sizes in [2^(k-1), 2^k) */
+static inline int prof_bin(uint64_t bytes)
+{
+    int bin = bytes ? 64 - __builtin_clzll(bytes) : 0;
+
+    return (bin < PROF_NUM_BINS) ? bin : PROF_NUM_BINS - 1;
+}
+
+static struct prof_comm *prof_new_comm(MPI_Comm comm)
+{
+    int i, inter = 0;
+    int *ranks = NULL;
+    MPI_Group group, world_group;
+    struct prof_comm *stats = calloc(1, sizeof(struct prof_comm));
+
+    if (NULL == stats) {
+        return NULL;
+    }
+    PMPI_Comm_test_inter(comm, &inter);
+    PMPI_Comm_rank(comm, &stats->rank);
+    if (inter) {
+        PMPI_Comm_remote_size(comm, &stats->size);
+        PMPI_Comm_remote_group(comm, &group);
+    } else {
+        PMPI_Comm_size(comm, &stats->size);
+        PMPI_Comm_group(comm, &group);
+    }
+    stats->world = malloc(stats->size * sizeof(int));
+    ranks = malloc(stats->size * sizeof(int));
+    stats->peer_msgs = calloc(stats->size, sizeof(uint64_t));
+    stats->peer_bytes = calloc(stats->size, sizeof(uint64_t));
+    if (NULL == stats->world || NULL == ranks || NULL == stats->peer_msgs ||
+        NULL == stats->peer_bytes) {
+        free(stats->world);
+        free(ranks);
+        free(stats->peer_msgs);
+        free(stats->peer_bytes);
+        free(stats);
+        PMPI_Group_free(&group);
+        return NULL;
+    }
+    for (i = 0; i < stats->size; i++) {
+        ranks[i] = i;
+    }
+    PMPI_Comm_group(MPI_COMM_WORLD, &world_group);
+    PMPI_Group_translate_ranks(group, stats->size, ranks, world_group,
+                               stats->world);
+    PMPI_Group_free(&world_group);
+    PMPI_Group_free(&group);
+    free(ranks);
+    stats->index = num_comms++;
+    *comms_tail = stats;
+    comms_tail = &stats->next;
+    return stats;
+}
+
+/* Statistics of a communicator, created the first time it is used */
+static struct prof_comm *prof_comm(MPI_Comm comm)
+{
+    int flag = 0;
+    struct prof_comm *stats = NULL;
+
+    PMPI_Comm_get_attr(comm, prof_keyval, &stats, &flag);
+    if (flag) {
+        return stats;
+    }
+    pthread_mutex_lock(&prof_lock);
+    PMPI_Comm_get_attr(comm, prof_keyval, &stats, &flag);
+    if (!flag) {
+        stats = prof_new_comm(comm);
+        if (NULL != stats) {
+            PMPI_Comm_set_attr(comm, prof_keyval, stats);
+        }
+    }
+    pthread_mutex_unlock(&prof_lock);
+    return stats;
+}
+
+static struct prof_thread *prof_thread(void)
+{
+    if (NULL == my_thread) {
+        my_thread = calloc(1, sizeof(struct prof_thread));
+        if (NULL == my_thread) {
+            return NULL;
+        }
+        pthread_mutex_lock(&prof_lock);
+        my_thread->index = num_threads++;
+        my_thread->next = threads;
+        threads = my_thread;
+        pthread_mutex_unlock(&prof_lock);
+    }
+    return my_thread;
+}
+
+static void prof_append(struct prof_comm *stats, int func, int peer,
+                        uint64_t bytes, uint64_t t_start, uint64_t t_end)
+{
+    struct prof_thread *thread = prof_thread();
+    struct prof_chunk *chunk = NULL;
+    struct osu_prof_record *record = NULL;
+
+    if (NULL == thread) {
+        return;
+    }
+    chunk = thread->tail;
+    if (NULL == chunk || PROF_CHUNK_RECORDS == chunk->count) {
+        chunk = malloc(sizeof(struct prof_chunk));
+        if (NULL == chunk) {
+            thread->dropped++;
+            return;
+        }
+        chunk->count = 0;
+        chunk->next = NULL;
+        if (NULL == thread->tail) {
+            thread->head = chunk;
+        } else {
+            thread->tail->next = chunk;
+        }
+        thread->tail = chunk;
+    }
+    record = &chunk->records[chunk->count++];
+    record->t_start = t_start - t_init;
+    record->t_end = t_end - t_init;
+    record->bytes = bytes;
+    record->peer = peer;
+    record->comm = stats->index;
+    record->func = func;
+    record->pad = 0;
+    thread->num_records++;
+}
+
+static inline int prof_world(struct prof_comm *stats, int rank)
+{
+    return (0 <= rank && rank < stats->size) ? stats->world[rank] : -1;
+}
+
+static inline uint64_t prof_bytes(int count, MPI_Datatype datatype)
+{
+    int size = 0;
+
+    PMPI_Type_size(datatype, &size);
+    return (uint64_t)count * size;
+}
+
+/* Accounts one call; p2p and coll pick the histogram, if any */
+static void prof_call(struct prof_comm *stats, int func, int peer,
+                      uint64_t bytes, uint64_t t_start, int p2p, int coll)
+{
+    uint64_t t_end = prof_now();
+
+    PROF_ADD(stats->calls[func], 1);
+    PROF_ADD(stats->ns[func], t_end - t_start);
+    PROF_ADD(stats->bytes[func], bytes);
+    if (p2p) {
+        PROF_ADD(stats->p2p_hist[prof_bin(bytes)], 1);
+    } else if (coll) {
+        PROF_ADD(stats->coll_hist[prof_bin(bytes)], 1);
+    }
+    /* MPI_Sendrecv appends its own records */
+    if (prof_trace && OSU_PROF_SENDRECV != func) {
+        prof_append(stats, func, prof_world(stats, peer), bytes, t_start,
+                    t_end);
+    }
+}
+
+static void prof_send(int func, MPI_Comm comm, int dest, int count,
+                      MPI_Datatype datatype, uint64_t t_start)
+{
+    struct prof_comm *stats = NULL;
+    uint64_t bytes = 0;
+
+    if (!prof_active || NULL == (stats = prof_comm(comm))) {
+        return;
+    }
+    bytes = prof_bytes(count, datatype);
+    if (0 <= dest && dest < stats->size) {
+        PROF_ADD(stats->peer_msgs[dest], 1);
+        PROF_ADD(stats->peer_bytes[dest], bytes);
+    }
+    prof_call(stats, func, dest, bytes, t_start, 1, 0);
+}
+
+static void prof_recv(int func, MPI_Comm comm, int source, uint64_t bytes,
+                      uint64_t t_start)
+{
+    struct prof_comm *stats = NULL;
+
+    if (!prof_active || NULL == (stats = prof_comm(comm))) {
+        return;
+    }
+    prof_call(stats, func, source, bytes, t_start, 1, 0);
+}
+
+static void prof_coll(int func, MPI_Comm comm, int root, uint64_t bytes,
+                      uint64_t t_start)
+{
+    struct prof_comm *stats = NULL;
+
+    if (!prof_active || NULL == (stats = prof_comm(comm))) {
+        return;
+    }
+    prof_call(stats, func, root, bytes, t_start, 0, OSU_PROF_BARRIER != func);
+}
+
+static void prof_wait(int func, uint64_t t_start)
+{
+    struct prof_comm *stats = NULL;
+
+    /* Waits have no communicator, they are charged to MPI_COMM_WORLD */
+    if (!prof_active || NULL == (stats = prof_comm(MPI_COMM_WORLD))) {
+        return;
+    }
+    prof_call(stats, func, -1, 0, t_start, 0, 0);
+}
+
+static void prof_init(void)
+{
+    const char *env = NULL;
+
+    PMPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, MPI_COMM_NULL_DELETE_FN,
+                            &prof_keyval, NULL);
+    env = getenv("OSU_PROF_PREFIX");
+    if (NULL != env && strlen(env) < PROF_PATH_LEN - 32) {
+        strcpy(prof_prefix, env);
+    } else if (NULL != env) {
+        fprintf(stderr, "libosu_prof: OSU_PROF_PREFIX too long, writing to"
+                        " %s.RANK instead\n",
+                prof_prefix);
+    }
+    env = getenv("OSU_PROF_TRACE");
+    prof_trace = (NULL != env && 0 != atoi(env));
+    t_init = prof_now();
+    prof_active = 1;
+    /* MPI_COMM_WORLD is communicator 0 */
+    prof_comm(MPI_COMM_WORLD);
+}
+
+static void prof_print_hist(FILE *fp, const uint64_t *p2p,
+                            const uint64_t *coll)
+{
+    int bin;
+
+    fprintf(fp, "%-*s%*s%*s\n", 20, "# Size (bytes)", 18, "P2P messages", 18,
+            "Collectives");
+    for (bin = 0; bin < PROF_NUM_BINS; bin++) {
+        if (0 == p2p[bin] && 0 == coll[bin]) {
+            continue;
+        }
+        fprintf(fp, "%-*llu%*llu%*llu\n", 20,
+                (bin ? 1ULL << (bin - 1) : 0ULL), 18,
+                (unsigned long long)p2p[bin], 18,
+                (unsigned long long)coll[bin]);
+    }
+}
+
+static void prof_write_profile(int rank, int size, uint64_t t_final,
+                               uint64_t ns_mpi)
+{
+    int f, i;
+    char path[PROF_PATH_LEN];
+    struct prof_comm *stats = NULL;
+    FILE *fp = NULL;
+
+    if (PROF_PATH_LEN <=
+        snprintf(path, PROF_PATH_LEN, "%s.%d.txt", prof_prefix, rank)) {
+        fprintf(stderr, "libosu_prof: path of %s.%d.txt too long\n",
+                prof_prefix, rank);
+        return;
+    }
+    fp = fopen(path, "w");
+    if (NULL == fp) {
+        fprintf(stderr, "libosu_prof: cannot write %s\n", path);
+        return;
+    }
+    fprintf(fp, "# Rank %d of %d, %.6f s from MPI_Init to MPI_Finalize,"
+                " %.6f s in MPI\n",
+            rank, size, (t_final - t_init) / 1e9, ns_mpi / 1e9);
+    for (stats = comms; NULL != stats; stats = stats->next) {
+        fprintf(fp, "\n# Communicator %d: %d ranks, rank %d, world ranks",
+                stats->index, stats->size, stats->rank);
+        for (i = 0; i < stats->size && i < PROF_MAX_MEMBERS; i++) {
+            fprintf(fp, "%s%d", i ? "," : " ", stats->world[i]);
+        }
+        fprintf(fp, "%s\n", (stats->size > PROF_MAX_MEMBERS) ? ",..." : "");
+        fprintf(fp, "%-*s%*s%*s%*s\n", 20, "# Function", 18, "Calls", 18,
+                "Time(us)", 18, "Bytes");
+        for (f = 0; f < OSU_PROF_NUM_FUNCS; f++) {
+            if (0 == stats->calls[f]) {
+                continue;
+            }
+            fprintf(fp, "%-*s%*llu%*.*f%*llu\n", 20, func_names[f], 18,
+                    (unsigned long long)stats->calls[f], 18, 2,
+                    stats->ns[f] / 1e3, 18,
+                    (unsigned long long)stats->bytes[f]);
+        }
+        prof_print_hist(fp, stats->p2p_hist, stats->coll_hist);
+        fprintf(fp, "%-*s%*s%*s\n", 20, "# Peer (world)", 18, "Messages", 18,
+                "Bytes");
+        for (i = 0; i < stats->size; i++) {
+            if (0 == stats->peer_msgs[i]) {
+                continue;
+            }
+            fprintf(fp, "%-*d%*llu%*llu\n", 20, stats->world[i], 18,
+                    (unsigned long long)stats->peer_msgs[i], 18,
+                    (unsigned long long)stats->peer_bytes[i]);
+        }
+    }
+    fclose(fp);
+}
+
+static void prof_write_trace(int rank, int size, uint64_t t_final)
+{
+    char path[PROF_PATH_LEN];
+    struct osu_prof_file_header header;
+    struct osu_prof_thread_header thread_header;
+    struct prof_thread *thread = NULL;
+    struct prof_chunk *chunk = NULL;
+    FILE *fp = NULL;
+
+    if (PROF_PATH_LEN <=
+        snprintf(path, PROF_PATH_LEN, "%s.%d.trace", prof_prefix, rank)) {
+        fprintf(stderr, "libosu_prof: path of %s.%d.trace too long\n",
+                prof_prefix, rank);
+        return;
+    }
+    fp = fopen(path, "wb");
+    if (NULL == fp) {
+        fprintf(stderr, "libosu_prof: cannot write %s\n", path);
+        return;
+    }
+    memset(&header, 0, sizeof(header));
+    strcpy(header.magic, OSU_PROF_MAGIC);
+    header.version = OSU_PROF_VERSION;
+    header.rank = rank;
+    header.size = size;
+    header.num_threads = num_threads;
+    header.t_finalize = t_final - t_init;
+    fwrite(&header, sizeof(header), 1, fp);
+    for (thread = threads; NULL != thread; thread = thread->next) {
+        thread_header.thread = thread->index;
+        thread_header.dropped = thread->dropped;
+        thread_header.num_records = thread->num_records;
+        fwrite(&thread_header, sizeof(thread_header), 1, fp);
+        for (chunk = thread->head; NULL != chunk; chunk = chunk->next) {
+            fwrite(chunk->records, sizeof(struct osu_prof_record),
+                   chunk->count, fp);
+        }
+    }
+    fclose(fp);
+}
+
+/* Job summary on rank 0, summed over all communicators of every rank */
+static void prof_summary(int rank, int size, uint64_t t_final,
+                         uint64_t ns_mpi)
+{
+    int f, bin;
+    uint64_t calls[OSU_PROF_NUM_FUNCS] = {0}, bytes[OSU_PROF_NUM_FUNCS] = {0};
+    uint64_t hist[2][PROF_NUM_BINS] = {{0}};
+    double ns[OSU_PROF_NUM_FUNCS] = {0}, ns_max[OSU_PROF_NUM_FUNCS];
+    double ns_sum[OSU_PROF_NUM_FUNCS], share, share_min, share_max, share_sum;
+    uint64_t calls_sum[OSU_PROF_NUM_FUNCS], bytes_sum[OSU_PROF_NUM_FUNCS];
+    uint64_t hist_sum[2][PROF_NUM_BINS];
+    struct prof_comm *stats = NULL;
+
+    for (stats = comms; NULL != stats; stats = stats->next) {
+        for (f = 0; f < OSU_PROF_NUM_FUNCS; f++) {
+            calls[f] += stats->calls[f];
+            bytes[f] += stats->bytes[f];
+            ns[f] += stats->ns[f];
+        }
+        for (bin = 0; bin < PROF_NUM_BINS; bin++) {
+            hist[0][bin] += stats->p2p_hist[bin];
+            hist[1][bin] += stats->coll_hist[bin];
+        }
+    }
+    share = (t_final > t_init) ? 100.0 * ns_mpi / (t_final - t_init) : 0;
+    PMPI_Reduce(calls, calls_sum, OSU_PROF_NUM_FUNCS, MPI_UINT64_T, MPI_SUM, 0,
+                MPI_COMM_WORLD);
+    PMPI_Reduce(bytes, bytes_sum, OSU_PROF_NUM_FUNCS, MPI_UINT64_T, MPI_SUM, 0,
+                MPI_COMM_WORLD);
+    PMPI_Reduce(ns, ns_sum, OSU_PROF_NUM_FUNCS, MPI_DOUBLE, MPI_SUM, 0,
+                MPI_COMM_WORLD);
+    PMPI_Reduce(ns, ns_max, OSU_PROF_NUM_FUNCS, MPI_DOUBLE, MPI_MAX, 0,
+                MPI_COMM_WORLD);
+    PMPI_Reduce(hist, hist_sum, 2 * PROF_NUM_BINS, MPI_UINT64_T, MPI_SUM, 0,
+                MPI_COMM_WORLD);
+    PMPI_Reduce(&share, &share_min, 1, MPI_DOUBLE, MPI_MIN, 0, MPI_COMM_WORLD);
+    PMPI_Reduce(&share, &share_max, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    PMPI_Reduce(&share, &share_sum, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (0 != rank) {
+        return;
+    }
+    fprintf(stdout, "\n# OSU MPI profile: %d ranks, %.2f%% of the time in MPI"
+                    " (min %.2f%%, max %.2f%%)\n",
+            size, share_sum / size, share_min, share_max);
+    fprintf(stdout, "%-*s%*s%*s%*s%*s\n", 20, "# Function", 18, "Calls", 18,
+            "Avg Time(us)", 18, "Max Time(us)", 18, "Bytes");
+    for (f = 0; f < OSU_PROF_NUM_FUNCS; f++) {
+        if (0 == calls_sum[f]) {
+            continue;
+        }
+        fprintf(stdout, "%-*s%*llu%*.*f%*.*f%*llu\n", 20, func_names[f], 18,
+                (unsigned long long)calls_sum[f], 18, 2,
+                ns_sum[f] / size / 1e3, 18, 2, ns_max[f] / 1e3, 18,
+                (unsigned long long)bytes_sum[f]);
+    }
+    prof_print_hist(stdout, hist_sum[0], hist_sum[1]);
+    fprintf(stdout, "# Per rank profiles in %s.RANK.txt%s\n", prof_prefix,
+            prof_trace ? ", traces in .trace" : "");
+    fflush(stdout);
+}
+
+int MPI_Init(int *argc, char ***argv)
+{
+    int ret = PMPI_Init(argc, argv);
+
+    prof_init();
+    return ret;
+}
+
+int MPI_Init_thread(int *argc, char ***argv, int required, int *provided)
+{
+    int ret = PMPI_Init_thread(argc, argv, required, provided);
+
+    prof_init();
+    return ret;
+}
+
+int MPI_Finalize(void)
+{
+    int f, rank, size;
+    uint64_t t_final = prof_now(), ns_mpi = 0;
+    struct prof_comm *stats = NULL;
+
+    prof_active = 0;
+    PMPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    PMPI_Comm_size(MPI_COMM_WORLD, &size);
+    for (stats = comms; NULL != stats; stats = stats->next) {
+        for (f = 0; f < OSU_PROF_NUM_FUNCS; f++) {
+            ns_mpi += stats->ns[f];
+        }
+    }
+    prof_write_profile(rank, size, t_final, ns_mpi);
+    if (prof_trace) {
+        prof_write_trace(rank, size, t_final);
+    }
+    prof_summary(rank, size, t_final, ns_mpi);
+    PMPI_Comm_free_keyval(&prof_keyval);
+    return PMPI_Finalize();
+}
+
+int MPI_Send(const void *buf, int count, MPI_Datatype datatype, int dest,
+             int tag, MPI_Comm comm)
+{
+    uint64_t t_start = prof_now();
+    int ret = PMPI_Send(buf, count, datatype, dest, tag, comm);
+
+    prof_send(OSU_PROF_SEND, comm, dest, count, datatype, t_start);
+    return ret;
+}
+
+int MPI_Ssend(const void *buf, int count, MPI_Datatype datatype, int dest,
+              int tag, MPI_Comm comm)
+{
+    uint64_t t_start = prof_now();
+    int ret = PMPI_Ssend(buf, count, datatype, dest, tag, comm);
+
+    prof_send(OSU_PROF_SSEND, comm, dest, count, datatype, t_start);
+    return ret;
+}
+
+int MPI_Isend(const void *buf, int count, MPI_Datatype datatype, int dest,
+              int tag, MPI_Comm comm, MPI_Request *request)
+{
+    uint64_t t_start = prof_now();
+    int ret = PMPI_Isend(buf, count, datatype, dest, tag, comm, request);
+
+    prof_send(OSU_PROF_ISEND, comm, dest, count, datatype, t_start);
+    return ret;
+}
+
+int MPI_Recv(void *buf, int count, MPI_Datatype datatype, int source, int tag,
+             MPI_Comm comm, MPI_Status *status)
+{
+    int ret, bytes = 0;
+    uint64_t t_start = prof_now();
+    MPI_Status local_status;
+
+    /* The status tells the actual source and size */
+    if (MPI_STATUS_IGNORE == status) {
+        status = &local_status;
+    }
+    ret = PMPI_Recv(buf, count, datatype, source, tag, comm, status);
+    PMPI_Get_count(status, MPI_BYTE, &bytes);
+    prof_recv(OSU_PROF_RECV, comm, status->MPI_SOURCE,
+              (MPI_UNDEFINED == bytes) ? 0 : bytes, t_start);
+    return ret;
+}
+
+int MPI_Irecv(void *buf, int count, MPI_Datatype datatype, int source,
+              int tag, MPI_Comm comm, MPI_Request *request)
+{
+    uint64_t t_start = prof_now();
+    int ret = PMPI_Irecv(buf, count, datatype, source, tag, comm, request);
+
+    prof_recv(OSU_PROF_IRECV, comm, source, prof_bytes(count, datatype),
+              t_start);
+    return ret;
+}
+
+int MPI_Sendrecv(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                 int dest, int sendtag, void *recvbuf, int recvcount,
+                 MPI_Datatype recvtype, int source, int recvtag, MPI_Comm comm,
+                 MPI_Status *status)
+{
+    int ret, bytes = 0;
+    uint64_t t_start = prof_now();
+    struct prof_comm *stats = NULL;
+    MPI_Status local_status;
+
+    if (MPI_STATUS_IGNORE == status) {
+        status = &local_status;
+    }
+    ret = PMPI_Sendrecv(sendbuf, sendcount, sendtype, dest, sendtag, recvbuf,
+                        recvcount, recvtype, source, recvtag, comm, status);
+    /*
+     * Profiled as the send it carries, traced as the isend, irecv and
+     * waitall it stands for so that it can be replayed
+     */
+    if (prof_active && prof_trace && NULL != (stats = prof_comm(comm))) {
+        PMPI_Get_count(status, MPI_BYTE, &bytes);
+        prof_append(stats, OSU_PROF_ISEND, prof_world(stats, dest),
+                    prof_bytes(sendcount, sendtype), t_start, t_start);
+        prof_append(stats, OSU_PROF_IRECV,
+                    prof_world(stats, status->MPI_SOURCE),
+                    (MPI_UNDEFINED == bytes) ? 0 : bytes, t_start, t_start);
+        prof_append(stats, OSU_PROF_WAITALL, -1, 0, t_start, prof_now());
+    }
+    prof_send(OSU_PROF_SENDRECV, comm, dest, sendcount, sendtype, t_start);
+    return ret;
+}
+
+int MPI_Wait(MPI_Request *request, MPI_Status *status)
+{
+    uint64_t t_start = prof_now();
+    int ret = PMPI_Wait(request, status);
+
+    prof_wait(OSU_PROF_WAIT, t_start);
+    return ret;
+}
+
+int MPI_Waitall(int count, MPI_Request array_of_requests[],
+                MPI_Status array_of_statuses[])
+{
+    uint64_t t_start = prof_now();
+    int ret = PMPI_Waitall(count, array_of_requests, array_of_statuses);
+
+    prof_wait(OSU_PROF_WAITALL, t_start);
+    return ret;
+}
+
+int MPI_Barrier(MPI_Comm comm)
+{
+    uint64_t t_start = prof_now();
+    int ret = PMPI_Barrier(comm);
+
+    prof_coll(OSU_PROF_BARRIER, comm, -1, 0, t_start);
+    return ret;
+}
+
+int MPI_Bcast(void *buffer, int count, MPI_Datatype datatype, int root,
+              MPI_Comm comm)
+{
+    uint64_t t_start = prof_now();
+    int ret = PMPI_Bcast(buffer, count, datatype, root, comm);
+
+    prof_coll(OSU_PROF_BCAST, comm, root, prof_bytes(count, datatype),
+              t_start);
+    return ret;
+}
+
+int MPI_Reduce(const void *sendbuf, void *recvbuf, int count,
+               MPI_Datatype datatype, MPI_Op op, int root, MPI_Comm comm)
+{
+    uint64_t t_start = prof_now();
+    int ret = PMPI_Reduce(sendbuf, recvbuf, count, datatype, op, root, comm);
+
+    prof_coll(OSU_PROF_REDUCE, comm, root, prof_bytes(count, datatype),
+              t_start);
+    return ret;
+}
+
+int MPI_Allreduce(const void *sendbuf, void *recvbuf, int count,
+                  MPI_Datatype datatype, MPI_Op op, MPI_Comm comm)
+{
+    uint64_t t_start = prof_now();
+    int ret = PMPI_Allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+
+    prof_coll(OSU_PROF_ALLREDUCE, comm, -1, prof_bytes(count, datatype),
+              t_start);
+    return ret;
+}
+
+int MPI_Gather(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+               void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+               MPI_Comm comm)
+{
+    uint64_t t_start = prof_now();
+    int ret = PMPI_Gather(sendbuf, sendcount, sendtype, recvbuf, recvcount,
+                          recvtype, root, comm);
+
+    /* Sizes are per rank, as in the OSU benchmarks */
+    prof_coll(OSU_PROF_GATHER, comm, root,
+              (MPI_IN_PLACE == sendbuf) ? prof_bytes(recvcount, recvtype) :
+                                          prof_bytes(sendcount, sendtype),
+              t_start);
+    return ret;
+}
+
+int MPI_Scatter(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+                MPI_Comm comm)
+{
+    uint64_t t_start = prof_now();
+    int ret = PMPI_Scatter(sendbuf, sendcount, sendtype, recvbuf, recvcount,
+                           recvtype, root, comm);
+
+    prof_coll(OSU_PROF_SCATTER, comm, root,
+              (MPI_IN_PLACE == recvbuf) ? prof_bytes(sendcount, sendtype) :
+                                          prof_bytes(recvcount, recvtype),
+              t_start);
+    return ret;
+}
+
+int MPI_Allgather(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                  void *recvbuf, int recvcount, MPI_Datatype recvtype,
+                  MPI_Comm comm)
+{
+    uint64_t t_start = prof_now();
+    int ret = PMPI_Allgather(sendbuf, sendcount, sendtype, recvbuf, recvcount,
+                             recvtype, comm);
+
+    prof_coll(OSU_PROF_ALLGATHER, comm, -1, prof_bytes(recvcount, recvtype),
+              t_start);
+    return ret;
+}
+
+int MPI_Alltoall(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                 void *recvbuf, int recvcount, MPI_Datatype recvtype,
+                 MPI_Comm comm)
+{
+    uint64_t t_start = prof_now();
+    int ret = PMPI_Alltoall(sendbuf, sendcount, sendtype, recvbuf, recvcount,
+                            recvtype, comm);
+
+    prof_coll(OSU_PROF_ALLTOALL, comm, -1, prof_bytes(recvcount, recvtype),
+              t_start);
+    return ret;
+}
+
+int MPI_Alltoallv(const void *sendbuf, const int sendcounts[],
+                  const int sdispls[], MPI_Datatype sendtype, void *recvbuf,
+                  const int recvcounts[], const int rdispls[],
+                  MPI_Datatype recvtype, MPI_Comm comm)
+{
+    int i, size = 0;
+    uint64_t t_start = prof_now(), count = 0;
+    int ret = PMPI_Alltoallv(sendbuf, sendcounts, sdispls, sendtype, recvbuf,
+                             recvcounts, rdispls, recvtype, comm);
+
+    /* Total received by this rank, the counts differ across peers */
+    PMPI_Comm_size(comm, &size);
+    for (i = 0; i < size; i++) {
+        count += recvcounts[i];
+    }
+    prof_coll(OSU_PROF_ALLTOALLV, comm, -1, prof_bytes(1, recvtype) * count,
+              t_start);
+    return ret;
+}
+
+int MPI_Reduce_scatter(const void *sendbuf, void *recvbuf,
+                       const int recvcounts[], MPI_Datatype datatype,
+                       MPI_Op op, MPI_Comm comm)
+{
+    int rank = 0;
+    uint64_t t_start = prof_now();
+    int ret =
+        PMPI_Reduce_scatter(sendbuf, recvbuf, recvcounts, datatype, op, comm);
+
+    PMPI_Comm_rank(comm, &rank);
+    prof_coll(OSU_PROF_REDUCE_SCATTER, comm, -1,
+              prof_bytes(recvcounts[rank], datatype), t_start);
+    return ret;
+}
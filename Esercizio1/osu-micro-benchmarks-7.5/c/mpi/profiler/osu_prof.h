@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2002-2024 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#ifndef OSU_PROF_H
+#define OSU_PROF_H 1
+
+#include <stdint.h>
+
+/*
+ * Binary trace written by libosu_prof, one file per rank:
+ *
+ *   struct osu_prof_file_header
+ *   for every thread:
+ *       struct osu_prof_thread_header
+ *       num_records x struct osu_prof_record
+ *
+ * Peers and roots are world ranks, communicator 0 is MPI_COMM_WORLD and
+ * the other communicators are numbered in the order the rank first used
+ * them.
+ */
+#define OSU_PROF_MAGIC   "OSUPROF"
+#define OSU_PROF_VERSION 1
+
+enum osu_prof_func {
+    OSU_PROF_SEND,
+    OSU_PROF_SSEND,
+    OSU_PROF_ISEND,
+    OSU_PROF_RECV,
+    OSU_PROF_IRECV,
+    OSU_PROF_SENDRECV,
+    OSU_PROF_WAIT,
+    OSU_PROF_WAITALL,
+    OSU_PROF_BARRIER,
+    OSU_PROF_BCAST,
+    OSU_PROF_REDUCE,
+    OSU_PROF_ALLREDUCE,
+    OSU_PROF_GATHER,
+    OSU_PROF_SCATTER,
+    OSU_PROF_ALLGATHER,
+    OSU_PROF_ALLTOALL,
+    OSU_PROF_ALLTOALLV,
+    OSU_PROF_REDUCE_SCATTER,
+    OSU_PROF_NUM_FUNCS
+};
+
+#define OSU_PROF_FUNC_NAMES                                                    \
+    {                                                                          \
+        "MPI_Send", "MPI_Ssend", "MPI_Isend", "MPI_Recv", "MPI_Irecv",         \
+            "MPI_Sendrecv", "MPI_Wait", "MPI_Waitall", "MPI_Barrier",          \
+            "MPI_Bcast", "MPI_Reduce", "MPI_Allreduce", "MPI_Gather",          \
+            "MPI_Scatter", "MPI_Allgather", "MPI_Alltoall", "MPI_Alltoallv",   \
+            "MPI_Reduce_scatter"                                               \
+    }
+
+struct osu_prof_file_header {
+    char magic[8];
+    int32_t version;
+    int32_t rank;
+    int32_t size;
+    int32_t num_threads;
+    uint64_t t_finalize; /* ns from MPI_Init */
+};
+
+struct osu_prof_thread_header {
+    int32_t thread;
+    int32_t dropped; /* records lost to a failed allocation */
+    uint64_t num_records;
+};
+
+struct osu_prof_record {
+    uint64_t t_start; /* ns from MPI_Init */
+    uint64_t t_end;
+    uint64_t bytes; /* sent, received or contributed by this rank */
+    int32_t peer;   /* world rank of the peer or root, -1 if none */
+    uint16_t comm;
+    uint8_t func;
+    uint8_t pad;
+};
+
+#endif
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2002-2024 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * Prints the binary traces of libosu_prof, one record per line:
+ *
+ *   osu_prof_dump osu_prof.*.trace
+ *
+ * With -r the records on MPI_COMM_WORLD are printed instead as an
+ * osu_replay trace, the time between two calls of a rank becoming its
+ * compute gap. Calls osu_replay has no operation for, and calls on other
+ * communicators, are kept as comments. The records of the threads of a
+ * rank are merged by start time.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "osu_prof.h"
+
+static const char *func_names[OSU_PROF_NUM_FUNCS] = OSU_PROF_FUNC_NAMES;
+
+/* osu_replay operation of every function, NULL if it has none */
+static const char *replay_ops[OSU_PROF_NUM_FUNCS] = {
+    "send",      "send",      "isend",     "recv",      "irecv",
+    NULL,        "waitall",   "waitall",   "barrier",   "bcast",
+    "reduce",    "allreduce", "gather",    "scatter",   "allgather",
+    "alltoall",  NULL,        NULL};
+
+static int compare_start(const void *a, const void *b)
+{
+    const struct osu_prof_record *ra = a, *rb = b;
+
+    return (ra->t_start > rb->t_start) - (ra->t_start < rb->t_start);
+}
+
+static int is_rooted(int func)
+{
+    return OSU_PROF_BCAST == func || OSU_PROF_REDUCE == func ||
+           OSU_PROF_GATHER == func || OSU_PROF_SCATTER == func;
+}
+
+static void print_replay(const struct osu_prof_file_header *header,
+                         const struct osu_prof_record *records,
+                         uint64_t num_records)
+{
+    uint64_t i, t_prev = 0;
+    const struct osu_prof_record *record = NULL;
+
+    for (i = 0; i < num_records; i++) {
+        record = &records[i];
+        if (0 != record->comm || NULL == replay_ops[record->func] ||
+            (-1 == record->peer && OSU_PROF_IRECV == record->func)) {
+            printf("# %d %s on communicator %d, peer %d, %llu bytes\n",
+                   header->rank, func_names[record->func], record->comm,
+                   record->peer, (unsigned long long)record->bytes);
+            continue;
+        }
+        printf("%d %s ", header->rank, replay_ops[record->func]);
+        if (record->func <= OSU_PROF_IRECV || is_rooted(record->func)) {
+            printf("%d", record->peer);
+        } else {
+            printf("-");
+        }
+        printf(" %llu %.3f\n", (unsigned long long)record->bytes,
+               (record->t_start > t_prev) ?
+                   (record->t_start - t_prev) / 1e3 :
+                   0.0);
+        t_prev = record->t_end;
+    }
+}
+
+static void print_records(const struct osu_prof_file_header *header,
+                          const struct osu_prof_record *records,
+                          uint64_t num_records)
+{
+    uint64_t i;
+    const struct osu_prof_record *record = NULL;
+
+    for (i = 0; i < num_records; i++) {
+        record = &records[i];
+        printf("%-*d%*.3f%*.3f  %-*s%*d%*d%*llu\n", 8, header->rank, 16,
+               record->t_start / 1e3, 14,
+               (record->t_end - record->t_start) / 1e3, 20,
+               func_names[record->func], 8, record->comm, 8, record->peer,
+               16, (unsigned long long)record->bytes);
+    }
+}
+
+static int dump_file(const char *path, int replay)
+{
+    int t, ret = EXIT_FAILURE;
+    uint64_t num_records = 0;
+    struct osu_prof_file_header header;
+    struct osu_prof_thread_header thread_header;
+    struct osu_prof_record *records = NULL, *grown = NULL;
+    FILE *fp = fopen(path, "rb");
+
+    if (NULL == fp) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return EXIT_FAILURE;
+    }
+    if (1 != fread(&header, sizeof(header), 1, fp) ||
+        0 != strcmp(header.magic, OSU_PROF_MAGIC) ||
+        OSU_PROF_VERSION != header.version) {
+        fprintf(stderr, "%s is not an osu_prof trace\n", path);
+        goto out;
+    }
+    for (t = 0; t < header.num_threads; t++) {
+        if (1 != fread(&thread_header, sizeof(thread_header), 1, fp)) {
+            fprintf(stderr, "%s is truncated\n", path);
+            goto out;
+        }
+        if (thread_header.dropped) {
+            fprintf(stderr, "%s: thread %d lost %d records\n", path,
+                    thread_header.thread, thread_header.dropped);
+        }
+        grown = realloc(records, (num_records + thread_header.num_records) *
+                                     sizeof(struct osu_prof_record));
+        if (NULL == grown && 0 < thread_header.num_records) {
+            fprintf(stderr, "Unable to allocate memory\n");
+            goto out;
+        }
+        records = grown;
+        if (thread_header.num_records !=
+            fread(records + num_records, sizeof(struct osu_prof_record),
+                  thread_header.num_records, fp)) {
+            fprintf(stderr, "%s is truncated\n", path);
+            goto out;
+        }
+        num_records += thread_header.num_records;
+    }
+    qsort(records, num_records, sizeof(struct osu_prof_record),
+          compare_start);
+    if (replay) {
+        printf("# Rank %d of %d, %llu records\n", header.rank, header.size,
+               (unsigned long long)num_records);
+        print_replay(&header, records, num_records);
+    } else {
+        print_records(&header, records, num_records);
+    }
+    ret = EXIT_SUCCESS;
+out:
+    free(records);
+    fclose(fp);
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    int c, i, replay = 0, ret = EXIT_SUCCESS;
+
+    while (-1 != (c = getopt(argc, argv, "rh"))) {
+        switch (c) {
+            case 'r':
+                replay = 1;
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-r] TRACE...\n"
+                                "  -r  print an osu_replay trace\n",
+                        argv[0]);
+                return ('h' == c) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (optind == argc) {
+        fprintf(stderr, "Usage: %s [-r] TRACE...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (!replay) {
+        printf("%-*s%*s%*s  %-*s%*s%*s%*s\n", 8, "# Rank", 16, "Start(us)",
+               14, "Time(us)", 20, "Function", 8, "Comm", 8, "Peer", 16,
+               "Bytes");
+    }
+    for (i = optind; i < argc; i++) {
+        if (EXIT_SUCCESS != dump_file(argv[i], replay)) {
+            ret = EXIT_FAILURE;
+        }
+    }
+    return ret;
+}
@@ -18,17 +18,19 @@ int main(int argc, char *argv[])
     int myid = 0, numprocs = 0, i = 0, j = 0, k = 0, l = 0;
     int size;
     char **s_buf, **r_buf;
+    void *sbuf = NULL, *rbuf = NULL;
     double t_start = 0.0, t_end = 0.0, t_lo = 0.0, t_total = 0.0;
     int window_size = 64;
     int po_ret = 0;
     int errors = 0;
-    double tmp_total = 0.0;
+    double tmp_total = 0.0, bandwidth = 0.0;
     omb_graph_options_t omb_graph_options;
     omb_graph_data_t *omb_graph_data = NULL;
     MPI_Datatype omb_curr_datatype = MPI_CHAR;
     size_t num_elements = 0;
     size_t omb_ddt_transmit_size = 0;
     int mpi_type_itr = 0, mpi_type_size = 0, mpi_type_name_length = 0;
+    int omb_pass = 0;
     char mpi_type_name_str[OMB_DATATYPE_STR_MAX_LEN];
     MPI_Datatype mpi_type_list[OMB_NUM_DATATYPES];
     int papi_eventset = OMB_PAPI_NULL;
@@ -143,9 +145,12 @@ int main(int argc, char *argv[])
     print_preamble(myid);
     omb_papi_init(&papi_eventset);
 
-    /* Bandwidth test */
-    for (mpi_type_itr = 0; mpi_type_itr < options.omb_dtype_itr;
-         mpi_type_itr++) {
+    /* Bandwidth test, one pass per datatype and cache state */
+    for (omb_pass = 0;
+         omb_pass < options.omb_dtype_itr * omb_cache_num_passes();
+         omb_pass++) {
+        mpi_type_itr = omb_pass / omb_cache_num_passes();
+        omb_cache_select(omb_pass % omb_cache_num_passes(), myid);
         MPI_CHECK(MPI_Type_size(mpi_type_list[mpi_type_itr], &mpi_type_size));
         MPI_CHECK(MPI_Type_get_name(mpi_type_list[mpi_type_itr],
                                     mpi_type_name_str, &mpi_type_name_length));
@@ -155,8 +160,9 @@ int main(int argc, char *argv[])
         }
         fflush(stdout);
         print_only_header(myid);
-        for (size = options.min_message_size; size <= options.max_message_size;
-             size *= 2) {
+        for (size = omb_adaptive_first(&bandwidth);
+             size <= options.max_message_size;
+             size = omb_adaptive_next(omb_comm, size, &bandwidth)) {
             num_elements = size / mpi_type_size;
             if (0 == num_elements) {
                 continue;
@@ -234,15 +240,14 @@ int main(int argc, char *argv[])
 #endif /* #ifdef _ENABLE_CUDA_KERNEL_ */
 
                         for (j = 0; j < window_size; j++) {
-                            if (options.buf_num == SINGLE) {
-                                MPI_CHECK(MPI_Isend(s_buf[0], num_elements,
-                                                    omb_curr_datatype, 1, 100,
-                                                    omb_comm, request + j));
-                            } else {
-                                MPI_CHECK(MPI_Isend(s_buf[j], num_elements,
-                                                    omb_curr_datatype, 1, 100,
-                                                    omb_comm, request + j));
-                            }
+                            sbuf = (options.buf_num == SINGLE) ? s_buf[0]
+                                                               : s_buf[j];
+                            sbuf = omb_cache_buf(sbuf, size,
+                                                 i * window_size + j,
+                                                 OMB_CACHE_SBUF);
+                            MPI_CHECK(MPI_Isend(sbuf, num_elements,
+                                                omb_curr_datatype, 1, 100,
+                                                omb_comm, request + j));
                         }
                         MPI_CHECK(MPI_Waitall(window_size, request, reqstat));
 
@@ -302,15 +307,14 @@ int main(int argc, char *argv[])
                         }
 #endif /* #ifdef _ENABLE_CUDA_KERNEL_ */
                         for (j = 0; j < window_size; j++) {
-                            if (options.buf_num == SINGLE) {
-                                MPI_CHECK(MPI_Irecv(r_buf[0], num_elements,
-                                                    omb_curr_datatype, 0, 100,
-                                                    omb_comm, request + j));
-                            } else {
-                                MPI_CHECK(MPI_Irecv(r_buf[j], num_elements,
-                                                    omb_curr_datatype, 0, 100,
-                                                    omb_comm, request + j));
-                            }
+                            rbuf = (options.buf_num == SINGLE) ? r_buf[0]
+                                                               : r_buf[j];
+                            rbuf = omb_cache_buf(rbuf, size,
+                                                 i * window_size + j,
+                                                 OMB_CACHE_RBUF);
+                            MPI_CHECK(MPI_Irecv(rbuf, num_elements,
+                                                omb_curr_datatype, 0, 100,
+                                                omb_comm, request + j));
                         }
                         MPI_CHECK(MPI_Waitall(window_size, request, reqstat));
 
@@ -367,14 +371,14 @@ int main(int argc, char *argv[])
                 } else {
                     tmp_total = size / 1e6 * options.iterations * window_size;
                 }
+                bandwidth = tmp_total / t_total;
                 fprintf(stdout, "%-*d", 10, size);
                 if (options.validate) {
                     fprintf(stdout, "%*.*f%*s", FIELD_WIDTH, FLOAT_PRECISION,
-                            tmp_total / t_total, FIELD_WIDTH,
-                            VALIDATION_STATUS(errors));
+                            bandwidth, FIELD_WIDTH, VALIDATION_STATUS(errors));
                 } else {
                     fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
-                            tmp_total / t_total);
+                            bandwidth);
                 }
                 if (options.omb_tail_lat) {
                     omb_stat = omb_calculate_tail_lat(omb_lat_arr, myid, 1);
@@ -386,7 +390,7 @@ int main(int argc, char *argv[])
                 fprintf(stdout, "\n");
                 fflush(stdout);
                 if (options.graph && 0 == myid) {
-                    omb_graph_data->avg = tmp_total / t_total;
+                    omb_graph_data->avg = bandwidth;
                 }
             }
             omb_ddt_free(&omb_curr_datatype);
@@ -403,6 +407,7 @@ int main(int argc, char *argv[])
                 }
             }
         }
+        omb_adaptive_finalize(myid);
     }
     if (options.graph) {
         omb_graph_plot(&omb_graph_options, benchmark_name);
@@ -20,13 +20,16 @@ int main(int argc, char *argv[])
     omb_graph_options_t omb_graph_options;
     omb_graph_data_t *omb_graph_data = NULL;
     char *s_buf, *r_buf;
+    void *sbuf = NULL, *rbuf = NULL;
     double t_start = 0.0, t_end = 0.0, t_lo = 0.0, t_total = 0.0;
+    double latency = 0.0;
     int po_ret = 0;
     int errors = 0;
     size_t num_elements = 0;
     MPI_Datatype omb_curr_datatype = MPI_CHAR;
     size_t omb_ddt_transmit_size = 0;
     int mpi_type_itr = 0, mpi_type_size = 0, mpi_type_name_length = 0;
+    int omb_pass = 0;
     char mpi_type_name_str[OMB_DATATYPE_STR_MAX_LEN];
     MPI_Datatype mpi_type_list[OMB_NUM_DATATYPES];
     int papi_eventset = OMB_PAPI_NULL;
@@ -123,9 +126,12 @@ int main(int argc, char *argv[])
     print_preamble(myid);
     omb_papi_init(&papi_eventset);
 
-    /* Latency test */
-    for (mpi_type_itr = 0; mpi_type_itr < options.omb_dtype_itr;
-         mpi_type_itr++) {
+    /* Latency test, one pass per datatype and cache state */
+    for (omb_pass = 0;
+         omb_pass < options.omb_dtype_itr * omb_cache_num_passes();
+         omb_pass++) {
+        mpi_type_itr = omb_pass / omb_cache_num_passes();
+        omb_cache_select(omb_pass % omb_cache_num_passes(), myid);
         MPI_CHECK(MPI_Type_size(mpi_type_list[mpi_type_itr], &mpi_type_size));
         MPI_CHECK(MPI_Type_get_name(mpi_type_list[mpi_type_itr],
                                     mpi_type_name_str, &mpi_type_name_length));
@@ -135,8 +141,9 @@ int main(int argc, char *argv[])
         }
         fflush(stdout);
         print_only_header(myid);
-        for (size = options.min_message_size; size <= options.max_message_size;
-             size = (size ? size * 2 : 1)) {
+        for (size = omb_adaptive_first(&latency);
+             size <= options.max_message_size;
+             size = omb_adaptive_next(omb_comm, size, &latency)) {
             num_elements = size / mpi_type_size;
             if (0 == num_elements) {
                 continue;
@@ -183,6 +190,8 @@ int main(int argc, char *argv[])
                                           omb_curr_datatype, omb_buffer_sizes);
                     MPI_CHECK(MPI_Barrier(omb_comm));
                 }
+                sbuf = omb_cache_buf(s_buf, size, i, OMB_CACHE_SBUF);
+                rbuf = omb_cache_buf(r_buf, size, i, OMB_CACHE_RBUF);
                 if (myid == 0) {
                     for (j = 0; j <= options.warmup_validation; j++) {
                         if (i >= options.skip &&
@@ -194,9 +203,9 @@ int main(int argc, char *argv[])
                             touch_managed_src_no_window(s_buf, size, ADD);
                         }
 #endif /* #ifdef _ENABLE_CUDA_KERNEL_ */
-                        MPI_CHECK(MPI_Send(s_buf, num_elements,
+                        MPI_CHECK(MPI_Send(sbuf, num_elements,
                                            omb_curr_datatype, 1, 1, omb_comm));
-                        MPI_CHECK(MPI_Recv(r_buf, num_elements,
+                        MPI_CHECK(MPI_Recv(rbuf, num_elements,
                                            omb_curr_datatype, 1, 1, omb_comm,
                                            &reqstat));
 #ifdef _ENABLE_CUDA_KERNEL_
@@ -239,7 +248,7 @@ int main(int argc, char *argv[])
                             touch_managed_dst_no_window(s_buf, size, ADD);
                         }
 #endif /* #ifdef _ENABLE_CUDA_KERNEL_ */
-                        MPI_CHECK(MPI_Recv(r_buf, num_elements,
+                        MPI_CHECK(MPI_Recv(rbuf, num_elements,
                                            omb_curr_datatype, 0, 1, omb_comm,
                                            &reqstat));
 #ifdef _ENABLE_CUDA_KERNEL_
@@ -247,7 +256,7 @@ int main(int argc, char *argv[])
                             touch_managed_dst_no_window(r_buf, size, SUB);
                         }
 #endif /* #ifdef _ENABLE_CUDA_KERNEL_ */
-                        MPI_CHECK(MPI_Send(s_buf, num_elements,
+                        MPI_CHECK(MPI_Send(sbuf, num_elements,
                                            omb_curr_datatype, 0, 1, omb_comm));
                     }
 #ifdef _ENABLE_CUDA_KERNEL_
@@ -275,7 +284,7 @@ int main(int argc, char *argv[])
             omb_papi_stop_and_print(&papi_eventset, size);
 
             if (myid == 0) {
-                double latency = (t_total * 1e6) / (2.0 * options.iterations);
+                latency = (t_total * 1e6) / (2.0 * options.iterations);
                 fprintf(stdout, "%-*d", 10, size);
                 if (options.validate) {
                     fprintf(stdout, "%*.*f%*s", FIELD_WIDTH, FLOAT_PRECISION,
@@ -309,6 +318,7 @@ int main(int argc, char *argv[])
                 }
             }
         }
+        omb_adaptive_finalize(myid);
     }
     if (options.graph) {
         omb_graph_plot(&omb_graph_options, benchmark_name);
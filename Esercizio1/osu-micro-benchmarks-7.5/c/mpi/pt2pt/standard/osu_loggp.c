@@ -0,0 +1,500 @@
+#define BENCHMARK "OSU MPI%s LogGP Parameter Test"
+/*
+ * Copyright (c) 2002-2024 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * LogGP and Hockney parameters for one pair of ranks of every placement
+ * class found in the job: same L3 (CCX), same socket, across sockets and
+ * across nodes. Ranks are meant to be pinned one per core, e.g. mpirun
+ * --map-by core --bind-to core. For every size the pair runs the
+ * parametrized round trips PRTT(n, d, s) of Kielmann et al., where rank a
+ * sends n messages of s bytes with a delay d between them and rank b
+ * answers the last one:
+ *
+ *   RTT(s) = PRTT(1, 0, s)
+ *   g(s)   = (PRTT(n, 0, s) - RTT(s)) / (n - 1)
+ *   o_s(s) = (PRTT(n, d, s) - RTT(s)) / (n - 1) - d,  with d = RTT(s) > g(s)
+ *
+ * and o_r(s) is the time of a receive posted 2 RTT(s) + g(s) after the
+ * request was sent, well after the answer arrived, so that no wait for it
+ * is counted.
+ * L = RTT(s)/2 - o_s(s) - o_r(s) - (s - 1) G at the smallest size, and G is
+ * the slope of g(s) over the largest sizes. The Hockney model RTT(s)/2 =
+ * alpha + beta s is fitted separately on every size regime of at least
+ * OMB_FIT_MIN_POINTS sizes. A negative L or beta means the model does not
+ * hold for the pair, they are printed as "-". Only the pair under test
+ * runs, the other ranks wait on a token without polling.
+ */
+#include <osu_util_mpi.h>
+
+#define TOKEN_TAG 100
+#define PING_TAG  101
+
+enum pair_class { SAME_L3, SAME_SOCKET, CROSS_SOCKET, CROSS_NODE, NUM_CLASSES };
+
+static const char *class_names[NUM_CLASSES] = {"same-ccx", "same-socket",
+                                               "cross-socket", "cross-node"};
+
+/* Per size results: RTT/2, o_s, o_r and g, all in us */
+enum loggp_value { HALF_RTT, SEND_OVERHEAD, RECV_OVERHEAD, GAP, NUM_VALUES };
+
+/* Fitted model: L, o_s, o_r and g in us, G in us per byte */
+enum loggp_param {
+    PARAM_L,
+    PARAM_OS,
+    PARAM_OR,
+    PARAM_G,
+    PARAM_BIG_G,
+    NUM_PARAMS
+};
+
+static void busy_wait(double delay)
+{
+    double t_start = MPI_Wtime();
+
+    while (MPI_Wtime() - t_start < delay) {
+    }
+}
+
+/* PRTT(n, delay, size) between initiator a and echo b, in us */
+static double loggp_prtt(int myid, int a, int b, int n, double delay,
+                         char *s_buf, char *r_buf, int size, MPI_Comm comm)
+{
+    double t_start = 0.0;
+    int i, j;
+
+    for (i = 0; i < options.iterations + options.skip; i++) {
+        if (i == options.skip) {
+            t_start = MPI_Wtime();
+        }
+        if (myid == a) {
+            for (j = 0; j < n; j++) {
+                MPI_CHECK(MPI_Send(s_buf, size, MPI_CHAR, b, PING_TAG, comm));
+                if (j + 1 < n && 0 < delay) {
+                    busy_wait(delay);
+                }
+            }
+            MPI_CHECK(MPI_Recv(r_buf, size, MPI_CHAR, b, PING_TAG, comm,
+                               MPI_STATUS_IGNORE));
+        } else {
+            for (j = 0; j < n; j++) {
+                MPI_CHECK(MPI_Recv(r_buf, size, MPI_CHAR, a, PING_TAG, comm,
+                                   MPI_STATUS_IGNORE));
+            }
+            MPI_CHECK(MPI_Send(s_buf, size, MPI_CHAR, a, PING_TAG, comm));
+        }
+    }
+
+    return (MPI_Wtime() - t_start) * 1e6 / options.iterations;
+}
+
+/* Time of a receive posted delay after the request was sent, in us */
+static double loggp_recv_overhead(int myid, int a, int b, double delay,
+                                  char *s_buf, char *r_buf, int size,
+                                  MPI_Comm comm)
+{
+    double t_recv = 0.0, t_total = 0.0;
+    int i;
+
+    for (i = 0; i < options.iterations + options.skip; i++) {
+        if (myid == a) {
+            MPI_CHECK(MPI_Send(s_buf, size, MPI_CHAR, b, PING_TAG, comm));
+            busy_wait(delay);
+            t_recv = MPI_Wtime();
+            MPI_CHECK(MPI_Recv(r_buf, size, MPI_CHAR, b, PING_TAG, comm,
+                               MPI_STATUS_IGNORE));
+            if (i >= options.skip) {
+                t_total += MPI_Wtime() - t_recv;
+            }
+        } else {
+            MPI_CHECK(MPI_Recv(r_buf, size, MPI_CHAR, a, PING_TAG, comm,
+                               MPI_STATUS_IGNORE));
+            MPI_CHECK(MPI_Send(s_buf, size, MPI_CHAR, a, PING_TAG, comm));
+        }
+    }
+
+    return t_total * 1e6 / options.iterations;
+}
+
+static void loggp_measure(int myid, int a, int b, char *s_buf, char *r_buf,
+                          int size, MPI_Comm comm, double *values)
+{
+    int n = options.window_size;
+    double rtt, prtt_gap, prtt_send;
+
+    rtt = loggp_prtt(myid, a, b, 1, 0, s_buf, r_buf, size, comm);
+    prtt_gap = loggp_prtt(myid, a, b, n, 0, s_buf, r_buf, size, comm);
+    prtt_send =
+        loggp_prtt(myid, a, b, n, rtt / 1e6, s_buf, r_buf, size, comm);
+
+    values[HALF_RTT] = rtt / 2;
+    values[GAP] = (prtt_gap - rtt) / (n - 1);
+    values[SEND_OVERHEAD] = (prtt_send - rtt) / (n - 1) - rtt;
+    values[RECV_OVERHEAD] = loggp_recv_overhead(
+        myid, a, b, (2 * rtt + fmax(values[GAP], 0)) / 1e6, s_buf, r_buf,
+        size, comm);
+}
+
+static enum pair_class classify(const struct omb_rank_place_t *places,
+                                const int *nodes, int i, int j)
+{
+    if (nodes[i] != nodes[j]) {
+        return CROSS_NODE;
+    }
+    if (places[i].socket != places[j].socket) {
+        return CROSS_SOCKET;
+    }
+    if (0 <= places[i].l3 && places[i].l3 == places[j].l3) {
+        return SAME_L3;
+    }
+    return SAME_SOCKET;
+}
+
+/* Prints the per size values and the Hockney regimes of one pair class */
+static void print_class(int c, int a, int b, const double *x,
+                        const double *values, int nsizes, double *loggp)
+{
+    int i, r, num_regimes;
+    double *y = malloc(nsizes * sizeof(double));
+    double *alpha = malloc(nsizes * sizeof(double));
+    double *beta = malloc(nsizes * sizeof(double));
+    int *first = malloc((nsizes + 1) * sizeof(int));
+    const double *v0 = values;
+
+    OMB_CHECK_NULL_AND_EXIT(y, "Unable to allocate memory");
+    OMB_CHECK_NULL_AND_EXIT(alpha, "Unable to allocate memory");
+    OMB_CHECK_NULL_AND_EXIT(beta, "Unable to allocate memory");
+    OMB_CHECK_NULL_AND_EXIT(first, "Unable to allocate memory");
+
+    fprintf(stdout, "\n# Pair class %s: ranks %d and %d\n", class_names[c], a,
+            b);
+    fprintf(stdout, "%-*s%*s%*s%*s%*s\n", 10, "# Size", FIELD_WIDTH,
+            "RTT/2(us)", FIELD_WIDTH, "o_s(us)", FIELD_WIDTH, "o_r(us)",
+            FIELD_WIDTH, "g(us)");
+    for (i = 0; i < nsizes; i++) {
+        const double *v = values + i * NUM_VALUES;
+
+        fprintf(stdout, "%-*.0f%*.*f%*.*f%*.*f%*.*f\n", 10, x[i], FIELD_WIDTH,
+                FLOAT_PRECISION, v[HALF_RTT], FIELD_WIDTH, FLOAT_PRECISION,
+                v[SEND_OVERHEAD], FIELD_WIDTH, FLOAT_PRECISION,
+                v[RECV_OVERHEAD], FIELD_WIDTH, FLOAT_PRECISION, v[GAP]);
+    }
+
+    /* G is the per byte gap of the regime of the largest sizes */
+    for (i = 0; i < nsizes; i++) {
+        y[i] = values[i * NUM_VALUES + GAP];
+    }
+    num_regimes = omb_fit_regimes(x, y, nsizes, OMB_FIT_TOLERANCE,
+                                  OMB_FIT_MIN_POINTS, first, alpha, beta);
+    loggp[PARAM_BIG_G] = fmax(beta[num_regimes - 1], 0);
+    loggp[PARAM_L] = v0[HALF_RTT] - v0[SEND_OVERHEAD] - v0[RECV_OVERHEAD] -
+                     fmax(x[0] - 1, 0) * loggp[PARAM_BIG_G];
+    loggp[PARAM_OS] = v0[SEND_OVERHEAD];
+    loggp[PARAM_OR] = v0[RECV_OVERHEAD];
+    loggp[PARAM_G] = v0[GAP];
+
+    for (i = 0; i < nsizes; i++) {
+        y[i] = values[i * NUM_VALUES + HALF_RTT];
+    }
+    num_regimes = omb_fit_regimes(x, y, nsizes, OMB_FIT_TOLERANCE,
+                                  OMB_FIT_MIN_POINTS, first, alpha, beta);
+    fprintf(stdout, "# Hockney model RTT/2 = alpha + beta * size\n");
+    fprintf(stdout, "%-*s%*s%*s%*s%*s\n", 10, "# From", FIELD_WIDTH, "To",
+            FIELD_WIDTH, "Alpha(us)", FIELD_WIDTH, "Beta(ns/B)", FIELD_WIDTH,
+            "1/Beta(MB/s)");
+    for (r = 0; r < num_regimes; r++) {
+        fprintf(stdout, "%-*.0f%*.0f%*.*f", 10, x[first[r]], FIELD_WIDTH,
+                x[first[r + 1] - 1], FIELD_WIDTH, FLOAT_PRECISION, alpha[r]);
+        if (0 < beta[r]) {
+            fprintf(stdout, "%*.*f%*.*f\n", FIELD_WIDTH, 3, beta[r] * 1e3,
+                    FIELD_WIDTH, FLOAT_PRECISION, 1 / beta[r]);
+        } else if (0 == beta[r]) {
+            fprintf(stdout, "%*.*f%*s\n", FIELD_WIDTH, 3, 0.0, FIELD_WIDTH,
+                    "-");
+        } else {
+            /* Time falling with the size is noise, not a bandwidth */
+            fprintf(stdout, "%*s%*s\n", FIELD_WIDTH, "-", FIELD_WIDTH, "-");
+        }
+    }
+    fflush(stdout);
+
+    free(y);
+    free(alpha);
+    free(beta);
+    free(first);
+}
+
+int main(int argc, char *argv[])
+{
+    int myid, numprocs, i, j, c, p;
+    int size, nsizes = 0, size_index;
+    char *s_buf = NULL, *r_buf = NULL;
+    int po_ret = 0;
+    int npairs = 0, negative_latency = 0;
+    int pair_a[NUM_CLASSES], pair_b[NUM_CLASSES], pair_class[NUM_CLASSES];
+    int node, *nodes = NULL;
+    double *values = NULL, *values_sum = NULL, *x = NULL;
+    double loggp[NUM_CLASSES][NUM_PARAMS];
+    struct omb_rank_place_t place, *places = NULL;
+    MPI_Request token;
+    MPI_Comm node_comm;
+    MPI_Comm omb_comm = MPI_COMM_NULL;
+    omb_mpi_init_data omb_init_h;
+    options.bench = PT2PT;
+    options.subtype = LOGGP;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_loggp");
+
+    po_ret = process_options(argc, argv);
+
+    omb_init_h = omb_mpi_init(&argc, &argv);
+    omb_comm = omb_init_h.omb_comm;
+    if (MPI_COMM_NULL == omb_comm) {
+        OMB_ERROR_EXIT("Cant create communicator");
+    }
+    MPI_CHECK(MPI_Comm_rank(omb_comm, &myid));
+    MPI_CHECK(MPI_Comm_size(omb_comm, &numprocs));
+
+    if (0 == myid) {
+        switch (po_ret) {
+            case PO_BAD_USAGE:
+                print_bad_usage_message(myid);
+                break;
+            case PO_HELP_MESSAGE:
+                print_help_message(myid);
+                break;
+            case PO_VERSION_MESSAGE:
+                print_version_message(myid);
+                omb_mpi_finalize(omb_init_h);
+                exit(EXIT_SUCCESS);
+            default:
+                break;
+        }
+    }
+
+    switch (po_ret) {
+        case PO_OKAY:
+            break;
+        case PO_HELP_MESSAGE:
+        case PO_VERSION_MESSAGE:
+            omb_mpi_finalize(omb_init_h);
+            exit(EXIT_SUCCESS);
+        default:
+            omb_mpi_finalize(omb_init_h);
+            exit(EXIT_FAILURE);
+    }
+
+    if (numprocs < 2 || options.window_size < 2) {
+        if (myid == 0) {
+            fprintf(stderr, "This test requires at least two processes and"
+                            " a window of at least two messages\n");
+        }
+
+        omb_mpi_finalize(omb_init_h);
+        exit(EXIT_FAILURE);
+    }
+
+    /* Nodes are told apart by the lowest rank sharing their memory */
+    MPI_CHECK(MPI_Comm_split_type(omb_comm, MPI_COMM_TYPE_SHARED, myid,
+                                  MPI_INFO_NULL, &node_comm));
+    node = myid;
+    MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &node, 1, MPI_INT, MPI_MIN,
+                            node_comm));
+    MPI_CHECK(MPI_Comm_free(&node_comm));
+
+    omb_get_rank_place(&place);
+    if (0 == myid) {
+        places = malloc(numprocs * sizeof(struct omb_rank_place_t));
+        nodes = malloc(numprocs * sizeof(int));
+        OMB_CHECK_NULL_AND_EXIT(places, "Unable to allocate memory");
+        OMB_CHECK_NULL_AND_EXIT(nodes, "Unable to allocate memory");
+    }
+    MPI_CHECK(MPI_Gather(&place, sizeof(place), MPI_BYTE, places, sizeof(place),
+                         MPI_BYTE, 0, omb_comm));
+    MPI_CHECK(MPI_Gather(&node, 1, MPI_INT, nodes, 1, MPI_INT, 0, omb_comm));
+
+    /* The first pair in rank order of every class found */
+    if (0 == myid) {
+        int found[NUM_CLASSES] = {0};
+
+        for (i = 0; i < numprocs; i++) {
+            for (j = i + 1; j < numprocs; j++) {
+                c = classify(places, nodes, i, j);
+                if (!found[c]) {
+                    found[c] = 1;
+                    pair_a[c] = i;
+                    pair_b[c] = j;
+                }
+            }
+        }
+        for (c = 0; c < NUM_CLASSES; c++) {
+            if (found[c]) {
+                pair_a[npairs] = pair_a[c];
+                pair_b[npairs] = pair_b[c];
+                pair_class[npairs] = c;
+                npairs++;
+            }
+        }
+    }
+    MPI_CHECK(MPI_Bcast(&npairs, 1, MPI_INT, 0, omb_comm));
+    MPI_CHECK(MPI_Bcast(pair_a, npairs, MPI_INT, 0, omb_comm));
+    MPI_CHECK(MPI_Bcast(pair_b, npairs, MPI_INT, 0, omb_comm));
+    MPI_CHECK(MPI_Bcast(pair_class, npairs, MPI_INT, 0, omb_comm));
+
+    for (size = options.min_message_size; size <= options.max_message_size;
+         size = (size ? size * 2 : 1)) {
+        nsizes++;
+    }
+
+    /* Results are indexed by (pair, size, value) and kept by rank a */
+    values = calloc((size_t)npairs * nsizes * NUM_VALUES, sizeof(double));
+    OMB_CHECK_NULL_AND_EXIT(values, "Unable to allocate memory");
+
+    if (omb_mem_alloc((void **)&s_buf, sysconf(_SC_PAGESIZE),
+                      options.max_message_size, OMB_MEM_SBUF) ||
+        omb_mem_alloc((void **)&r_buf, sysconf(_SC_PAGESIZE),
+                      options.max_message_size, OMB_MEM_RBUF)) {
+        fprintf(stderr, "Error allocating host memory\n");
+        omb_mpi_finalize(omb_init_h);
+        exit(EXIT_FAILURE);
+    }
+    memset(s_buf, 'a', options.max_message_size);
+    memset(r_buf, 'b', options.max_message_size);
+
+    print_preamble(myid);
+    if (0 == myid) {
+        fprintf(stdout, "# %d pair classes, %d messages per burst\n", npairs,
+                options.window_size);
+        fflush(stdout);
+    }
+
+    /*
+     * One pair at a time: when pair p is done its rank a hands a token to the
+     * ranks of pair p + 1, which sleep until it arrives.
+     */
+    for (p = 0; p < npairs; p++) {
+        int a = pair_a[p], b = pair_b[p];
+
+        if (myid != a && myid != b) {
+            continue;
+        }
+
+        if (p > 0 && myid != pair_a[p - 1]) {
+            MPI_CHECK(MPI_Irecv(NULL, 0, MPI_CHAR, pair_a[p - 1], TOKEN_TAG,
+                                omb_comm, &token));
+            omb_quiet_wait(&token);
+        }
+
+        size_index = 0;
+        for (size = options.min_message_size;
+             size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+            size_t iterations = options.iterations, skip = options.skip;
+            double v[NUM_VALUES];
+
+            if (size > LARGE_MESSAGE_SIZE) {
+                options.iterations = options.iterations_large;
+                options.skip = options.skip_large;
+            }
+
+            loggp_measure(myid, a, b, s_buf, r_buf, size, omb_comm, v);
+            if (myid == a) {
+                memcpy(values + ((size_t)p * nsizes + size_index) * NUM_VALUES,
+                       v, sizeof(v));
+            }
+
+            options.iterations = iterations;
+            options.skip = skip;
+            size_index++;
+        }
+
+        if (myid == a && p + 1 < npairs) {
+            if (pair_a[p + 1] != a) {
+                MPI_CHECK(MPI_Send(NULL, 0, MPI_CHAR, pair_a[p + 1], TOKEN_TAG,
+                                   omb_comm));
+            }
+            if (pair_b[p + 1] != a) {
+                MPI_CHECK(MPI_Send(NULL, 0, MPI_CHAR, pair_b[p + 1], TOKEN_TAG,
+                                   omb_comm));
+            }
+        }
+    }
+
+    MPI_CHECK(MPI_Ibarrier(omb_comm, &token));
+    omb_quiet_wait(&token);
+
+    /* Only rank a of every pair holds its results, so a sum collects them */
+    if (0 == myid) {
+        values_sum =
+            malloc((size_t)npairs * nsizes * NUM_VALUES * sizeof(double));
+        x = malloc(nsizes * sizeof(double));
+        OMB_CHECK_NULL_AND_EXIT(values_sum, "Unable to allocate memory");
+        OMB_CHECK_NULL_AND_EXIT(x, "Unable to allocate memory");
+    }
+    MPI_CHECK(MPI_Reduce(values, values_sum, npairs * nsizes * NUM_VALUES,
+                         MPI_DOUBLE, MPI_SUM, 0, omb_comm));
+
+    if (0 == myid) {
+        size_index = 0;
+        for (size = options.min_message_size;
+             size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+            x[size_index++] = size;
+        }
+        for (p = 0; p < npairs; p++) {
+            print_class(pair_class[p], pair_a[p], pair_b[p], x,
+                        values_sum + (size_t)p * nsizes * NUM_VALUES, nsizes,
+                        loggp[p]);
+        }
+
+        fprintf(stdout, "\n# LogGP parameters: L, o_s, o_r and g at size %zu,"
+                        " G from the largest sizes\n",
+                options.min_message_size);
+        fprintf(stdout, "%-*s%*s%*s%*s%*s%*s%*s\n", 14, "# Class", 12,
+                "Ranks", FIELD_WIDTH, "L(us)", FIELD_WIDTH, "o_s(us)",
+                FIELD_WIDTH, "o_r(us)", FIELD_WIDTH, "g(us)", FIELD_WIDTH,
+                "G(ns/B)");
+        for (p = 0; p < npairs; p++) {
+            char ranks[32];
+
+            snprintf(ranks, sizeof(ranks), "%d-%d", pair_a[p], pair_b[p]);
+            fprintf(stdout, "%-*s%*s", 14, class_names[pair_class[p]], 12,
+                    ranks);
+            if (0 > loggp[p][PARAM_L]) {
+                fprintf(stdout, "%*s", FIELD_WIDTH, "-");
+                negative_latency = 1;
+            } else {
+                fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                        loggp[p][PARAM_L]);
+            }
+            fprintf(stdout, "%*.*f%*.*f%*.*f%*.*f\n", FIELD_WIDTH,
+                    FLOAT_PRECISION, loggp[p][PARAM_OS], FIELD_WIDTH,
+                    FLOAT_PRECISION, loggp[p][PARAM_OR], FIELD_WIDTH,
+                    FLOAT_PRECISION, loggp[p][PARAM_G], FIELD_WIDTH, 4,
+                    loggp[p][PARAM_BIG_G] * 1e3);
+        }
+        if (negative_latency) {
+            fprintf(stdout, "# L is left out where o_s + o_r exceed RTT/2:"
+                            " the overheads overlap the\n# latency on this"
+                            " pair and cannot be told apart from it\n");
+        }
+        fflush(stdout);
+    }
+
+    free(values);
+    free(values_sum);
+    free(x);
+    free(places);
+    free(nodes);
+    omb_mem_free(s_buf);
+    omb_mem_free(r_buf);
+    omb_mpi_finalize(omb_init_h);
+
+    return EXIT_SUCCESS;
+}
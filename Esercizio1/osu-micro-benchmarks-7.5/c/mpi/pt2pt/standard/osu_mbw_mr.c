@@ -40,7 +40,6 @@ int main(int argc, char *argv[])
 {
     char **s_buf, **r_buf;
     int numprocs, rank;
-    int itr = 0;
     int c, curr_size;
     set_header(HEADER);
     set_benchmark_name("osu_mbw_mr");
@@ -193,16 +192,8 @@ int main(int argc, char *argv[])
                     fprintf(stdout, "%*s", FIELD_WIDTH, "Validation");
                 }
                 if (options.omb_tail_lat) {
-                    itr = 0;
-                    while (itr < OMB_STAT_MAX_NUM &&
-                           -1 != options.omb_stat_percentiles[itr]) {
-                        if (BW == options.subtype) {
-                            fprintf(stdout, "%*sP%d Tail BW(MB/s)",
-                                    FIELD_WIDTH - strlen("Px Tail BW(MB/s)") -
-                                        (options.omb_stat_percentiles[itr] > 9),
-                                    "", options.omb_stat_percentiles[itr]);
-                        }
-                        itr++;
+                    if (BW == options.subtype) {
+                        omb_print_tail_header();
                     }
                 }
                 if (options.omb_enable_ddt) {
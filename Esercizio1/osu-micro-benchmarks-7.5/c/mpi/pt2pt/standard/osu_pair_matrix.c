@@ -0,0 +1,380 @@
+#define BENCHMARK "OSU MPI%s Pair Matrix Test"
+/*
+ * Copyright (c) 2002-2024 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * Latency and bandwidth between every pair of ranks (or a random sample of
+ * PAIRS pairs with -p) in a single job. Ranks are meant to be pinned one per
+ * core, e.g. mpirun --map-by core --bind-to core. Pairs are measured one at a
+ * time with the osu_latency ping-pong and the osu_bw window loops; the ranks
+ * that are not involved wait on a token without polling the network, so they
+ * do not perturb the pair under test.
+ */
+#include <osu_util_mpi.h>
+
+#define TOKEN_TAG      100
+#define PING_TAG       101
+#define ACK_TAG        102
+#define SAMPLE_SEED    12345
+
+/* Ping-pong between sender and receiver, returns the one-way latency in us */
+static double pair_latency(int myid, int sender, int receiver, char *s_buf,
+                           char *r_buf, int size, MPI_Comm comm)
+{
+    double t_start = 0.0;
+    int i;
+
+    for (i = 0; i < options.iterations + options.skip; i++) {
+        if (i == options.skip) {
+            t_start = MPI_Wtime();
+        }
+        if (myid == sender) {
+            MPI_CHECK(MPI_Send(s_buf, size, MPI_CHAR, receiver, PING_TAG, comm));
+            MPI_CHECK(MPI_Recv(r_buf, size, MPI_CHAR, receiver, PING_TAG, comm,
+                               MPI_STATUS_IGNORE));
+        } else {
+            MPI_CHECK(MPI_Recv(r_buf, size, MPI_CHAR, sender, PING_TAG, comm,
+                               MPI_STATUS_IGNORE));
+            MPI_CHECK(MPI_Send(s_buf, size, MPI_CHAR, sender, PING_TAG, comm));
+        }
+    }
+
+    return (MPI_Wtime() - t_start) * 1e6 / (2.0 * options.iterations);
+}
+
+/* Windows of non-blocking sends from sender to receiver, returns MB/s.
+ * Like osu_bw with a single buffer, every message of a window reuses it. */
+static double pair_bandwidth(int myid, int sender, int receiver, char *s_buf,
+                             char *r_buf, int size, MPI_Request *request,
+                             MPI_Comm comm)
+{
+    double t_start = 0.0;
+    int i, j;
+
+    for (i = 0; i < options.iterations + options.skip; i++) {
+        if (i == options.skip) {
+            t_start = MPI_Wtime();
+        }
+        if (myid == sender) {
+            for (j = 0; j < options.window_size; j++) {
+                MPI_CHECK(MPI_Isend(s_buf, size, MPI_CHAR,
+                                    receiver, PING_TAG, comm, request + j));
+            }
+            MPI_CHECK(MPI_Waitall(options.window_size, request,
+                                  MPI_STATUSES_IGNORE));
+            MPI_CHECK(MPI_Recv(r_buf, 4, MPI_CHAR, receiver, ACK_TAG, comm,
+                               MPI_STATUS_IGNORE));
+        } else {
+            for (j = 0; j < options.window_size; j++) {
+                MPI_CHECK(MPI_Irecv(r_buf, size, MPI_CHAR,
+                                    sender, PING_TAG, comm, request + j));
+            }
+            MPI_CHECK(MPI_Waitall(options.window_size, request,
+                                  MPI_STATUSES_IGNORE));
+            MPI_CHECK(MPI_Send(s_buf, 4, MPI_CHAR, sender, ACK_TAG, comm));
+        }
+    }
+
+    return size / 1e6 * options.iterations * options.window_size /
+           (MPI_Wtime() - t_start);
+}
+
+static void print_matrix(const char *title, const double *values,
+                         const int *measured, int numprocs, int nsizes,
+                         int size_index, int size)
+{
+    int i, j;
+
+    fprintf(stdout, "\n# %s, message size %d\n", title, size);
+    fprintf(stdout, "%-*s", 8, "# Rank");
+    for (j = 0; j < numprocs; j++) {
+        fprintf(stdout, "%*d", FIELD_WIDTH, j);
+    }
+    fprintf(stdout, "\n");
+
+    for (i = 0; i < numprocs; i++) {
+        fprintf(stdout, "%-*d", 8, i);
+        for (j = 0; j < numprocs; j++) {
+            int a = i < j ? i : j, b = i < j ? j : i;
+            size_t k = ((size_t)a * numprocs + b) * nsizes + size_index;
+
+            if (i != j && measured[(size_t)a * numprocs + b]) {
+                fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                        values[k]);
+            } else {
+                fprintf(stdout, "%*s", FIELD_WIDTH, "-");
+            }
+        }
+        fprintf(stdout, "\n");
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+    int myid, numprocs, i, p;
+    int size, nsizes = 0, size_index;
+    char *s_buf = NULL, *r_buf = NULL;
+    int po_ret = 0;
+    int npairs = 0, total_pairs;
+    int *pair_a = NULL, *pair_b = NULL, *measured = NULL;
+    double *lat = NULL, *bw = NULL, *lat_sum = NULL, *bw_sum = NULL;
+    struct omb_rank_place_t place, *places = NULL;
+    MPI_Request *request = NULL;
+    MPI_Request token;
+    double t_map;
+    MPI_Comm omb_comm = MPI_COMM_NULL;
+    omb_mpi_init_data omb_init_h;
+    options.bench = PT2PT;
+    options.subtype = PAIR_MAT;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_pair_matrix");
+
+    po_ret = process_options(argc, argv);
+
+    omb_init_h = omb_mpi_init(&argc, &argv);
+    omb_comm = omb_init_h.omb_comm;
+    if (MPI_COMM_NULL == omb_comm) {
+        OMB_ERROR_EXIT("Cant create communicator");
+    }
+    MPI_CHECK(MPI_Comm_rank(omb_comm, &myid));
+    MPI_CHECK(MPI_Comm_size(omb_comm, &numprocs));
+
+    if (0 == myid) {
+        switch (po_ret) {
+            case PO_BAD_USAGE:
+                print_bad_usage_message(myid);
+                break;
+            case PO_HELP_MESSAGE:
+                print_help_message(myid);
+                break;
+            case PO_VERSION_MESSAGE:
+                print_version_message(myid);
+                omb_mpi_finalize(omb_init_h);
+                exit(EXIT_SUCCESS);
+            default:
+                break;
+        }
+    }
+
+    switch (po_ret) {
+        case PO_OKAY:
+            break;
+        case PO_HELP_MESSAGE:
+        case PO_VERSION_MESSAGE:
+            omb_mpi_finalize(omb_init_h);
+            exit(EXIT_SUCCESS);
+        default:
+            omb_mpi_finalize(omb_init_h);
+            exit(EXIT_FAILURE);
+    }
+
+    if (numprocs < 2) {
+        if (myid == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+
+        omb_mpi_finalize(omb_init_h);
+        exit(EXIT_FAILURE);
+    }
+
+    /* Pairs a < b in rank order, or a random sample of them drawn by rank 0 */
+    total_pairs = numprocs * (numprocs - 1) / 2;
+    npairs = (options.pairs > 0 && options.pairs < total_pairs) ?
+                 options.pairs :
+                 total_pairs;
+    pair_a = malloc(total_pairs * sizeof(int));
+    pair_b = malloc(total_pairs * sizeof(int));
+    OMB_CHECK_NULL_AND_EXIT(pair_a, "Unable to allocate memory");
+    OMB_CHECK_NULL_AND_EXIT(pair_b, "Unable to allocate memory");
+
+    if (0 == myid) {
+        p = 0;
+        for (i = 0; i < numprocs; i++) {
+            int j;
+            for (j = i + 1; j < numprocs; j++) {
+                pair_a[p] = i;
+                pair_b[p] = j;
+                p++;
+            }
+        }
+        if (npairs < total_pairs) {
+            srand(SAMPLE_SEED);
+            for (p = 0; p < npairs; p++) {
+                int k = p + rand() % (total_pairs - p), tmp;
+                tmp = pair_a[p];
+                pair_a[p] = pair_a[k];
+                pair_a[k] = tmp;
+                tmp = pair_b[p];
+                pair_b[p] = pair_b[k];
+                pair_b[k] = tmp;
+            }
+        }
+    }
+    MPI_CHECK(MPI_Bcast(pair_a, npairs, MPI_INT, 0, omb_comm));
+    MPI_CHECK(MPI_Bcast(pair_b, npairs, MPI_INT, 0, omb_comm));
+
+    for (size = options.min_message_size; size <= options.max_message_size;
+         size = (size ? size * 2 : 1)) {
+        nsizes++;
+    }
+
+    /* Results are indexed by (a, b, size) and kept by rank a until the end */
+    lat = calloc((size_t)numprocs * numprocs * nsizes, sizeof(double));
+    bw = calloc((size_t)numprocs * numprocs * nsizes, sizeof(double));
+    measured = calloc((size_t)numprocs * numprocs, sizeof(int));
+    request = malloc(options.window_size * sizeof(MPI_Request));
+    OMB_CHECK_NULL_AND_EXIT(lat, "Unable to allocate memory");
+    OMB_CHECK_NULL_AND_EXIT(bw, "Unable to allocate memory");
+    OMB_CHECK_NULL_AND_EXIT(measured, "Unable to allocate memory");
+    OMB_CHECK_NULL_AND_EXIT(request, "Unable to allocate memory");
+
+    if (omb_mem_alloc((void **)&s_buf, sysconf(_SC_PAGESIZE),
+                      options.max_message_size + 4, OMB_MEM_SBUF) ||
+        omb_mem_alloc((void **)&r_buf, sysconf(_SC_PAGESIZE),
+                      options.max_message_size + 4, OMB_MEM_RBUF)) {
+        fprintf(stderr, "Error allocating host memory\n");
+        omb_mpi_finalize(omb_init_h);
+        exit(EXIT_FAILURE);
+    }
+    memset(s_buf, 'a', options.max_message_size + 4);
+    memset(r_buf, 'b', options.max_message_size + 4);
+
+    omb_get_rank_place(&place);
+    if (0 == myid) {
+        places = malloc(numprocs * sizeof(struct omb_rank_place_t));
+        OMB_CHECK_NULL_AND_EXIT(places, "Unable to allocate memory");
+    }
+    MPI_CHECK(MPI_Gather(&place, sizeof(place), MPI_BYTE, places, sizeof(place),
+                         MPI_BYTE, 0, omb_comm));
+
+    print_preamble(myid);
+    if (0 == myid) {
+        fprintf(stdout, "# %d of %d pairs, window %d, sizes %zu to %zu\n",
+                npairs, total_pairs, options.window_size,
+                options.min_message_size, options.max_message_size);
+        fprintf(stdout, "%-*s%*s%*s%*s%*s%*s\n", 8, "# Rank", 8, "CPU", 8,
+                "Core", 8, "Socket", 8, "NUMA", 8, "L3");
+        for (i = 0; i < numprocs; i++) {
+            fprintf(stdout, "%-*d%*d%*d%*d%*d%*d\n", 8, i, 8, places[i].cpu, 8,
+                    places[i].core, 8, places[i].socket, 8, places[i].numa, 8,
+                    places[i].l3);
+        }
+        fflush(stdout);
+    }
+
+    MPI_CHECK(MPI_Barrier(omb_comm));
+    t_map = MPI_Wtime();
+
+    /*
+     * One pair at a time: when pair p is done its rank a hands a token to the
+     * ranks of pair p + 1, which sleep until it arrives.
+     */
+    for (p = 0; p < npairs; p++) {
+        int a = pair_a[p], b = pair_b[p];
+
+        if (myid != a && myid != b) {
+            continue;
+        }
+
+        if (p > 0 && myid != pair_a[p - 1]) {
+            MPI_CHECK(MPI_Irecv(NULL, 0, MPI_CHAR, pair_a[p - 1], TOKEN_TAG,
+                                omb_comm, &token));
+            omb_quiet_wait(&token);
+        }
+
+        size_index = 0;
+        for (size = options.min_message_size;
+             size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+            size_t k = ((size_t)a * numprocs + b) * nsizes + size_index;
+            size_t iterations = options.iterations, skip = options.skip;
+            double latency, bandwidth;
+
+            if (size > LARGE_MESSAGE_SIZE) {
+                options.iterations = options.iterations_large;
+                options.skip = options.skip_large;
+            }
+
+            latency = pair_latency(myid, a, b, s_buf, r_buf, size, omb_comm);
+            bandwidth = pair_bandwidth(myid, a, b, s_buf, r_buf, size, request,
+                                       omb_comm);
+            if (myid == a) {
+                lat[k] = latency;
+                bw[k] = bandwidth;
+            }
+
+            options.iterations = iterations;
+            options.skip = skip;
+            size_index++;
+        }
+
+        if (myid == a) {
+            measured[(size_t)a * numprocs + b] = 1;
+            if (p + 1 < npairs) {
+                if (pair_a[p + 1] != a) {
+                    MPI_CHECK(MPI_Send(NULL, 0, MPI_CHAR, pair_a[p + 1],
+                                       TOKEN_TAG, omb_comm));
+                }
+                if (pair_b[p + 1] != a) {
+                    MPI_CHECK(MPI_Send(NULL, 0, MPI_CHAR, pair_b[p + 1],
+                                       TOKEN_TAG, omb_comm));
+                }
+            }
+        }
+    }
+
+    MPI_CHECK(MPI_Ibarrier(omb_comm, &token));
+    omb_quiet_wait(&token);
+    t_map = MPI_Wtime() - t_map;
+
+    /* Only rank a of every pair holds its results, so a sum collects them */
+    if (0 == myid) {
+        lat_sum = malloc((size_t)numprocs * numprocs * nsizes * sizeof(double));
+        bw_sum = malloc((size_t)numprocs * numprocs * nsizes * sizeof(double));
+        OMB_CHECK_NULL_AND_EXIT(lat_sum, "Unable to allocate memory");
+        OMB_CHECK_NULL_AND_EXIT(bw_sum, "Unable to allocate memory");
+    }
+    MPI_CHECK(MPI_Reduce(lat, lat_sum, numprocs * numprocs * nsizes,
+                         MPI_DOUBLE, MPI_SUM, 0, omb_comm));
+    MPI_CHECK(MPI_Reduce(bw, bw_sum, numprocs * numprocs * nsizes, MPI_DOUBLE,
+                         MPI_SUM, 0, omb_comm));
+    MPI_CHECK(MPI_Reduce(0 == myid ? MPI_IN_PLACE : measured, measured,
+                         numprocs * numprocs, MPI_INT, MPI_MAX, 0, omb_comm));
+
+    if (0 == myid) {
+        size_index = 0;
+        for (size = options.min_message_size;
+             size <= options.max_message_size; size = (size ? size * 2 : 1)) {
+            print_matrix("Latency (us)", lat_sum, measured, numprocs, nsizes,
+                         size_index, size);
+            print_matrix("Bandwidth (MB/s), lower rank sending", bw_sum,
+                         measured, numprocs, nsizes, size_index, size);
+            size_index++;
+        }
+        fprintf(stdout, "\n# Mapped %d pairs in %.2f s\n", npairs, t_map);
+        fflush(stdout);
+    }
+
+    free(pair_a);
+    free(pair_b);
+    free(lat);
+    free(bw);
+    free(lat_sum);
+    free(bw_sum);
+    free(measured);
+    free(places);
+    free(request);
+    omb_mem_free(s_buf);
+    omb_mem_free(r_buf);
+    omb_mpi_finalize(omb_init_h);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,662 @@
+#define BENCHMARK "OSU MPI%s Trace Replay Test"
+/*
+ * Copyright (c) 2002-2024 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * Replays a compact communication trace with the same MPI calls, so the
+ * pattern of an application can be timed without the application. Every
+ * line of the trace is one event of one rank:
+ *
+ *   RANK OP PEER|ROOT|- BYTES [GAP_US]
+ *
+ * where OP is send, recv, isend, irecv, waitall, barrier, bcast, reduce,
+ * allreduce, gather, scatter, allgather or alltoall, PEER is the partner
+ * of point to point operations, ROOT the root of rooted collectives and
+ * GAP_US the compute time spent by the rank before the operation. A line
+ * "phase NAME" starts a phase on all ranks; phases with the same name add
+ * up. Events before the first phase go to phase "main", "#" starts a
+ * comment. Every rank must list the same collectives in the same order,
+ * reductions work on MPI_FLOAT and requests still pending at the end of
+ * the trace are waited for there.
+ *
+ * The trace ranks must match the communicator size; -n maps trace rank i
+ * to another MPI rank, so placements can be compared on the same trace,
+ * and -g scales the compute gaps. For every phase the table gives the
+ * time per replay across ranks together with the average time spent in
+ * MPI calls and in compute gaps.
+ */
+#include <osu_util_mpi.h>
+
+#define REPLAY_TAG        100
+#define REPLAY_LINE_LEN   256
+#define REPLAY_NAME_LEN   32
+#define REPLAY_MAX_PHASES 64
+
+enum replay_op {
+    OP_PHASE,
+    OP_SEND,
+    OP_RECV,
+    OP_ISEND,
+    OP_IRECV,
+    OP_WAITALL,
+    OP_BARRIER,
+    OP_BCAST,
+    OP_REDUCE,
+    OP_ALLREDUCE,
+    OP_GATHER,
+    OP_SCATTER,
+    OP_ALLGATHER,
+    OP_ALLTOALL,
+    NUM_OPS
+};
+
+static const char *op_names[NUM_OPS] = {
+    "phase",     "send",      "recv",      "isend",     "irecv",
+    "waitall",   "barrier",   "bcast",     "reduce",    "allreduce",
+    "gather",    "scatter",   "allgather", "alltoall"};
+
+/* Per phase results of one rank, in us per replay */
+enum replay_stat { STAT_TIME, STAT_COMM, STAT_COMPUTE, NUM_STATS };
+
+struct replay_event {
+    enum replay_op op;
+    int peer; /* MPI rank of the peer or root, phase index for OP_PHASE */
+    size_t size;
+    double gap; /* seconds */
+};
+
+struct replay_trace {
+    struct replay_event *events;
+    int num_events;
+    int max_events;
+    int num_ranks;
+    int num_phases;
+    char phase_names[REPLAY_MAX_PHASES][REPLAY_NAME_LEN];
+    long phase_events[REPLAY_MAX_PHASES];
+    size_t sbuf_size;
+    size_t rbuf_size;
+    size_t ibuf_size;
+    int max_requests;
+};
+
+struct replay_state {
+    char *sbuf;
+    char *rbuf;
+    char *ibuf;
+    MPI_Request *requests;
+    int num_requests;
+    size_t ibuf_offset;
+};
+
+static void busy_wait(double delay)
+{
+    double t_start = MPI_Wtime();
+
+    while (MPI_Wtime() - t_start < delay) {
+    }
+}
+
+static int float_count(size_t size)
+{
+    return MAX(size / sizeof(float), 1);
+}
+
+/*
+ * remap[i] is the MPI rank replaying trace rank i. The map is either a
+ * comma separated list or a file with one rank per line.
+ */
+static int read_remap(const char *spec, int numprocs, int myid, int *remap)
+{
+    int i, rank, count = 0;
+    int *seen = NULL;
+    char list[OMB_REMAP_MAX_LEN];
+    char *token = NULL;
+    FILE *fp = NULL;
+
+    if ('\0' == spec[0]) {
+        for (i = 0; i < numprocs; i++) {
+            remap[i] = i;
+        }
+        return 0;
+    }
+    if (isdigit(spec[0])) {
+        strcpy(list, spec);
+        token = strtok(list, ",");
+        while (NULL != token && count < numprocs) {
+            remap[count++] = atoi(token);
+            token = strtok(NULL, ",");
+        }
+        if (NULL != token) {
+            count++;
+        }
+    } else {
+        fp = fopen(spec, "r");
+        if (NULL == fp) {
+            fprintf(stderr, "Rank %d cannot open rank map %s\n", myid,
+                    spec);
+            return -1;
+        }
+        while (1 == fscanf(fp, "%d", &rank)) {
+            if (count < numprocs) {
+                remap[count] = rank;
+            }
+            count++;
+        }
+        fclose(fp);
+    }
+    if (count != numprocs) {
+        if (0 == myid) {
+            fprintf(stderr, "The rank map lists %d ranks, expected %d\n",
+                    count, numprocs);
+        }
+        return -1;
+    }
+    seen = calloc(numprocs, sizeof(int));
+    OMB_CHECK_NULL_AND_EXIT(seen, "Unable to allocate memory");
+    for (i = 0; i < numprocs; i++) {
+        if (0 > remap[i] || numprocs <= remap[i] || seen[remap[i]]++) {
+            if (0 == myid) {
+                fprintf(stderr, "The rank map is not a permutation of"
+                                " 0..%d\n",
+                        numprocs - 1);
+            }
+            free(seen);
+            return -1;
+        }
+    }
+    free(seen);
+    return 0;
+}
+
+static void add_event(struct replay_trace *trace, enum replay_op op, int peer,
+                      size_t size, double gap)
+{
+    if (trace->num_events == trace->max_events) {
+        trace->max_events = MAX(2 * trace->max_events, 64);
+        trace->events = realloc(trace->events, trace->max_events *
+                                                   sizeof(struct replay_event));
+        OMB_CHECK_NULL_AND_EXIT(trace->events, "Unable to allocate memory");
+    }
+    trace->events[trace->num_events].op = op;
+    trace->events[trace->num_events].peer = peer;
+    trace->events[trace->num_events].size = size;
+    trace->events[trace->num_events].gap = gap;
+    trace->num_events++;
+}
+
+static int add_phase(struct replay_trace *trace, const char *name)
+{
+    int p;
+
+    for (p = 0; p < trace->num_phases; p++) {
+        if (0 == strcmp(trace->phase_names[p], name)) {
+            break;
+        }
+    }
+    if (p == trace->num_phases) {
+        if (REPLAY_MAX_PHASES == p) {
+            return -1;
+        }
+        strcpy(trace->phase_names[p], name);
+        trace->num_phases++;
+    }
+    add_event(trace, OP_PHASE, p, 0, 0);
+    return p;
+}
+
+/* Buffer space and requests the events of this rank need */
+static void account_event(struct replay_trace *trace, enum replay_op op,
+                          size_t size, int numprocs, int *pending,
+                          size_t *pending_bytes)
+{
+    size_t sbytes = 0, rbytes = 0;
+
+    switch (op) {
+        case OP_SEND:
+            sbytes = size;
+            break;
+        case OP_ISEND:
+            sbytes = size;
+            (*pending)++;
+            break;
+        case OP_RECV:
+        case OP_BCAST:
+            rbytes = size;
+            break;
+        case OP_IRECV:
+            *pending_bytes += size;
+            (*pending)++;
+            break;
+        case OP_WAITALL:
+            *pending = 0;
+            *pending_bytes = 0;
+            break;
+        case OP_REDUCE:
+        case OP_ALLREDUCE:
+            sbytes = rbytes = float_count(size) * sizeof(float);
+            break;
+        case OP_GATHER:
+        case OP_ALLGATHER:
+            sbytes = size;
+            rbytes = size * numprocs;
+            break;
+        case OP_SCATTER:
+            sbytes = size * numprocs;
+            rbytes = size;
+            break;
+        case OP_ALLTOALL:
+            sbytes = rbytes = size * numprocs;
+            break;
+        default:
+            break;
+    }
+    trace->sbuf_size = MAX(trace->sbuf_size, sbytes);
+    trace->rbuf_size = MAX(trace->rbuf_size, rbytes);
+    trace->ibuf_size = MAX(trace->ibuf_size, *pending_bytes);
+    trace->max_requests = MAX(trace->max_requests, *pending);
+}
+
+/*
+ * Every rank reads the whole trace and keeps its own events, with the
+ * peers already translated to MPI ranks, and the phase boundaries.
+ */
+static int read_trace(struct replay_trace *trace, const char *path,
+                      const int *remap, int numprocs, int myid)
+{
+    int i, line = 0, rank, peer, fields, me = 0, phase = -1, pending = 0;
+    size_t size, pending_bytes = 0;
+    double gap;
+    char buf[REPLAY_LINE_LEN], op_name[REPLAY_NAME_LEN];
+    char peer_name[REPLAY_NAME_LEN];
+    char *comment = NULL;
+    const char *error = NULL;
+    enum replay_op op;
+    FILE *fp = NULL;
+
+    for (i = 0; i < numprocs; i++) {
+        if (remap[i] == myid) {
+            me = i;
+        }
+    }
+    fp = fopen(path, "r");
+    if (NULL == fp) {
+        fprintf(stderr, "Rank %d cannot open trace %s\n", myid, path);
+        return -1;
+    }
+    while (NULL == error && NULL != fgets(buf, REPLAY_LINE_LEN, fp)) {
+        line++;
+        comment = strchr(buf, '#');
+        if (NULL != comment) {
+            *comment = '\0';
+        }
+        fields = sscanf(buf, "%31s %31s", op_name, peer_name);
+        if (0 >= fields) {
+            continue;
+        }
+        if (0 == strcmp(op_name, "phase")) {
+            if (2 != fields) {
+                error = "phase without a name";
+            } else if (0 > (phase = add_phase(trace, peer_name))) {
+                error = "too many phases";
+            }
+            continue;
+        }
+        gap = 0;
+        fields = sscanf(buf, "%d %31s %31s %zu %lf", &rank, op_name, peer_name,
+                        &size, &gap);
+        if (4 > fields) {
+            error = "expected RANK OP PEER|ROOT|- BYTES [GAP_US]";
+            break;
+        }
+        for (op = OP_SEND; op < NUM_OPS; op++) {
+            if (0 == strcmp(op_name, op_names[op])) {
+                break;
+            }
+        }
+        peer = ('-' == peer_name[0]) ? -1 : atoi(peer_name);
+        if (NUM_OPS == op) {
+            error = "unknown operation";
+        } else if (0 > rank || numprocs <= rank || numprocs <= peer) {
+            error = "rank beyond the job, run the trace on as many"
+                    " processes as it has ranks";
+        } else if (0 > gap || INT_MAX / numprocs < size) {
+            error = "size or gap out of range";
+        } else if (0 > peer && ((OP_SEND <= op && OP_IRECV >= op) ||
+                                OP_BCAST == op || OP_REDUCE == op ||
+                                OP_GATHER == op || OP_SCATTER == op)) {
+            error = "operation needs a peer or root";
+        }
+        if (NULL != error) {
+            break;
+        }
+        trace->num_ranks = MAX(trace->num_ranks, rank + 1);
+        if (0 > phase) {
+            phase = add_phase(trace, "main");
+        }
+        trace->phase_events[phase]++;
+        if (rank != me) {
+            continue;
+        }
+        add_event(trace, op, (0 > peer) ? -1 : remap[peer], size,
+                  gap * options.omb_gap_scale / 1e6);
+        account_event(trace, op, size, numprocs, &pending, &pending_bytes);
+    }
+    fclose(fp);
+    if (NULL != error) {
+        if (0 == myid) {
+            fprintf(stderr, "%s:%d: %s\n", path, line, error);
+        }
+        return -1;
+    }
+    if (trace->num_ranks != numprocs) {
+        if (0 == myid) {
+            fprintf(stderr, "The trace has %d ranks, the job %d\n",
+                    trace->num_ranks, numprocs);
+        }
+        return -1;
+    }
+    return 0;
+}
+
+static void wait_all(struct replay_state *state)
+{
+    MPI_CHECK(MPI_Waitall(state->num_requests, state->requests,
+                          MPI_STATUSES_IGNORE));
+    state->num_requests = 0;
+    state->ibuf_offset = 0;
+}
+
+static void run_event(const struct replay_event *event,
+                      struct replay_state *state, MPI_Comm comm)
+{
+    int count = event->size;
+    MPI_Request *request = &state->requests[state->num_requests];
+
+    switch (event->op) {
+        case OP_SEND:
+            MPI_CHECK(MPI_Send(state->sbuf, count, MPI_CHAR, event->peer,
+                               REPLAY_TAG, comm));
+            break;
+        case OP_RECV:
+            MPI_CHECK(MPI_Recv(state->rbuf, count, MPI_CHAR, event->peer,
+                               REPLAY_TAG, comm, MPI_STATUS_IGNORE));
+            break;
+        case OP_ISEND:
+            MPI_CHECK(MPI_Isend(state->sbuf, count, MPI_CHAR, event->peer,
+                                REPLAY_TAG, comm, request));
+            state->num_requests++;
+            break;
+        case OP_IRECV:
+            /* Outstanding receives get a slot each */
+            MPI_CHECK(MPI_Irecv(state->ibuf + state->ibuf_offset, count,
+                                MPI_CHAR, event->peer, REPLAY_TAG, comm,
+                                request));
+            state->ibuf_offset += event->size;
+            state->num_requests++;
+            break;
+        case OP_WAITALL:
+            wait_all(state);
+            break;
+        case OP_BARRIER:
+            MPI_CHECK(MPI_Barrier(comm));
+            break;
+        case OP_BCAST:
+            MPI_CHECK(MPI_Bcast(state->rbuf, count, MPI_CHAR, event->peer,
+                                comm));
+            break;
+        case OP_REDUCE:
+            MPI_CHECK(MPI_Reduce(state->sbuf, state->rbuf,
+                                 float_count(event->size), MPI_FLOAT, MPI_SUM,
+                                 event->peer, comm));
+            break;
+        case OP_ALLREDUCE:
+            MPI_CHECK(MPI_Allreduce(state->sbuf, state->rbuf,
+                                    float_count(event->size), MPI_FLOAT,
+                                    MPI_SUM, comm));
+            break;
+        case OP_GATHER:
+            MPI_CHECK(MPI_Gather(state->sbuf, count, MPI_CHAR, state->rbuf,
+                                 count, MPI_CHAR, event->peer, comm));
+            break;
+        case OP_SCATTER:
+            MPI_CHECK(MPI_Scatter(state->sbuf, count, MPI_CHAR, state->rbuf,
+                                  count, MPI_CHAR, event->peer, comm));
+            break;
+        case OP_ALLGATHER:
+            MPI_CHECK(MPI_Allgather(state->sbuf, count, MPI_CHAR, state->rbuf,
+                                    count, MPI_CHAR, comm));
+            break;
+        case OP_ALLTOALL:
+            MPI_CHECK(MPI_Alltoall(state->sbuf, count, MPI_CHAR, state->rbuf,
+                                   count, MPI_CHAR, comm));
+            break;
+        default:
+            break;
+    }
+}
+
+/* One replay of the trace, adding the time of every phase to stats */
+static void replay(const struct replay_trace *trace,
+                   struct replay_state *state, MPI_Comm comm,
+                   double stats[NUM_STATS][REPLAY_MAX_PHASES + 1])
+{
+    int i, phase = 0;
+    double t_phase = 0, t_start = 0;
+    const struct replay_event *event = NULL;
+
+    for (i = 0; i < trace->num_events; i++) {
+        event = &trace->events[i];
+        if (OP_PHASE == event->op) {
+            t_start = MPI_Wtime();
+            if (0 < i) {
+                stats[STAT_TIME][phase] += t_start - t_phase;
+            }
+            phase = event->peer;
+            t_phase = t_start;
+            continue;
+        }
+        if (0 < event->gap) {
+            t_start = MPI_Wtime();
+            busy_wait(event->gap);
+            stats[STAT_COMPUTE][phase] += MPI_Wtime() - t_start;
+        }
+        t_start = MPI_Wtime();
+        run_event(event, state, comm);
+        stats[STAT_COMM][phase] += MPI_Wtime() - t_start;
+    }
+    t_start = MPI_Wtime();
+    if (0 < state->num_requests) {
+        wait_all(state);
+        stats[STAT_COMM][phase] += MPI_Wtime() - t_start;
+    }
+    if (0 < trace->num_events) {
+        stats[STAT_TIME][phase] += MPI_Wtime() - t_phase;
+    }
+}
+
+static void print_phase(const char *name, long events, double avg, double min,
+                        double max, double comm, double compute)
+{
+    fprintf(stdout, "%-*s%*ld", 20, name, 10, events);
+    fprintf(stdout, "%*.*f%*.*f%*.*f", FIELD_WIDTH, FLOAT_PRECISION, avg,
+            FIELD_WIDTH, FLOAT_PRECISION, min, FIELD_WIDTH, FLOAT_PRECISION,
+            max);
+    fprintf(stdout, "%*.*f%*.*f\n", FIELD_WIDTH, FLOAT_PRECISION, comm,
+            FIELD_WIDTH, FLOAT_PRECISION, compute);
+}
+
+int main(int argc, char *argv[])
+{
+    int myid, numprocs, i, p, s, err = 0;
+    int po_ret = 0;
+    int *remap = NULL;
+    long total_events = 0;
+    double stats[NUM_STATS][REPLAY_MAX_PHASES + 1];
+    double time_min[REPLAY_MAX_PHASES + 1], time_max[REPLAY_MAX_PHASES + 1];
+    double sums[NUM_STATS][REPLAY_MAX_PHASES + 1];
+    struct replay_trace trace;
+    struct replay_state state;
+    MPI_Comm omb_comm = MPI_COMM_NULL;
+    omb_mpi_init_data omb_init_h;
+    options.bench = COLLECTIVE;
+    options.subtype = REPLAY;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_replay");
+
+    po_ret = process_options(argc, argv);
+
+    omb_init_h = omb_mpi_init(&argc, &argv);
+    omb_comm = omb_init_h.omb_comm;
+    if (MPI_COMM_NULL == omb_comm) {
+        OMB_ERROR_EXIT("Cant create communicator");
+    }
+    MPI_CHECK(MPI_Comm_rank(omb_comm, &myid));
+    MPI_CHECK(MPI_Comm_size(omb_comm, &numprocs));
+
+    if (0 == myid) {
+        switch (po_ret) {
+            case PO_BAD_USAGE:
+                print_bad_usage_message(myid);
+                break;
+            case PO_HELP_MESSAGE:
+                print_help_message(myid);
+                break;
+            case PO_VERSION_MESSAGE:
+                print_version_message(myid);
+                omb_mpi_finalize(omb_init_h);
+                exit(EXIT_SUCCESS);
+            default:
+                break;
+        }
+    }
+
+    switch (po_ret) {
+        case PO_OKAY:
+            break;
+        case PO_HELP_MESSAGE:
+        case PO_VERSION_MESSAGE:
+            omb_mpi_finalize(omb_init_h);
+            exit(EXIT_SUCCESS);
+        default:
+            omb_mpi_finalize(omb_init_h);
+            exit(EXIT_FAILURE);
+    }
+
+    if ('\0' == options.omb_trace_path[0]) {
+        if (0 == myid) {
+            fprintf(stderr, "This test requires a trace, pass it with -F\n");
+        }
+
+        omb_mpi_finalize(omb_init_h);
+        exit(EXIT_FAILURE);
+    }
+
+    memset(&trace, 0, sizeof(trace));
+    memset(&state, 0, sizeof(state));
+    remap = malloc(numprocs * sizeof(int));
+    OMB_CHECK_NULL_AND_EXIT(remap, "Unable to allocate memory");
+    err = read_remap(options.omb_remap, numprocs, myid, remap);
+    if (0 == err) {
+        err = read_trace(&trace, options.omb_trace_path, remap, numprocs,
+                         myid);
+    }
+    /* A rank that cannot read its files must not leave the others hanging */
+    MPI_CHECK(MPI_Allreduce(MPI_IN_PLACE, &err, 1, MPI_INT, MPI_MIN,
+                            omb_comm));
+    if (0 != err) {
+        omb_mpi_finalize(omb_init_h);
+        exit(EXIT_FAILURE);
+    }
+
+    if (allocate_memory_coll((void **)&state.sbuf, MAX(trace.sbuf_size, 1),
+                             options.accel) ||
+        allocate_memory_coll((void **)&state.rbuf, MAX(trace.rbuf_size, 1),
+                             options.accel) ||
+        allocate_memory_coll((void **)&state.ibuf, MAX(trace.ibuf_size, 1),
+                             options.accel)) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", myid);
+        MPI_CHECK(MPI_Abort(omb_comm, EXIT_FAILURE));
+    }
+    /* Zeroed floats keep the reductions off denormals */
+    set_buffer(state.sbuf, options.accel, 0, MAX(trace.sbuf_size, 1));
+    set_buffer(state.rbuf, options.accel, 0, MAX(trace.rbuf_size, 1));
+    set_buffer(state.ibuf, options.accel, 0, MAX(trace.ibuf_size, 1));
+    state.requests = malloc(MAX(trace.max_requests, 1) * sizeof(MPI_Request));
+    OMB_CHECK_NULL_AND_EXIT(state.requests, "Unable to allocate memory");
+
+    for (p = 0; p < trace.num_phases; p++) {
+        total_events += trace.phase_events[p];
+    }
+    print_preamble(myid);
+    if (0 == myid) {
+        fprintf(stdout, "# Trace %s: %d ranks, %ld events, %d phases\n",
+                options.omb_trace_path, trace.num_ranks, total_events,
+                trace.num_phases);
+        fprintf(stdout, "# Compute gaps scaled by %.2f", options.omb_gap_scale);
+        if ('\0' != options.omb_remap[0]) {
+            fprintf(stdout, ", rank map %s", options.omb_remap);
+        }
+        fprintf(stdout, "\n# Times per replay, %zu replays\n",
+                options.iterations);
+        fprintf(stdout, "%-*s%*s", 20, "# Phase", 10, "Events");
+        fprintf(stdout, "%*s%*s%*s", FIELD_WIDTH, "Avg Time(us)", FIELD_WIDTH,
+                "Min Time(us)", FIELD_WIDTH, "Max Time(us)");
+        fprintf(stdout, "%*s%*s\n", FIELD_WIDTH, "Avg Comm(us)", FIELD_WIDTH,
+                "Avg Compute(us)");
+        fflush(stdout);
+    }
+
+    for (i = 0; i < options.skip + options.iterations; i++) {
+        if (i == options.skip) {
+            memset(stats, 0, sizeof(stats));
+        }
+        MPI_CHECK(MPI_Barrier(omb_comm));
+        replay(&trace, &state, omb_comm, stats);
+    }
+
+    /* The last column holds the whole trace */
+    for (s = 0; s < NUM_STATS; s++) {
+        stats[s][trace.num_phases] = 0;
+        for (p = 0; p < trace.num_phases; p++) {
+            stats[s][p] *= 1e6 / options.iterations;
+            stats[s][trace.num_phases] += stats[s][p];
+        }
+        MPI_CHECK(MPI_Reduce(stats[s], sums[s], trace.num_phases + 1,
+                             MPI_DOUBLE, MPI_SUM, 0, omb_comm));
+    }
+    MPI_CHECK(MPI_Reduce(stats[STAT_TIME], time_min, trace.num_phases + 1,
+                         MPI_DOUBLE, MPI_MIN, 0, omb_comm));
+    MPI_CHECK(MPI_Reduce(stats[STAT_TIME], time_max, trace.num_phases + 1,
+                         MPI_DOUBLE, MPI_MAX, 0, omb_comm));
+
+    if (0 == myid) {
+        for (p = 0; p <= trace.num_phases; p++) {
+            print_phase((p < trace.num_phases) ? trace.phase_names[p] : "total",
+                        (p < trace.num_phases) ? trace.phase_events[p] :
+                                                 total_events,
+                        sums[STAT_TIME][p] / numprocs, time_min[p], time_max[p],
+                        sums[STAT_COMM][p] / numprocs,
+                        sums[STAT_COMPUTE][p] / numprocs);
+        }
+        fflush(stdout);
+    }
+
+    free_buffer(state.sbuf, options.accel);
+    free_buffer(state.rbuf, options.accel);
+    free_buffer(state.ibuf, options.accel);
+    free(state.requests);
+    free(trace.events);
+    free(remap);
+
+    omb_mpi_finalize(omb_init_h);
+
+    return EXIT_SUCCESS;
+}
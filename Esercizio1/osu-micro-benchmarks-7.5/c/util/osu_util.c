@@ -23,10 +23,31 @@ struct options_t options = {0};
 
 struct bad_usage_t bad_usage;
 
-void print_header(int rank, int full)
+/*
+ * One column per requested percentile, e.g. P99 Tail Lat(us). Labels that
+ * would fill the whole column, like P99.9, drop the word Tail.
+ */
+void omb_print_tail_header()
 {
+    char label[OMB_DATATYPE_STR_MAX_LEN];
+    const char *metric = (BW == options.subtype) ? "BW(MB/s)" : "Lat(us)";
     int itr = 0;
 
+    while (itr < OMB_STAT_MAX_NUM && -1 != options.omb_stat_percentiles[itr]) {
+        snprintf(label, sizeof(label), "P%g Tail %s",
+                 options.omb_stat_percentiles[itr], metric);
+        if (FIELD_WIDTH <= strlen(label)) {
+            snprintf(label, sizeof(label), "P%g %s",
+                     options.omb_stat_percentiles[itr], metric);
+        }
+        fprintf(stdout, "%*s", FIELD_WIDTH, label);
+        itr++;
+    }
+}
+
+void print_header(int rank, int full)
+{
+
     switch (options.bench) {
         case MBW_MR:
         case PT2PT:
@@ -71,28 +92,7 @@ void print_header(int rank, int full)
                             fprintf(stdout, "%*s", FIELD_WIDTH, "Validation");
                         }
                         if (options.omb_tail_lat) {
-                            itr = 0;
-                            while (itr < OMB_STAT_MAX_NUM &&
-                                   -1 != options.omb_stat_percentiles[itr]) {
-                                if (BW == options.subtype) {
-                                    fprintf(
-                                        stdout, "%*sP%d Tail BW(MB/s)",
-                                        FIELD_WIDTH -
-                                            strlen("Px Tail BW(MB/s)") -
-                                            (options.omb_stat_percentiles[itr] >
-                                             9),
-                                        "", options.omb_stat_percentiles[itr]);
-                                } else {
-                                    fprintf(
-                                        stdout, "%*sP%d Tail Lat(us)",
-                                        FIELD_WIDTH -
-                                            strlen("Px Tail Lat(us)") -
-                                            (options.omb_stat_percentiles[itr] >
-                                             9),
-                                        "", options.omb_stat_percentiles[itr]);
-                                }
-                                itr++;
-                            }
+                            omb_print_tail_header();
                         }
                         if (options.omb_enable_ddt &&
                             !(options.subtype == BW &&
@@ -159,6 +159,96 @@ void print_data(int rank, int full, int size, double avg_time, double min_time,
     }
 }
 
+/*
+ * Options that only some of the benchmarks sharing an optstring implement:
+ * they are kept for the benchmarks listed, and for every collective
+ * benchmark if collectives is set. Elsewhere they are dropped from the
+ * optstring, so that getopt rejects them and the help leaves them out.
+ */
+static const struct {
+    char opt;
+    int collectives;
+    const char *benchmarks[OMB_OPT_MAX_OWNERS];
+} omb_opt_owners[] = {{'B', 0, {"osu_latency", "osu_bw"}},
+                      {'C', 1, {"osu_latency", "osu_bw"}},
+                      {'U', 0,
+                       {"osu_bcast", "osu_scatter", "osu_gather",
+                        "osu_allreduce", "osu_alltoall"}}};
+
+static const char *omb_drop_options(const char *optstring)
+{
+    /* Outlives process_options, getopt and the help read the optstring */
+    static char buf[OMB_OPTSTRING_MAX_LEN];
+    size_t itr = 0, owner = 0, len = 0;
+    int keep = 0, dropped = 0;
+    const char *opt = NULL;
+
+    if (strlen(optstring) >= sizeof(buf)) {
+        OMB_ERROR_EXIT("Option string too long");
+    }
+    for (opt = optstring; '\0' != *opt; opt++) {
+        keep = 1;
+        for (itr = 0; itr < sizeof(omb_opt_owners) / sizeof(omb_opt_owners[0]);
+             itr++) {
+            if (!isalpha(*opt) || omb_opt_owners[itr].opt != *opt) {
+                continue;
+            }
+            keep = omb_opt_owners[itr].collectives &&
+                   COLLECTIVE == options.bench;
+            for (owner = 0; owner < OMB_OPT_MAX_OWNERS && !keep &&
+                            NULL != omb_opt_owners[itr].benchmarks[owner] &&
+                            NULL != benchmark_name;
+                 owner++) {
+                keep = (0 == strcmp(omb_opt_owners[itr].benchmarks[owner],
+                                    benchmark_name));
+            }
+        }
+        if (keep) {
+            buf[len++] = *opt;
+            continue;
+        }
+        while (':' == opt[1]) {
+            opt++;
+        }
+        dropped = 1;
+    }
+    buf[len] = '\0';
+    if (!dropped) {
+        return optstring;
+    }
+    return buf;
+}
+
+/* Reference algorithms each benchmark can run instead of the MPI call */
+static enum omb_ref_algo_t omb_ref_algo_lookup(const char *name)
+{
+    static const struct {
+        enum test_subtype subtype;
+        enum omb_ref_algo_t algo;
+    } available[] = {{BCAST, OMB_REF_BINOMIAL},
+                     {BCAST, OMB_REF_CHAIN},
+                     {BCAST, OMB_REF_SPLIT_BINARY},
+                     {SCATTER, OMB_REF_BINOMIAL},
+                     {SCATTER, OMB_REF_LINEAR},
+                     {GATHER, OMB_REF_BINOMIAL},
+                     {GATHER, OMB_REF_LINEAR},
+                     {ALL_REDUCE, OMB_REF_RING},
+                     {ALL_REDUCE, OMB_REF_RECURSIVE_DOUBLING},
+                     {ALL_REDUCE, OMB_REF_RABENSEIFNER},
+                     {ALLTOALL, OMB_REF_BRUCK},
+                     {ALLTOALL, OMB_REF_PAIRWISE}};
+    static const char *names[] = OMB_REF_ALGO_NAMES;
+    size_t itr = 0;
+
+    for (itr = 0; itr < sizeof(available) / sizeof(available[0]); itr++) {
+        if (available[itr].subtype == options.subtype &&
+            0 == strcmp(names[available[itr].algo], name)) {
+            return available[itr].algo;
+        }
+    }
+    return OMB_REF_NONE;
+}
+
 static int set_min_message_size(long long value)
 {
     if (0 >= value) {
@@ -445,6 +535,10 @@ int process_options(int argc, char *argv[])
     char *validation_log_option = NULL;
     char *root_rank_type = NULL;
     char *strtok_parsed = NULL;
+    char *comm_place = NULL;
+    char *mem_nodes = NULL;
+    char *ref_segsize = NULL;
+    int mem_node = 0;
     static struct option long_options[OMB_LONG_OPTIONS_ARRAY_SIZE];
 
     enable_accel_support();
@@ -468,6 +562,12 @@ int process_options(int argc, char *argv[])
             case CONG_BW:
                 OMBOP_OPTSTR_BLK(PT2PT, CONG_BW);
                 break;
+            case PAIR_MAT:
+                OMBOP_OPTSTR_BLK(PT2PT, PAIR_MAT);
+                break;
+            case LOGGP:
+                OMBOP_OPTSTR_BLK(PT2PT, LOGGP);
+                break;
             default:
                 OMB_ERROR_EXIT("Unknown subtype");
                 break;
@@ -570,6 +670,12 @@ int process_options(int argc, char *argv[])
             case NBC_NHBR_GATHER:
                 OMBOP_OPTSTR_CUDA_BLK(COLLECTIVE, NBC_NHBR_GATHER);
                 break;
+            case REPLAY:
+                OMBOP_OPTSTR_BLK(COLLECTIVE, REPLAY);
+                break;
+            case TUNE:
+                OMBOP_OPTSTR_BLK(COLLECTIVE, TUNE);
+                break;
             default:
                 OMB_ERROR_EXIT("Unknown subtype");
                 break;
@@ -607,6 +713,7 @@ int process_options(int argc, char *argv[])
     } else {
         OMB_ERROR_EXIT("Unknown benchmark");
     }
+    options.optstring = omb_drop_options(options.optstring);
     omb_process_long_options(long_options, options.optstring);
     /* Set default options*/
     options.accel = NONE;
@@ -650,6 +757,26 @@ int process_options(int argc, char *argv[])
     options.omb_root_rank = 0;
     options.omb_tail_lat = 0;
     options.num_partitions = DEFAULT_NUM_PARTITIONS;
+    options.omb_algo_list[0] = '\0';
+    options.omb_num_comm_sizes = 0;
+    options.omb_comm_place = OMB_COMM_PLACE_FIRST;
+    options.omb_sync_start = 0;
+    options.omb_sync_window = 0;
+    options.omb_adaptive = 0;
+    options.omb_adaptive_threshold = OMB_ADAPTIVE_DEFAULT_THRESHOLD;
+    options.omb_cold_cache = 0;
+    options.omb_cold_cache_mb = 0;
+    options.omb_mem_kind = OMB_MEM_DEFAULT;
+    options.omb_mem_node[0] = OMB_MEM_NODE_ANY;
+    options.omb_mem_node[1] = OMB_MEM_NODE_ANY;
+    options.omb_trace_path[0] = '\0';
+    options.omb_gap_scale = 1.0;
+    options.omb_remap[0] = '\0';
+    strcpy(options.omb_tune_colls, "bcast,allreduce");
+    strcpy(options.omb_tune_segsizes, "0,8192,65536");
+    strcpy(options.omb_tune_output, "osu_tune");
+    options.omb_ref_algo = OMB_REF_NONE;
+    options.omb_ref_segsize = OMB_REF_SEGSIZE_AUTO;
     for (itr = 0; itr < OMB_STAT_MAX_NUM; itr++) {
         options.omb_stat_percentiles[itr] = -1;
     }
@@ -663,6 +790,30 @@ int process_options(int argc, char *argv[])
             options.skip_large = BW_SKIP_LARGE;
             options.warmup_validation = VALIDATION_SKIP_DEFAULT;
             break;
+        case PAIR_MAT:
+            options.iterations = BW_LOOP_SMALL;
+            options.skip = BW_SKIP_SMALL;
+            options.iterations_large = BW_LOOP_LARGE;
+            options.skip_large = BW_SKIP_LARGE;
+            options.max_message_size = PAIR_MAT_MAX_MESSAGE_SIZE;
+            options.pairs = 0;
+            break;
+        case LOGGP:
+            options.iterations = LOGGP_LOOP_SMALL;
+            options.skip = LOGGP_SKIP_SMALL;
+            options.iterations_large = LOGGP_LOOP_LARGE;
+            options.skip_large = LOGGP_SKIP_LARGE;
+            options.window_size = LOGGP_BURST_SIZE;
+            options.max_message_size = LOGGP_MAX_MESSAGE_SIZE;
+            break;
+        case REPLAY:
+            options.iterations = REPLAY_LOOP;
+            options.skip = REPLAY_SKIP;
+            break;
+        case TUNE:
+            options.iterations = TUNE_LOOP;
+            options.skip = TUNE_SKIP;
+            break;
         case LAT_MT:
             options.num_threads = DEF_NUM_THREADS;
             options.min_message_size = 0;
@@ -837,12 +988,14 @@ int process_options(int argc, char *argv[])
                     options.omb_stat_percentiles[0] = 50;
                     options.omb_stat_percentiles[1] = 90;
                     options.omb_stat_percentiles[2] = 99;
+                    options.omb_stat_percentiles[3] = 99.9;
+                    options.omb_stat_percentiles[4] = 100;
                     break;
                 }
                 strtok_parsed = strtok(optarg, ",");
                 itr = 0;
-                while (NULL != strtok_parsed) {
-                    options.omb_stat_percentiles[itr] = atoi(strtok_parsed);
+                while (NULL != strtok_parsed && itr < OMB_STAT_MAX_NUM) {
+                    options.omb_stat_percentiles[itr] = atof(strtok_parsed);
                     if (options.omb_stat_percentiles[itr] < 0 ||
                         options.omb_stat_percentiles[itr] > 100) {
                         bad_usage.message =
@@ -1130,6 +1283,216 @@ int process_options(int argc, char *argv[])
             case 'l':
                 options.omb_enable_mpi_in_place = 1;
                 break;
+            case 'A':
+                if (OMB_ALGO_LIST_MAX_LEN <= strlen(optarg)) {
+                    bad_usage.message = "Algorithm list exceeds maximum length"
+                                        " allowed";
+                    bad_usage.optarg = optarg;
+                    return PO_BAD_USAGE;
+                }
+                strcpy(options.omb_algo_list, optarg);
+                break;
+            case 'S':
+                comm_place = strchr(optarg, ':');
+                if (NULL != comm_place) {
+                    *comm_place++ = '\0';
+                    if (0 == strcmp(comm_place, "socket")) {
+                        options.omb_comm_place = OMB_COMM_PLACE_SOCKET;
+                    } else if (0 == strcmp(comm_place, "ccx")) {
+                        options.omb_comm_place = OMB_COMM_PLACE_CCX;
+                    } else if (0 != strcmp(comm_place, "first")) {
+                        bad_usage.message = "Please pass a placement policy"
+                                            " [first, socket, ccx]";
+                        bad_usage.optarg = comm_place;
+                        return PO_BAD_USAGE;
+                    }
+                }
+                options.omb_num_comm_sizes = 0;
+                strtok_parsed = strtok(optarg, ",");
+                while (NULL != strtok_parsed) {
+                    if (OMB_MAX_COMM_SIZES == options.omb_num_comm_sizes) {
+                        bad_usage.message = "Too many communicator sizes";
+                        bad_usage.optarg = optarg;
+                        return PO_BAD_USAGE;
+                    }
+                    if (2 > atoi(strtok_parsed)) {
+                        bad_usage.message =
+                            "Communicator sizes must be at least 2";
+                        bad_usage.optarg = strtok_parsed;
+                        return PO_BAD_USAGE;
+                    }
+                    options.omb_comm_sizes[options.omb_num_comm_sizes++] =
+                        atoi(strtok_parsed);
+                    strtok_parsed = strtok(NULL, ",");
+                }
+                break;
+            case 'y':
+                options.omb_sync_start = 1;
+                if (NULL == optarg) {
+                    break;
+                }
+                options.omb_sync_window = atof(optarg);
+                if (0 >= options.omb_sync_window) {
+                    bad_usage.message = "Synchronized start window must be"
+                                        " a positive number of us";
+                    bad_usage.optarg = optarg;
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'B':
+                options.omb_adaptive = 1;
+                if (NULL == optarg) {
+                    break;
+                }
+                options.omb_adaptive_threshold = atof(optarg);
+                if (0 >= options.omb_adaptive_threshold) {
+                    bad_usage.message = "Switch point threshold must be a"
+                                        " positive percentage";
+                    bad_usage.optarg = optarg;
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'C':
+                options.omb_cold_cache = 1;
+                if (NULL == optarg) {
+                    break;
+                }
+                options.omb_cold_cache_mb = atoi(optarg);
+                if (0 >= options.omb_cold_cache_mb) {
+                    bad_usage.message = "Cold cache pool must be a positive"
+                                        " number of MB";
+                    bad_usage.optarg = optarg;
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'M':
+                mem_nodes = strchr(optarg, ':');
+                if (NULL != mem_nodes) {
+                    *mem_nodes++ = '\0';
+                }
+                if (0 == strcmp(optarg, "host")) {
+                    options.omb_mem_kind = OMB_MEM_HOST;
+                } else if (0 == strcmp(optarg, "thp")) {
+                    options.omb_mem_kind = OMB_MEM_THP;
+                } else if (0 == strcmp(optarg, "huge")) {
+                    options.omb_mem_kind = OMB_MEM_HUGE;
+                } else if (0 == strcmp(optarg, "shm")) {
+                    options.omb_mem_kind = OMB_MEM_SHM;
+                } else {
+                    bad_usage.message = "Please pass a memory kind"
+                                        " [host, thp, huge, shm]";
+                    bad_usage.optarg = optarg;
+                    return PO_BAD_USAGE;
+                }
+                if (NULL == mem_nodes) {
+                    break;
+                }
+                itr = 0;
+                strtok_parsed = strtok(mem_nodes, ",");
+                while (NULL != strtok_parsed) {
+                    if (OMB_MEM_NUM_NODE_ARGS == itr) {
+                        bad_usage.message = "Please pass at most a send and"
+                                            " a receive NUMA node";
+                        bad_usage.optarg = mem_nodes;
+                        return PO_BAD_USAGE;
+                    }
+                    if (0 == strcmp(strtok_parsed, "local")) {
+                        mem_node = OMB_MEM_NODE_LOCAL;
+                    } else if ('\0' != strtok_parsed[0] &&
+                               '\0' == strtok_parsed[strspn(strtok_parsed,
+                                                            "0123456789")]) {
+                        mem_node = atoi(strtok_parsed);
+                    } else {
+                        bad_usage.message = "NUMA nodes must be a node number"
+                                            " or local";
+                        bad_usage.optarg = strtok_parsed;
+                        return PO_BAD_USAGE;
+                    }
+                    options.omb_mem_node[itr++] = mem_node;
+                    strtok_parsed = strtok(NULL, ",");
+                }
+                /* A single node applies to both buffers */
+                if (1 == itr) {
+                    options.omb_mem_node[1] = options.omb_mem_node[0];
+                }
+                break;
+            case 'F':
+                if (OMB_FILE_PATH_MAX_LENGTH <= strlen(optarg)) {
+                    bad_usage.message = "Filepath exceeds maximum length"
+                                        " allowed";
+                    bad_usage.optarg = optarg;
+                    return PO_BAD_USAGE;
+                }
+                strcpy(options.omb_trace_path, optarg);
+                break;
+            case 'g':
+                options.omb_gap_scale = atof(optarg);
+                if (0 > options.omb_gap_scale) {
+                    bad_usage.message = "Compute gap scale must not be"
+                                        " negative";
+                    bad_usage.optarg = optarg;
+                    return PO_BAD_USAGE;
+                }
+                break;
+            case 'n':
+                if (OMB_REMAP_MAX_LEN <= strlen(optarg)) {
+                    bad_usage.message = "Rank map exceeds maximum length"
+                                        " allowed";
+                    bad_usage.optarg = optarg;
+                    return PO_BAD_USAGE;
+                }
+                strcpy(options.omb_remap, optarg);
+                break;
+            case 'e':
+                if (OMB_ALGO_LIST_MAX_LEN <= strlen(optarg)) {
+                    bad_usage.message = "Collective list exceeds maximum"
+                                        " length allowed";
+                    bad_usage.optarg = optarg;
+                    return PO_BAD_USAGE;
+                }
+                strcpy(options.omb_tune_colls, optarg);
+                break;
+            case 'E':
+                if (OMB_ALGO_LIST_MAX_LEN <= strlen(optarg) ||
+                    '\0' != optarg[strspn(optarg, "0123456789,")]) {
+                    bad_usage.message = "Please pass segment sizes in bytes,"
+                                        " separated by commas";
+                    bad_usage.optarg = optarg;
+                    return PO_BAD_USAGE;
+                }
+                strcpy(options.omb_tune_segsizes, optarg);
+                break;
+            case 'O':
+                if (OMB_FILE_PATH_MAX_LENGTH - 8 <= strlen(optarg)) {
+                    bad_usage.message = "Filepath exceeds maximum length"
+                                        " allowed";
+                    bad_usage.optarg = optarg;
+                    return PO_BAD_USAGE;
+                }
+                strcpy(options.omb_tune_output, optarg);
+                break;
+            case 'U':
+                ref_segsize = strchr(optarg, ':');
+                if (NULL != ref_segsize) {
+                    *ref_segsize++ = '\0';
+                    if ('\0' == ref_segsize[0] ||
+                        '\0' != ref_segsize[strspn(ref_segsize,
+                                                   "0123456789")]) {
+                        bad_usage.message = "Please pass the segment size in"
+                                            " bytes";
+                        bad_usage.optarg = ref_segsize;
+                        return PO_BAD_USAGE;
+                    }
+                    options.omb_ref_segsize = atoi(ref_segsize);
+                }
+                options.omb_ref_algo = omb_ref_algo_lookup(optarg);
+                if (OMB_REF_NONE == options.omb_ref_algo) {
+                    bad_usage.message = "Unknown reference algorithm for this"
+                                        " benchmark";
+                    bad_usage.optarg = optarg;
+                    return PO_BAD_USAGE;
+                }
+                break;
             case 'k':
                 root_rank_type = strtok(optarg, ":");
                 if (NULL == root_rank_type) {
@@ -1252,6 +1615,13 @@ int process_options(int argc, char *argv[])
         }
     }
 
+    if (OMB_REF_NONE != options.omb_ref_algo && NONE != options.accel) {
+        bad_usage.message = "Reference collectives need host buffers";
+        bad_usage.opt = 'U';
+        bad_usage.optarg = NULL;
+        return PO_BAD_USAGE;
+    }
+
     return PO_OKAY;
 }
 
@@ -167,12 +167,15 @@ void print_data(int rank, int full, int size, double avg_time, double min_time,
                 double max_time, int iterations) __attribute__((unused));
 void print_data_nbc(int rank, int full, int size, double ovrl, double cpu,
                     double comm, double wait, double init, int iterations);
+void omb_print_tail_header();
 
 void allocate_host_arrays();
 
 enum mpi_req { MAX_REQ_NUM = 1000 };
 
-#define OMB_LONG_OPTIONS_ARRAY_SIZE     30
+#define OMB_LONG_OPTIONS_ARRAY_SIZE     43
+#define OMB_OPT_MAX_OWNERS              8
+#define OMB_OPTSTRING_MAX_LEN           128
 #define BW_LOOP_SMALL                   100
 #define BW_SKIP_SMALL                   10
 #define BW_LOOP_LARGE                   20
@@ -181,6 +184,17 @@ enum mpi_req { MAX_REQ_NUM = 1000 };
 #define LAT_SKIP_SMALL                  100
 #define LAT_LOOP_LARGE                  1000
 #define LAT_SKIP_LARGE                  10
+#define PAIR_MAT_MAX_MESSAGE_SIZE       (1 << 16)
+#define LOGGP_LOOP_SMALL                1000
+#define LOGGP_SKIP_SMALL                100
+#define LOGGP_LOOP_LARGE                100
+#define LOGGP_SKIP_LARGE                10
+#define LOGGP_BURST_SIZE                16
+#define LOGGP_MAX_MESSAGE_SIZE          (1 << 20)
+#define REPLAY_LOOP                     10
+#define REPLAY_SKIP                     2
+#define TUNE_LOOP                       20
+#define TUNE_SKIP                       5
 #define COLL_LOOP_SMALL                 1000
 #define COLL_SKIP_SMALL                 100
 #define COLL_LOOP_LARGE                 100
@@ -217,6 +231,13 @@ enum mpi_req { MAX_REQ_NUM = 1000 };
 #define OMB_ROOT_ROTATE_VAL             -1
 #define OMB_STAT_MAX_NUM                5
 #define DEFAULT_NUM_PARTITIONS          8
+#define OMB_ALGO_LIST_MAX_LEN           256
+#define OMB_REMAP_MAX_LEN               1024
+#define OMB_MAX_COMM_SIZES              64
+#define OMB_ADAPTIVE_DEFAULT_THRESHOLD  15
+#define OMB_MEM_NODE_ANY                -1
+#define OMB_MEM_NODE_LOCAL              -2
+#define OMB_MEM_NUM_NODE_ARGS           2
 enum po_ret_type {
     PO_CUDA_NOT_AVAIL,
     PO_OPENACC_NOT_AVAIL,
@@ -279,7 +300,11 @@ enum test_subtype {
     REDUCE_P,
     ALL_REDUCE_P,
     BCAST_P,
-    CONG_BW
+    CONG_BW,
+    PAIR_MAT,
+    LOGGP,
+    REPLAY,
+    TUNE
 };
 
 enum test_synctype { ALL_SYNC, ACTIVE_SYNC };
@@ -332,6 +357,43 @@ extern char const *sync_info[20];
 
 enum omb_dtypes_t { OMB_DTYPE_NULL, OMB_CHAR, OMB_INT, OMB_FLOAT };
 
+/*communicator size sweep placement*/
+enum omb_comm_place_t {
+    OMB_COMM_PLACE_FIRST,
+    OMB_COMM_PLACE_SOCKET,
+    OMB_COMM_PLACE_CCX
+};
+
+/*buffer memory kinds, OMB_MEM_DEFAULT keeps the usual aligned allocation*/
+enum omb_mem_kind_t {
+    OMB_MEM_DEFAULT,
+    OMB_MEM_HOST,
+    OMB_MEM_THP,
+    OMB_MEM_HUGE,
+    OMB_MEM_SHM
+};
+
+/*user-level reference collectives, OMB_REF_NONE calls the MPI library*/
+enum omb_ref_algo_t {
+    OMB_REF_NONE,
+    OMB_REF_BINOMIAL,
+    OMB_REF_CHAIN,
+    OMB_REF_SPLIT_BINARY,
+    OMB_REF_LINEAR,
+    OMB_REF_RING,
+    OMB_REF_RECURSIVE_DOUBLING,
+    OMB_REF_RABENSEIFNER,
+    OMB_REF_BRUCK,
+    OMB_REF_PAIRWISE
+};
+#define OMB_REF_ALGO_NAMES                                                     \
+    {                                                                          \
+        "none", "binomial", "chain", "split_binary", "linear", "ring",         \
+            "recursive_doubling", "rabenseifner", "bruck", "pairwise"          \
+    }
+/*segment size left to the algorithm*/
+#define OMB_REF_SEGSIZE_AUTO -1
+
 struct options_t {
     enum accel_type accel;
     enum target_type target;
@@ -392,8 +454,28 @@ struct options_t {
     int omb_tail_lat;
     int log_validation;
     char log_validation_dir_path[OMB_FILE_PATH_MAX_LENGTH];
-    int omb_stat_percentiles[OMB_STAT_MAX_NUM];
+    double omb_stat_percentiles[OMB_STAT_MAX_NUM];
     int num_partitions;
+    char omb_algo_list[OMB_ALGO_LIST_MAX_LEN];
+    int omb_num_comm_sizes;
+    int omb_comm_sizes[OMB_MAX_COMM_SIZES];
+    enum omb_comm_place_t omb_comm_place;
+    int omb_sync_start;
+    double omb_sync_window;
+    int omb_adaptive;
+    double omb_adaptive_threshold;
+    int omb_cold_cache;
+    int omb_cold_cache_mb;
+    enum omb_mem_kind_t omb_mem_kind;
+    int omb_mem_node[OMB_MEM_NUM_NODE_ARGS];
+    char omb_trace_path[OMB_FILE_PATH_MAX_LENGTH];
+    double omb_gap_scale;
+    char omb_remap[OMB_REMAP_MAX_LEN];
+    char omb_tune_colls[OMB_ALGO_LIST_MAX_LEN];
+    char omb_tune_segsizes[OMB_ALGO_LIST_MAX_LEN];
+    char omb_tune_output[OMB_FILE_PATH_MAX_LENGTH];
+    enum omb_ref_algo_t omb_ref_algo;
+    int omb_ref_segsize;
 };
 
 struct help_msg_t {
@@ -8,7 +8,15 @@
  * copyright file COPYRIGHT in the top level directory.
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
 #include "osu_util_mpi.h"
+#include <sched.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 
 MPI_Request request[MAX_REQ_NUM];
 MPI_Status reqstat[MAX_REQ_NUM];
@@ -350,7 +358,6 @@ void print_header_one_sided(int rank, enum WINDOW win, enum SYNC sync,
 {
     char dtype_name_str[OMB_DATATYPE_STR_MAX_LEN];
     int dtype_name_size = 0;
-    int itr = 0;
 
     if (rank == 0) {
         switch (options.accel) {
@@ -400,22 +407,7 @@ void print_header_one_sided(int rank, enum WINDOW win, enum SYNC sync,
                     fprintf(stdout, "%*s", FIELD_WIDTH, "Validation");
                 }
                 if (options.omb_tail_lat) {
-                    itr = 0;
-                    while (itr < OMB_STAT_MAX_NUM &&
-                           -1 != options.omb_stat_percentiles[itr]) {
-                        if (BW == options.subtype) {
-                            fprintf(stdout, "%*sP%d Tail BW(MB/s)",
-                                    FIELD_WIDTH - strlen("Px Tail BW(MB/s)") -
-                                        (options.omb_stat_percentiles[itr] > 9),
-                                    "", options.omb_stat_percentiles[itr]);
-                        } else {
-                            fprintf(stdout, "%*sP%d Tail Lat(us)",
-                                    FIELD_WIDTH - strlen("Px Tail Lat(us)") -
-                                        (options.omb_stat_percentiles[itr] > 9),
-                                    "", options.omb_stat_percentiles[itr]);
-                        }
-                        itr++;
-                    }
+                    omb_print_tail_header();
                 }
                 fprintf(stdout, "\n");
                 fflush(stdout);
@@ -490,7 +482,6 @@ void print_preamble_nbc(int rank)
 
 void print_only_header_nbc(int rank)
 {
-    int itr = 0;
 
     if (rank) {
         return;
@@ -522,15 +513,7 @@ void print_only_header_nbc(int rank)
         fprintf(stdout, "%*s", FIELD_WIDTH, "Validation");
     }
     if (options.omb_tail_lat) {
-        itr = 0;
-        while (itr < OMB_STAT_MAX_NUM &&
-               -1 != options.omb_stat_percentiles[itr]) {
-            fprintf(stdout, "%*sP%d Tail Lat(us)",
-                    FIELD_WIDTH - strlen("Px Tail Lat(us)") -
-                        (options.omb_stat_percentiles[itr] > 9),
-                    "", options.omb_stat_percentiles[itr]);
-            itr++;
-        }
+        omb_print_tail_header();
     }
 
     if (options.omb_enable_ddt) {
@@ -558,6 +541,8 @@ void display_nbc_params()
     }
 }
 
+static const char *omb_ref_algo_names[] = OMB_REF_ALGO_NAMES;
+
 void print_preamble(int rank)
 {
     if (rank) {
@@ -583,12 +568,19 @@ void print_preamble(int rank)
             printf(benchmark_header, "");
             break;
     }
+    if (OMB_REF_NONE != options.omb_ref_algo) {
+        fprintf(stdout, "# Reference collective: %s over point to point calls",
+                omb_ref_algo_names[options.omb_ref_algo]);
+        if (0 < options.omb_ref_segsize) {
+            fprintf(stdout, ", %d byte segments", options.omb_ref_segsize);
+        }
+        fprintf(stdout, "\n");
+    }
     fflush(stdout);
 }
 
 void print_only_header(int rank)
 {
-    int itr = 0;
 
     if (rank) {
         return;
@@ -631,22 +623,7 @@ void print_only_header(int rank)
     if (options.validate)
         fprintf(stdout, "%*s", FIELD_WIDTH, "Validation");
     if (options.omb_tail_lat) {
-        itr = 0;
-        while (itr < OMB_STAT_MAX_NUM &&
-               -1 != options.omb_stat_percentiles[itr]) {
-            if (BW == options.subtype) {
-                fprintf(stdout, "%*sP%d Tail BW(MB/s)",
-                        FIELD_WIDTH - strlen("Px Tail BW(MB/s)") -
-                            (options.omb_stat_percentiles[itr] > 9),
-                        "", options.omb_stat_percentiles[itr]);
-            } else {
-                fprintf(stdout, "%*sP%d Tail Lat(us)",
-                        FIELD_WIDTH - strlen("Px Tail Lat(us)") -
-                            (options.omb_stat_percentiles[itr] > 9),
-                        "", options.omb_stat_percentiles[itr]);
-            }
-            itr++;
-        }
+        omb_print_tail_header();
     }
     if (options.omb_enable_ddt) {
         fprintf(stdout, "%*s", FIELD_WIDTH, "Transmit Size");
@@ -688,6 +665,8 @@ omb_mpi_init_data omb_mpi_init(int *argc, char ***argv)
 
 void omb_mpi_finalize(omb_mpi_init_data mpi_init)
 {
+    omb_cache_free();
+    omb_mem_report(mpi_init.omb_comm);
     if (1 == options.omb_enable_session) {
 #ifdef _ENABLE_MPI4_
         MPI_CHECK(MPI_Comm_free(&mpi_init.omb_comm));
@@ -698,6 +677,1728 @@ void omb_mpi_finalize(omb_mpi_init_data mpi_init)
     }
 }
 
+int omb_read_sysfs_int(const char *path)
+{
+    FILE *fp = fopen(path, "r");
+    int value = -1;
+
+    if (NULL == fp) {
+        return -1;
+    }
+    if (1 != fscanf(fp, "%d", &value)) {
+        value = -1;
+    }
+    fclose(fp);
+
+    return value;
+}
+
+void omb_get_rank_place(struct omb_rank_place_t *place)
+{
+    char path[256];
+    int node;
+
+    place->cpu = sched_getcpu();
+
+    snprintf(path, sizeof(path),
+             "/sys/devices/system/cpu/cpu%d/topology/core_id", place->cpu);
+    place->core = omb_read_sysfs_int(path);
+    snprintf(path, sizeof(path),
+             "/sys/devices/system/cpu/cpu%d/topology/physical_package_id",
+             place->cpu);
+    place->socket = omb_read_sysfs_int(path);
+    snprintf(path, sizeof(path),
+             "/sys/devices/system/cpu/cpu%d/cache/index3/id", place->cpu);
+    place->l3 = omb_read_sysfs_int(path);
+
+    place->numa = -1;
+    for (node = 0; node < 1024; node++) {
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/node%d",
+                 place->cpu, node);
+        if (0 == access(path, F_OK)) {
+            place->numa = node;
+            break;
+        }
+    }
+}
+
+void omb_quiet_wait(MPI_Request *request)
+{
+    struct timespec pause = {0, OMB_IDLE_SLEEP_NS};
+    int flag = 0;
+
+    MPI_CHECK(MPI_Test(request, &flag, MPI_STATUS_IGNORE));
+    while (!flag) {
+        nanosleep(&pause, NULL);
+        MPI_CHECK(MPI_Test(request, &flag, MPI_STATUS_IGNORE));
+    }
+}
+
+/*
+ * Cache state. With -C a run makes a hot pass, where every iteration reuses
+ * the same buffers as usual, and a cold pass, where every iteration takes
+ * the next slot of a pool per buffer larger than the last level cache, so
+ * that the data of a message was evicted since it was last touched. The
+ * pool is first touched by the rank that uses it.
+ */
+static struct omb_cache_t {
+    int cold;
+    int saved;
+    size_t iterations;
+    size_t skip;
+    size_t pool_size;
+    size_t alloc_size[OMB_CACHE_NUM_POOLS];
+    char *pools[OMB_CACHE_NUM_POOLS];
+} omb_cache;
+
+static size_t omb_cache_pool_size()
+{
+    char path[256];
+    int llc_kb = 0;
+
+    if (0 < options.omb_cold_cache_mb) {
+        return (size_t)options.omb_cold_cache_mb << 20;
+    }
+    snprintf(path, sizeof(path),
+             "/sys/devices/system/cpu/cpu%d/cache/index3/size",
+             sched_getcpu());
+    llc_kb = omb_read_sysfs_int(path);
+    if (0 >= llc_kb) {
+        return (size_t)OMB_CACHE_DEFAULT_POOL_MB << 20;
+    }
+    return (size_t)llc_kb * 1024 * OMB_CACHE_LLC_FACTOR;
+}
+
+int omb_cache_num_passes()
+{
+    return options.omb_cold_cache ? 2 : 1;
+}
+
+void omb_cache_select(int cache_itr, int rank)
+{
+    if (!options.omb_cold_cache) {
+        return;
+    }
+    if (NONE != options.accel) {
+        OMB_ERROR_EXIT("Cold cache passes need host buffers");
+    }
+    if (options.validate) {
+        OMB_ERROR_EXIT("Cold cache passes cannot be combined with"
+                       " validation");
+    }
+    if (0 == omb_cache.pool_size) {
+        omb_cache.pool_size = omb_cache_pool_size();
+    }
+    /* Both passes measure every size with the same iteration counts */
+    if (!omb_cache.saved) {
+        omb_cache.iterations = options.iterations;
+        omb_cache.skip = options.skip;
+        omb_cache.saved = 1;
+    }
+    options.iterations = omb_cache.iterations;
+    options.skip = omb_cache.skip;
+    omb_cache.cold = (1 == cache_itr);
+    if (0 != rank) {
+        return;
+    }
+    if (omb_cache.cold) {
+        fprintf(stdout,
+                "# Cache: cold, each iteration uses the next buffer of a"
+                " %zu MB pool\n",
+                omb_cache.pool_size >> 20);
+    } else {
+        fprintf(stdout, "# Cache: hot, each iteration reuses the same"
+                        " buffers\n");
+    }
+    fflush(stdout);
+}
+
+int omb_cache_is_cold()
+{
+    return omb_cache.cold;
+}
+
+void *omb_cache_buf(void *buf, size_t bytes, int itr, int pool)
+{
+    size_t stride = 0, alloc_size = 0;
+    long page_size = 0;
+
+    if (!omb_cache.cold || 0 == bytes) {
+        return buf;
+    }
+    page_size = sysconf(_SC_PAGESIZE);
+    stride = (bytes + page_size - 1) / page_size * page_size;
+    alloc_size = MAX(omb_cache.pool_size, OMB_CACHE_MIN_SLOTS * stride);
+    if (omb_cache.alloc_size[pool] < alloc_size) {
+        omb_mem_free(omb_cache.pools[pool]);
+        /* The pools follow the placement asked for with -M */
+        if (omb_mem_alloc((void **)&omb_cache.pools[pool], page_size,
+                          alloc_size,
+                          OMB_CACHE_SBUF == pool ? OMB_MEM_SBUF
+                                                 : OMB_MEM_RBUF)) {
+            OMB_ERROR_EXIT("Unable to allocate the cold cache pool");
+        }
+        memset(omb_cache.pools[pool], 0, alloc_size);
+        omb_cache.alloc_size[pool] = alloc_size;
+    }
+    return omb_cache.pools[pool] +
+           (itr % (omb_cache.alloc_size[pool] / stride)) * stride;
+}
+
+void omb_cache_free()
+{
+    int pool = 0;
+
+    for (pool = 0; pool < OMB_CACHE_NUM_POOLS; pool++) {
+        omb_mem_free(omb_cache.pools[pool]);
+        omb_cache.pools[pool] = NULL;
+        omb_cache.alloc_size[pool] = 0;
+    }
+    omb_cache.cold = 0;
+}
+
+/*
+ * Buffer placement. With -M the host buffers are mapped by hand instead of
+ * coming from posix_memalign: plain anonymous memory, memory advised for
+ * transparent huge pages, explicit huge pages or a POSIX shared memory
+ * segment, bound with mbind to the requested NUMA node before the first
+ * touch. Right after the first touch move_pages tells which node a sample of
+ * the pages landed on and /proc/self/smaps how much of the mapping is backed
+ * by huge pages; the totals per buffer role are printed at finalize.
+ */
+struct omb_mem_region_t {
+    void *buf;
+    void *base;
+    size_t len;
+};
+
+struct omb_mem_usage_t {
+    int allocs;
+    size_t bytes;
+    size_t huge_bytes;
+    double node_bytes[OMB_MEM_MAX_NODES];
+    double unknown_bytes;
+};
+
+static struct omb_mem_t {
+    struct omb_mem_region_t *regions;
+    int num_regions;
+    int max_regions;
+    int num_segments;
+    struct omb_mem_usage_t usage[OMB_MEM_NUM_ROLES];
+} omb_mem;
+
+static const char *omb_mem_kind_names[] = {"default", "host", "thp", "huge",
+                                           "shm"};
+static const char *omb_mem_role_names[] = {"send", "recv", "coll"};
+
+static size_t omb_mem_huge_page_size()
+{
+    FILE *fp = fopen("/proc/meminfo", "r");
+    char line[OMB_MEM_LINE_LEN];
+    unsigned long kb = 0;
+
+    if (NULL == fp) {
+        return OMB_MEM_HUGE_DEFAULT;
+    }
+    while (NULL != fgets(line, sizeof(line), fp)) {
+        if (1 == sscanf(line, "Hugepagesize: %lu kB", &kb)) {
+            break;
+        }
+    }
+    fclose(fp);
+
+    return kb ? kb << 10 : OMB_MEM_HUGE_DEFAULT;
+}
+
+/* NUMA node for a buffer role, OMB_MEM_NODE_ANY when it is not bound */
+static int omb_mem_node(int role)
+{
+    struct omb_rank_place_t place;
+    char path[OMB_MEM_LINE_LEN];
+    int node = options.omb_mem_node[OMB_MEM_RBUF == role ? 1 : 0];
+
+    if (OMB_MEM_NODE_LOCAL == node) {
+        omb_get_rank_place(&place);
+        node = place.numa;
+    }
+    if (OMB_MEM_NODE_ANY == node) {
+        return node;
+    }
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d", node);
+    if (OMB_MEM_MAX_NODES <= node || 0 != access(path, F_OK)) {
+        OMB_ERROR_EXIT("Buffer placement asks for a NUMA node that does not"
+                       " exist");
+    }
+
+    return node;
+}
+
+static void omb_mem_map(size_t size, struct omb_mem_region_t *region)
+{
+    size_t huge_page = omb_mem_huge_page_size();
+    char name[OMB_MEM_SHM_NAME_LEN];
+    int fd = -1;
+
+    region->len = size;
+    switch (options.omb_mem_kind) {
+        case OMB_MEM_THP:
+            /* Map one huge page more, so that the buffer can start aligned */
+            region->len = size + huge_page;
+            region->base = mmap(NULL, region->len, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (MAP_FAILED == region->base) {
+                break;
+            }
+            region->buf = (void *)(((uintptr_t)region->base + huge_page - 1) &
+                                   ~(uintptr_t)(huge_page - 1));
+            if (madvise(region->buf, size, MADV_HUGEPAGE)) {
+                OMB_ERROR_EXIT("Transparent huge pages are not available");
+            }
+            return;
+        case OMB_MEM_HUGE:
+            region->len = (size + huge_page - 1) / huge_page * huge_page;
+            region->base =
+                mmap(NULL, region->len, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (MAP_FAILED == region->base) {
+                OMB_ERROR_EXIT("Not enough explicit huge pages, see"
+                               " /proc/sys/vm/nr_hugepages");
+            }
+            break;
+        case OMB_MEM_SHM:
+            snprintf(name, sizeof(name), "/omb-%d-%d", (int)getpid(),
+                     omb_mem.num_segments++);
+            fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+            if (-1 == fd) {
+                OMB_ERROR_EXIT("Cannot create a shared memory segment");
+            }
+            /* The mapping keeps the segment alive, the name is not needed */
+            shm_unlink(name);
+            if (ftruncate(fd, size)) {
+                OMB_ERROR_EXIT("Cannot size the shared memory segment");
+            }
+            region->base = mmap(NULL, region->len, PROT_READ | PROT_WRITE,
+                                MAP_SHARED, fd, 0);
+            close(fd);
+            break;
+        default:
+            region->base = mmap(NULL, region->len, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            break;
+    }
+    region->buf = region->base;
+}
+
+/* Bytes of the mapping holding buf that are backed by huge pages */
+static size_t omb_mem_huge_bytes(void *buf)
+{
+    FILE *fp = fopen("/proc/self/smaps", "r");
+    char line[OMB_MEM_LINE_LEN];
+    unsigned long start = 0, end = 0, kb = 0;
+    int inside = 0;
+    size_t huge_bytes = 0;
+
+    if (NULL == fp) {
+        return 0;
+    }
+    while (NULL != fgets(line, sizeof(line), fp)) {
+        if (2 == sscanf(line, "%lx-%lx ", &start, &end)) {
+            if (inside) {
+                break;
+            }
+            inside = ((uintptr_t)buf >= start && (uintptr_t)buf < end);
+        } else if (inside &&
+                   (1 == sscanf(line, "AnonHugePages: %lu kB", &kb) ||
+                    1 == sscanf(line, "ShmemPmdMapped: %lu kB", &kb) ||
+                    1 == sscanf(line, "Private_Hugetlb: %lu kB", &kb) ||
+                    1 == sscanf(line, "Shared_Hugetlb: %lu kB", &kb))) {
+            huge_bytes += kb << 10;
+        }
+    }
+    fclose(fp);
+
+    return huge_bytes;
+}
+
+static void omb_mem_record(void *buf, size_t size, int role)
+{
+    struct omb_mem_usage_t *usage = &omb_mem.usage[role];
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    size_t num_pages = (size + page_size - 1) / page_size;
+    size_t num_samples = MIN(num_pages, OMB_MEM_MAX_SAMPLES);
+    void *pages[OMB_MEM_MAX_SAMPLES];
+    int status[OMB_MEM_MAX_SAMPLES];
+    double sample_bytes = (double)size / num_samples;
+    size_t k = 0;
+
+    for (k = 0; k < num_samples; k++) {
+        pages[k] = (char *)buf + (k * num_pages / num_samples) * page_size;
+    }
+    /* Without a list of target nodes move_pages only reports the nodes */
+    if (syscall(SYS_move_pages, 0, num_samples, pages, NULL, status, 0)) {
+        usage->unknown_bytes += size;
+    } else {
+        for (k = 0; k < num_samples; k++) {
+            if (0 <= status[k] && OMB_MEM_MAX_NODES > status[k]) {
+                usage->node_bytes[status[k]] += sample_bytes;
+            } else {
+                usage->unknown_bytes += sample_bytes;
+            }
+        }
+    }
+    usage->allocs++;
+    usage->bytes += size;
+    usage->huge_bytes += MIN(size, omb_mem_huge_bytes(buf));
+}
+
+int omb_mem_alloc(void **buffer, size_t alignment, size_t size, int role)
+{
+    unsigned long mask[OMB_MEM_MAX_NODES / (8 * sizeof(unsigned long))] = {0};
+    struct omb_mem_region_t region;
+    int node = OMB_MEM_NODE_ANY;
+
+    if (OMB_MEM_DEFAULT == options.omb_mem_kind) {
+        return posix_memalign(buffer, alignment, size);
+    }
+    size = MAX(size, 1);
+    omb_mem_map(size, &region);
+    if (MAP_FAILED == region.base) {
+        return 1;
+    }
+    node = omb_mem_node(role);
+    if (OMB_MEM_NODE_ANY != node) {
+        mask[node / (8 * sizeof(unsigned long))] |=
+            1UL << (node % (8 * sizeof(unsigned long)));
+        if (syscall(SYS_mbind, region.buf, size, OMB_MPOL_BIND, mask,
+                    OMB_MEM_MAX_NODES + 1,
+                    OMB_MPOL_MF_STRICT | OMB_MPOL_MF_MOVE)) {
+            OMB_ERROR_EXIT("Cannot bind a buffer to its NUMA node");
+        }
+    }
+    /* First touch, so that the pages exist when they are looked up */
+    memset(region.buf, 0, size);
+    omb_mem_record(region.buf, size, role);
+
+    if (omb_mem.num_regions == omb_mem.max_regions) {
+        omb_mem.max_regions = MAX(2 * omb_mem.max_regions, 16);
+        omb_mem.regions =
+            realloc(omb_mem.regions,
+                    omb_mem.max_regions * sizeof(struct omb_mem_region_t));
+        OMB_CHECK_NULL_AND_EXIT(omb_mem.regions, "Unable to allocate memory");
+    }
+    omb_mem.regions[omb_mem.num_regions++] = region;
+    *buffer = region.buf;
+
+    return 0;
+}
+
+void omb_mem_free(void *buffer)
+{
+    int itr = 0;
+
+    if (NULL == buffer) {
+        return;
+    }
+    for (itr = 0; itr < omb_mem.num_regions; itr++) {
+        if (buffer == omb_mem.regions[itr].buf) {
+            munmap(omb_mem.regions[itr].base, omb_mem.regions[itr].len);
+            omb_mem.regions[itr] = omb_mem.regions[--omb_mem.num_regions];
+            return;
+        }
+    }
+    free(buffer);
+}
+
+static void omb_mem_node_name(int node, char *name, size_t len)
+{
+    if (OMB_MEM_NODE_ANY == node) {
+        snprintf(name, len, "any");
+    } else if (OMB_MEM_NODE_LOCAL == node) {
+        snprintf(name, len, "local");
+    } else {
+        snprintf(name, len, "%d", node);
+    }
+}
+
+void omb_mem_report(MPI_Comm comm)
+{
+    struct omb_rank_place_t place;
+    struct omb_mem_usage_t *usage = NULL;
+    char line[OMB_MEM_REPORT_LEN];
+    char snode[OMB_MEM_SHM_NAME_LEN], rnode[OMB_MEM_SHM_NAME_LEN];
+    char *lines = NULL;
+    int rank = 0, numprocs = 0, role = 0, node = 0, itr = 0;
+    size_t len = 0;
+
+    if (OMB_MEM_DEFAULT == options.omb_mem_kind || MPI_COMM_NULL == comm) {
+        return;
+    }
+    MPI_CHECK(MPI_Comm_rank(comm, &rank));
+    MPI_CHECK(MPI_Comm_size(comm, &numprocs));
+    omb_get_rank_place(&place);
+
+    line[0] = '\0';
+    for (role = 0; role < OMB_MEM_NUM_ROLES; role++) {
+        usage = &omb_mem.usage[role];
+        if (0 == usage->allocs || len >= sizeof(line)) {
+            continue;
+        }
+        len += snprintf(line + len, sizeof(line) - len,
+                        "%-8d%8d  %-8s%8d%*zu%*.0f%%", rank, place.numa,
+                        omb_mem_role_names[role], usage->allocs, FIELD_WIDTH,
+                        usage->bytes, FIELD_WIDTH - 1,
+                        100.0 * usage->huge_bytes / usage->bytes);
+        for (node = 0; node < OMB_MEM_MAX_NODES && len < sizeof(line);
+             node++) {
+            if (0 < usage->node_bytes[node]) {
+                len += snprintf(line + len, sizeof(line) - len, "  %d:%.0f%%",
+                                node,
+                                100.0 * usage->node_bytes[node] / usage->bytes);
+            }
+        }
+        if (0 < usage->unknown_bytes && len < sizeof(line)) {
+            len += snprintf(line + len, sizeof(line) - len, "  ?:%.0f%%",
+                            100.0 * usage->unknown_bytes / usage->bytes);
+        }
+        if (len < sizeof(line)) {
+            len += snprintf(line + len, sizeof(line) - len, "\n");
+        }
+    }
+
+    if (0 == rank) {
+        lines = malloc((size_t)numprocs * OMB_MEM_REPORT_LEN);
+        OMB_CHECK_NULL_AND_EXIT(lines, "Unable to allocate memory");
+    }
+    MPI_CHECK(MPI_Gather(line, OMB_MEM_REPORT_LEN, MPI_CHAR, lines,
+                         OMB_MEM_REPORT_LEN, MPI_CHAR, 0, comm));
+    if (0 != rank) {
+        return;
+    }
+    omb_mem_node_name(options.omb_mem_node[0], snode, sizeof(snode));
+    omb_mem_node_name(options.omb_mem_node[1], rnode, sizeof(rnode));
+    fprintf(stdout,
+            "\n# Buffer placement: %s memory, send node %s, receive node %s\n",
+            omb_mem_kind_names[options.omb_mem_kind], snode, rnode);
+    fprintf(stdout, "%-8s%8s  %-8s%8s%*s%*s  %s\n", "# Rank", "CPU node",
+            "Buffer", "Allocs", FIELD_WIDTH, "Bytes", FIELD_WIDTH, "Huge pages",
+            "Bytes by node");
+    for (itr = 0; itr < numprocs; itr++) {
+        fprintf(stdout, "%s", lines + (size_t)itr * OMB_MEM_REPORT_LEN);
+    }
+    fflush(stdout);
+    free(lines);
+}
+
+/*
+ * Collective sweeps. A run is split in passes over the communicator sizes
+ * given with -S, the cache states of -C and the algorithms given with -A.
+ * For each size the ranks picked by the placement policy get a
+ * sub-communicator from MPI_Comm_split while the others wait quietly. For
+ * each algorithm the algorithm control variable of the collective is written
+ * through the MPI tool interface and the communicator is duplicated, since
+ * Open MPI's tuned component reads the forced algorithm when a communicator
+ * is created.
+ */
+static struct omb_sweep_t {
+    int mpit_initialized;
+    int num_algos;
+    int values[OMB_ALGO_MAX_NUM];
+    char names[OMB_ALGO_MAX_NUM][OMB_ALGO_NAME_MAX_LEN];
+    char cvar_name[OMB_ALGO_NAME_MAX_LEN];
+    int default_value;
+    MPI_T_cvar_handle cvar_handle;
+    MPI_Comm algo_comm;
+    int position;
+    MPI_Comm size_comm;
+    int curr_nprocs;
+    int curr_column;
+    int num_rows;
+    int first_row;
+    int curr_row;
+    int *row_nprocs;
+    int *row_sizes;
+    double *row_latency;
+    int iterations;
+    int skip;
+} omb_sweep;
+
+static const char *omb_comm_place_names[] = {"first", "socket", "ccx"};
+
+struct omb_sweep_slot_t {
+    int slot;
+    int domain;
+    int rank;
+};
+
+static void omb_sweep_quiet_barrier(MPI_Comm comm)
+{
+    MPI_Request request;
+
+    MPI_CHECK(MPI_Ibarrier(comm, &request));
+    omb_quiet_wait(&request);
+}
+
+static int omb_sweep_slot_cmp(const void *a, const void *b)
+{
+    const struct omb_sweep_slot_t *s1 = a, *s2 = b;
+
+    if (s1->slot != s2->slot) {
+        return s1->slot - s2->slot;
+    }
+    if (s1->domain != s2->domain) {
+        return s1->domain - s2->domain;
+    }
+    return s1->rank - s2->rank;
+}
+
+/*
+ * Position of this rank in the placement order: the first N ranks of the
+ * order form the communicator of size N. With the socket and ccx policies
+ * the order takes one rank from each domain (socket or L3 of a node, in
+ * order of their lowest rank), then a second one from each, and so on.
+ */
+static void omb_sweep_init_position(MPI_Comm comm)
+{
+    struct omb_rank_place_t place;
+    struct omb_sweep_slot_t *slots = NULL;
+    MPI_Comm node_comm;
+    int rank = 0, comm_size = 0, node_leader = 0, itr = 0, j = 0;
+    int domain[2], *domains = NULL;
+
+    MPI_CHECK(MPI_Comm_rank(comm, &rank));
+    MPI_CHECK(MPI_Comm_size(comm, &comm_size));
+    if (OMB_COMM_PLACE_FIRST == options.omb_comm_place) {
+        omb_sweep.position = rank;
+        return;
+    }
+    MPI_CHECK(MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL,
+                                  &node_comm));
+    MPI_CHECK(MPI_Allreduce(&rank, &node_leader, 1, MPI_INT, MPI_MIN,
+                            node_comm));
+    MPI_CHECK(MPI_Comm_free(&node_comm));
+    omb_get_rank_place(&place);
+    domain[0] = node_leader;
+    domain[1] = (OMB_COMM_PLACE_SOCKET == options.omb_comm_place) ?
+                    place.socket :
+                    place.l3;
+
+    domains = malloc(2 * comm_size * sizeof(int));
+    slots = malloc(comm_size * sizeof(struct omb_sweep_slot_t));
+    OMB_CHECK_NULL_AND_EXIT(domains, "Unable to allocate memory");
+    OMB_CHECK_NULL_AND_EXIT(slots, "Unable to allocate memory");
+    MPI_CHECK(MPI_Allgather(domain, 2, MPI_INT, domains, 2, MPI_INT, comm));
+    for (itr = 0; itr < comm_size; itr++) {
+        slots[itr].rank = itr;
+        slots[itr].slot = 0;
+        slots[itr].domain = itr;
+        for (j = 0; j < itr; j++) {
+            if (domains[2 * j] == domains[2 * itr] &&
+                domains[2 * j + 1] == domains[2 * itr + 1]) {
+                slots[itr].domain = slots[j].domain;
+                slots[itr].slot++;
+            }
+        }
+    }
+    qsort(slots, comm_size, sizeof(struct omb_sweep_slot_t),
+          omb_sweep_slot_cmp);
+    for (itr = 0; itr < comm_size; itr++) {
+        if (slots[itr].rank == rank) {
+            omb_sweep.position = itr;
+        }
+    }
+    free(domains);
+    free(slots);
+}
+
+static int omb_sweep_disable(int rank, const char *reason)
+{
+    if (0 == rank) {
+        fprintf(stdout,
+                "# Algorithm sweep disabled: %s.\n"
+                "# Running the library's default algorithm selection only.\n",
+                reason);
+        fflush(stdout);
+    }
+    omb_sweep.num_algos = 0;
+    return 0;
+}
+
+static int omb_sweep_read_cvar(const char *name, int *value)
+{
+    int cvar_index = 0, count = 0;
+    MPI_T_cvar_handle handle;
+
+    if (MPI_SUCCESS != MPI_T_cvar_get_index(name, &cvar_index) ||
+        MPI_SUCCESS !=
+            MPI_T_cvar_handle_alloc(cvar_index, NULL, &handle, &count)) {
+        return -1;
+    }
+    MPI_CHECK(MPI_T_cvar_read(handle, value));
+    MPI_CHECK(MPI_T_cvar_handle_free(&handle));
+    return 0;
+}
+
+static void omb_sweep_add_algo(int value, const char *name)
+{
+    char message[OMB_ALGO_NAME_MAX_LEN];
+
+    if (OMB_ALGO_MAX_NUM == omb_sweep.num_algos) {
+        snprintf(message, sizeof(message), "At most %d algorithms per sweep",
+                 OMB_ALGO_MAX_NUM);
+        OMB_ERROR_EXIT(message);
+    }
+    omb_sweep.values[omb_sweep.num_algos] = value;
+    snprintf(omb_sweep.names[omb_sweep.num_algos], OMB_ALGO_NAME_MAX_LEN, "%s",
+             name);
+    omb_sweep.num_algos++;
+}
+
+/* Resolves the -A list against the control variable, returns the count */
+static int omb_sweep_init_algos(MPI_Comm comm, int rank)
+{
+    int provided = 0, cvar_index = 0, count = 0, comm_size = 0;
+    int name_len = 0, desc_len = 0, verbosity = 0, bind = 0, scope = 0;
+    int num_items = 0, itr = 0, value = 0, found = 0, dynamic_rules = 0;
+    int mpi_errno = MPI_SUCCESS;
+    char item_name[OMB_ALGO_NAME_MAX_LEN], desc[OMB_ALGO_NAME_MAX_LEN];
+    char reason[2 * OMB_ALGO_NAME_MAX_LEN];
+    char list[OMB_ALGO_LIST_MAX_LEN];
+    char *token = NULL, *end = NULL;
+    const char *coll_name = benchmark_name;
+    MPI_Datatype cvar_type;
+    MPI_T_enum enum_type;
+
+    MPI_CHECK(MPI_T_init_thread(MPI_THREAD_SINGLE, &provided));
+    omb_sweep.mpit_initialized = 1;
+    MPI_CHECK(MPI_Comm_size(comm, &comm_size));
+
+    if (0 == strncmp(coll_name, "osu_", 4)) {
+        coll_name += 4;
+    }
+    snprintf(omb_sweep.cvar_name, OMB_ALGO_NAME_MAX_LEN, OMB_ALGO_CVAR_FORMAT,
+             coll_name);
+    if (MPI_SUCCESS != MPI_T_cvar_get_index(omb_sweep.cvar_name, &cvar_index)) {
+        snprintf(reason, sizeof(reason),
+                 "control variable %s not found in this MPI library",
+                 omb_sweep.cvar_name);
+        return omb_sweep_disable(rank, reason);
+    }
+    name_len = desc_len = OMB_ALGO_NAME_MAX_LEN;
+    MPI_CHECK(MPI_T_cvar_get_info(cvar_index, item_name, &name_len,
+                                  &verbosity, &cvar_type, &enum_type, desc,
+                                  &desc_len, &bind, &scope));
+    if (MPI_T_SCOPE_CONSTANT == scope || MPI_T_SCOPE_READONLY == scope ||
+        MPI_T_BIND_NO_OBJECT != bind || MPI_INT != cvar_type) {
+        snprintf(reason, sizeof(reason),
+                 "control variable %s is not writable at runtime",
+                 omb_sweep.cvar_name);
+        return omb_sweep_disable(rank, reason);
+    }
+    if (0 == omb_sweep_read_cvar(OMB_ALGO_DYNAMIC_CVAR, &dynamic_rules) &&
+        0 == dynamic_rules) {
+        snprintf(reason, sizeof(reason),
+                 "%s is off and can only be set at launch, relaunch"
+                 " with --mca %s 1",
+                 OMB_ALGO_DYNAMIC_CVAR, OMB_ALGO_DYNAMIC_CVAR);
+        return omb_sweep_disable(rank, reason);
+    }
+    MPI_CHECK(MPI_T_cvar_handle_alloc(cvar_index, NULL, &omb_sweep.cvar_handle,
+                                      &count));
+    MPI_CHECK(
+        MPI_T_cvar_read(omb_sweep.cvar_handle, &omb_sweep.default_value));
+    if (MPI_T_ENUM_NULL != enum_type) {
+        name_len = OMB_ALGO_NAME_MAX_LEN;
+        MPI_CHECK(MPI_T_enum_get_info(enum_type, &num_items, item_name,
+                                      &name_len));
+    }
+
+    /* Algorithms are given by number or by the names the library reports */
+    strcpy(list, options.omb_algo_list);
+    for (token = strtok(list, ","); NULL != token; token = strtok(NULL, ",")) {
+        if (0 == strcasecmp(token, "all")) {
+            if (MPI_T_ENUM_NULL == enum_type) {
+                OMB_ERROR_EXIT("The MPI library does not list the algorithms,"
+                               " pass them by number");
+            }
+            for (itr = 0; itr < num_items; itr++) {
+                name_len = OMB_ALGO_NAME_MAX_LEN;
+                MPI_CHECK(MPI_T_enum_get_item(enum_type, itr, &value,
+                                              item_name, &name_len));
+                /* The two_proc variants fail on any other process count */
+                if (2 != comm_size && NULL != strstr(item_name, "two_proc")) {
+                    continue;
+                }
+                omb_sweep_add_algo(value, item_name);
+            }
+            continue;
+        }
+        value = strtol(token, &end, 10);
+        found = (MPI_T_ENUM_NULL == enum_type && '\0' == *end);
+        snprintf(item_name, OMB_ALGO_NAME_MAX_LEN, "%s", token);
+        for (itr = 0; itr < num_items && !found; itr++) {
+            int item_value = 0;
+
+            name_len = OMB_ALGO_NAME_MAX_LEN;
+            MPI_CHECK(MPI_T_enum_get_item(enum_type, itr, &item_value,
+                                          item_name, &name_len));
+            if (('\0' == *end && item_value == value) ||
+                ('\0' != *end && 0 == strcasecmp(item_name, token))) {
+                value = item_value;
+                found = 1;
+            }
+        }
+        if (!found) {
+            snprintf(reason, sizeof(reason), "Unknown algorithm %s for %s",
+                     token, omb_sweep.cvar_name);
+            OMB_ERROR_EXIT(reason);
+        }
+        omb_sweep_add_algo(value, item_name);
+    }
+    if (0 == omb_sweep.num_algos) {
+        MPI_CHECK(MPI_T_cvar_handle_free(&omb_sweep.cvar_handle));
+        return omb_sweep_disable(rank, "empty algorithm list");
+    }
+
+    mpi_errno = MPI_T_cvar_write(omb_sweep.cvar_handle, &omb_sweep.values[0]);
+    if (MPI_SUCCESS != mpi_errno) {
+        MPI_CHECK(MPI_T_cvar_handle_free(&omb_sweep.cvar_handle));
+        snprintf(reason, sizeof(reason),
+                 "writing %s failed with MPI_T error %d", omb_sweep.cvar_name,
+                 mpi_errno);
+        return omb_sweep_disable(rank, reason);
+    }
+    return omb_sweep.num_algos;
+}
+
+int omb_sweep_init(MPI_Comm comm, int rank)
+{
+    int itr = 0, comm_size = 0;
+    char message[OMB_ALGO_NAME_MAX_LEN];
+
+    omb_sweep.num_algos = 0;
+    omb_sweep.algo_comm = MPI_COMM_NULL;
+    omb_sweep.size_comm = MPI_COMM_NULL;
+    omb_sweep.iterations = options.iterations;
+    omb_sweep.skip = options.skip;
+    if ('\0' != options.omb_algo_list[0]) {
+        omb_sweep_init_algos(comm, rank);
+    }
+    if (0 < options.omb_num_comm_sizes) {
+        /* These reduce over MPI_COMM_WORLD or assume its rank numbering */
+        if (options.omb_tail_lat || options.papi_enabled || options.validate) {
+            OMB_ERROR_EXIT("Communicator size sweep cannot be combined with"
+                           " tail latencies, PAPI or validation");
+        }
+        MPI_CHECK(MPI_Comm_size(comm, &comm_size));
+        for (itr = 0; itr < options.omb_num_comm_sizes; itr++) {
+            if (options.omb_comm_sizes[itr] > comm_size) {
+                snprintf(message, sizeof(message),
+                         "Communicator size %d exceeds the %d processes of"
+                         " the run",
+                         options.omb_comm_sizes[itr], comm_size);
+                OMB_ERROR_EXIT(message);
+            }
+        }
+        omb_sweep_init_position(comm);
+    }
+    return MAX(1, options.omb_num_comm_sizes) * omb_cache_num_passes() *
+           MAX(1, omb_sweep.num_algos);
+}
+
+MPI_Comm omb_sweep_select(int sweep_itr, MPI_Comm comm, int rank)
+{
+    int num_algos = MAX(1, omb_sweep.num_algos);
+    int algo_itr = sweep_itr % num_algos;
+    int cache_itr = (sweep_itr / num_algos) % omb_cache_num_passes();
+    int size_itr = sweep_itr / (num_algos * omb_cache_num_passes());
+    int nprocs = 0;
+    MPI_Comm base = comm;
+
+    /* Every pass starts again from the small message iteration counts */
+    options.iterations = omb_sweep.iterations;
+    options.skip = omb_sweep.skip;
+    if (0 < options.omb_num_comm_sizes) {
+        /* Ranks left out of the previous pass have been waiting here */
+        if (0 < sweep_itr) {
+            omb_sweep_quiet_barrier(comm);
+        }
+        if (0 == sweep_itr % (num_algos * omb_cache_num_passes())) {
+            if (MPI_COMM_NULL != omb_sweep.size_comm) {
+                MPI_CHECK(MPI_Comm_free(&omb_sweep.size_comm));
+            }
+            nprocs = options.omb_comm_sizes[size_itr];
+            MPI_CHECK(MPI_Comm_split(
+                comm, omb_sweep.position < nprocs ? 0 : MPI_UNDEFINED,
+                omb_sweep.position, &omb_sweep.size_comm));
+            omb_sweep.first_row = omb_sweep.num_rows;
+            if (0 == rank) {
+                fprintf(stdout, "# Communicator size: %d (%s placement)\n",
+                        nprocs, omb_comm_place_names[options.omb_comm_place]);
+                fflush(stdout);
+            }
+        }
+        base = omb_sweep.size_comm;
+        if (MPI_COMM_NULL == base) {
+            return MPI_COMM_NULL;
+        }
+    }
+    if (0 == algo_itr) {
+        omb_cache_select(cache_itr, rank);
+    }
+    MPI_CHECK(MPI_Comm_size(base, &omb_sweep.curr_nprocs));
+    omb_sweep.curr_row = omb_sweep.first_row;
+    omb_sweep.curr_column = cache_itr * num_algos + algo_itr;
+    if (0 == omb_sweep.num_algos) {
+        return base;
+    }
+
+    if (MPI_COMM_NULL != omb_sweep.algo_comm) {
+        MPI_CHECK(MPI_Comm_free(&omb_sweep.algo_comm));
+    }
+    MPI_CHECK(MPI_T_cvar_write(omb_sweep.cvar_handle,
+                               &omb_sweep.values[algo_itr]));
+    MPI_CHECK(MPI_Comm_dup(base, &omb_sweep.algo_comm));
+    if (0 == rank) {
+        fprintf(stdout, "# Algorithm: %s = %d (%s)\n", omb_sweep.cvar_name,
+                omb_sweep.values[algo_itr], omb_sweep.names[algo_itr]);
+        fflush(stdout);
+    }
+    return omb_sweep.algo_comm;
+}
+
+void omb_sweep_record(int size, double avg_time)
+{
+    int row = 0, itr = 0;
+
+    if (0 == omb_sweep.num_algos && 0 == options.omb_num_comm_sizes &&
+        !options.omb_cold_cache) {
+        return;
+    }
+    row = omb_sweep.curr_row++;
+    if (row >= omb_sweep.num_rows) {
+        omb_sweep.row_nprocs =
+            realloc(omb_sweep.row_nprocs, (row + 1) * sizeof(int));
+        omb_sweep.row_sizes =
+            realloc(omb_sweep.row_sizes, (row + 1) * sizeof(int));
+        omb_sweep.row_latency =
+            realloc(omb_sweep.row_latency,
+                    (row + 1) * OMB_SWEEP_MAX_COLUMNS * sizeof(double));
+        OMB_CHECK_NULL_AND_EXIT(omb_sweep.row_nprocs,
+                                "Unable to allocate memory");
+        OMB_CHECK_NULL_AND_EXIT(omb_sweep.row_sizes,
+                                "Unable to allocate memory");
+        OMB_CHECK_NULL_AND_EXIT(omb_sweep.row_latency,
+                                "Unable to allocate memory");
+        for (itr = 0; itr < OMB_SWEEP_MAX_COLUMNS; itr++) {
+            omb_sweep.row_latency[row * OMB_SWEEP_MAX_COLUMNS + itr] = -1;
+        }
+        omb_sweep.num_rows = row + 1;
+    }
+    omb_sweep.row_nprocs[row] = omb_sweep.curr_nprocs;
+    omb_sweep.row_sizes[row] = size;
+    omb_sweep.row_latency[row * OMB_SWEEP_MAX_COLUMNS +
+                          omb_sweep.curr_column] = avg_time;
+}
+
+/* Algorithm and cache state of a pass, for passes that sweep either */
+static void omb_sweep_pass_name(int column, char *name, size_t len)
+{
+    int algo_itr = column % MAX(1, omb_sweep.num_algos);
+    int cold = column / MAX(1, omb_sweep.num_algos);
+
+    if (0 < omb_sweep.num_algos && options.omb_cold_cache) {
+        snprintf(name, len, "%s (%s)", omb_sweep.names[algo_itr],
+                 cold ? "cold" : "hot");
+    } else if (0 < omb_sweep.num_algos) {
+        snprintf(name, len, "%s", omb_sweep.names[algo_itr]);
+    } else {
+        snprintf(name, len, "%s", cold ? "cold" : "hot");
+    }
+}
+
+static void omb_sweep_column_name(int column, char *name, size_t len)
+{
+    int cold = column / MAX(1, omb_sweep.num_algos);
+
+    if (0 < omb_sweep.num_algos) {
+        omb_sweep_pass_name(column, name, len);
+    } else if (options.omb_cold_cache) {
+        snprintf(name, len, "%s",
+                 cold ? "Cold Latency(us)" : "Hot Latency(us)");
+    } else {
+        snprintf(name, len, "%s", "Avg Latency(us)");
+    }
+}
+
+static void omb_sweep_print_table()
+{
+    int row = 0, itr = 0, width = 0;
+    int num_columns = MAX(1, omb_sweep.num_algos) * omb_cache_num_passes();
+    double *row_latency = NULL;
+    char name[OMB_ALGO_NAME_MAX_LEN + 8];
+    char by[OMB_ALGO_NAME_MAX_LEN * 2];
+
+    by[0] = '\0';
+    if (0 < options.omb_num_comm_sizes) {
+        strcat(by, ", communicator size");
+    }
+    if (0 < omb_sweep.num_algos) {
+        strcat(by, ", ");
+        strcat(by, omb_sweep.cvar_name);
+    }
+    if (options.omb_cold_cache) {
+        strcat(by, ", cache state");
+    }
+    fprintf(stdout, "\n# Avg Latency(us) by %s\n", by + 2);
+    if (0 < options.omb_num_comm_sizes) {
+        fprintf(stdout, "%-*s%-*s", 10, "# Procs", 10, "Size");
+    } else {
+        fprintf(stdout, "%-*s", 10, "# Size");
+    }
+    for (itr = 0; itr < num_columns; itr++) {
+        omb_sweep_column_name(itr, name, sizeof(name));
+        width = MAX(FIELD_WIDTH, (int)strlen(name) + 2);
+        fprintf(stdout, "%*s", width, name);
+    }
+    fprintf(stdout, "\n");
+    for (row = 0; row < omb_sweep.num_rows; row++) {
+        row_latency = omb_sweep.row_latency + row * OMB_SWEEP_MAX_COLUMNS;
+        if (0 < options.omb_num_comm_sizes) {
+            fprintf(stdout, "%-*d", 10, omb_sweep.row_nprocs[row]);
+        }
+        fprintf(stdout, "%-*d", 10, omb_sweep.row_sizes[row]);
+        for (itr = 0; itr < num_columns; itr++) {
+            omb_sweep_column_name(itr, name, sizeof(name));
+            width = MAX(FIELD_WIDTH, (int)strlen(name) + 2);
+            if (0 > row_latency[itr]) {
+                fprintf(stdout, "%*s", width, "-");
+            } else {
+                fprintf(stdout, "%*.*f", width, FLOAT_PRECISION,
+                        row_latency[itr]);
+            }
+        }
+        fprintf(stdout, "\n");
+    }
+    fflush(stdout);
+}
+
+void omb_sweep_finalize(MPI_Comm comm, int rank)
+{
+    if (0 < options.omb_num_comm_sizes) {
+        omb_sweep_quiet_barrier(comm);
+        if (MPI_COMM_NULL != omb_sweep.size_comm) {
+            MPI_CHECK(MPI_Comm_free(&omb_sweep.size_comm));
+        }
+    }
+    if (0 == rank && 0 < omb_sweep.num_rows) {
+        omb_sweep_print_table();
+    }
+    if (0 < omb_sweep.num_algos) {
+        MPI_T_cvar_write(omb_sweep.cvar_handle, &omb_sweep.default_value);
+        MPI_CHECK(MPI_T_cvar_handle_free(&omb_sweep.cvar_handle));
+        if (MPI_COMM_NULL != omb_sweep.algo_comm) {
+            MPI_CHECK(MPI_Comm_free(&omb_sweep.algo_comm));
+        }
+        omb_sweep.num_algos = 0;
+    }
+    if (omb_sweep.mpit_initialized) {
+        MPI_CHECK(MPI_T_finalize());
+        omb_sweep.mpit_initialized = 0;
+    }
+    free(omb_sweep.row_nprocs);
+    free(omb_sweep.row_sizes);
+    free(omb_sweep.row_latency);
+    omb_sweep.num_rows = 0;
+}
+
+/*
+ * Clock synchronization. Rank 0 of the communicator is the reference: every
+ * other rank in turn runs OMB_CLOCK_SYNC_PINGS ping-pongs with it and keeps
+ * the offset seen by the fastest one. Each call adds a point to a least
+ * squares fit of the offset against local time, so from the second call on
+ * the drift between the clocks is corrected as well.
+ */
+static struct omb_clock_t {
+    int num_points;
+    double t_first;
+    double sum_x;
+    double sum_y;
+    double sum_xx;
+    double sum_xy;
+    double offset;
+    double drift;
+    double error;
+} omb_clock;
+
+void omb_clock_sync(MPI_Comm comm)
+{
+    int rank = 0, comm_size = 0, peer = 0, itr = 0;
+    double t_send = 0.0, t_recv = 0.0, t_root = 0.0, best_rtt = -1;
+    double x = 0.0, y = 0.0, denom = 0.0;
+
+    MPI_CHECK(MPI_Comm_rank(comm, &rank));
+    MPI_CHECK(MPI_Comm_size(comm, &comm_size));
+    for (peer = 1; peer < comm_size; peer++) {
+        for (itr = 0; itr < OMB_CLOCK_SYNC_PINGS; itr++) {
+            if (0 == rank) {
+                MPI_CHECK(MPI_Recv(&t_root, 1, MPI_DOUBLE, peer,
+                                   OMB_CLOCK_SYNC_TAG, comm,
+                                   MPI_STATUS_IGNORE));
+                t_root = MPI_Wtime();
+                MPI_CHECK(MPI_Send(&t_root, 1, MPI_DOUBLE, peer,
+                                   OMB_CLOCK_SYNC_TAG, comm));
+            } else if (peer == rank) {
+                t_send = MPI_Wtime();
+                MPI_CHECK(MPI_Send(&t_send, 1, MPI_DOUBLE, 0,
+                                   OMB_CLOCK_SYNC_TAG, comm));
+                MPI_CHECK(MPI_Recv(&t_root, 1, MPI_DOUBLE, 0,
+                                   OMB_CLOCK_SYNC_TAG, comm,
+                                   MPI_STATUS_IGNORE));
+                t_recv = MPI_Wtime();
+                if (0 > best_rtt || t_recv - t_send < best_rtt) {
+                    best_rtt = t_recv - t_send;
+                    x = (t_send + t_recv) / 2;
+                    y = x - t_root;
+                }
+            }
+        }
+    }
+    if (0 == rank) {
+        return;
+    }
+
+    if (0 == omb_clock.num_points) {
+        omb_clock.t_first = x;
+    }
+    x -= omb_clock.t_first;
+    omb_clock.num_points++;
+    omb_clock.sum_x += x;
+    omb_clock.sum_y += y;
+    omb_clock.sum_xx += x * x;
+    omb_clock.sum_xy += x * y;
+    omb_clock.error = best_rtt / 2;
+    denom = omb_clock.num_points * omb_clock.sum_xx -
+            omb_clock.sum_x * omb_clock.sum_x;
+    if (1 == omb_clock.num_points || 0 >= denom) {
+        omb_clock.drift = 0;
+        omb_clock.offset = y;
+        return;
+    }
+    omb_clock.drift = (omb_clock.num_points * omb_clock.sum_xy -
+                       omb_clock.sum_x * omb_clock.sum_y) /
+                      denom;
+    omb_clock.offset =
+        (omb_clock.sum_y - omb_clock.drift * omb_clock.sum_x) /
+        omb_clock.num_points;
+}
+
+double omb_clock_global(double t_local)
+{
+    return t_local - omb_clock.offset -
+           omb_clock.drift * (t_local - omb_clock.t_first);
+}
+
+double omb_clock_local(double t_global)
+{
+    return (t_global + omb_clock.offset - omb_clock.drift * omb_clock.t_first) /
+           (1 - omb_clock.drift);
+}
+
+/*
+ * Synchronized start. The warm-up iterations run as usual. Before the first
+ * timed iteration the clocks are synchronized and rank 0 picks a common
+ * start time and a window longer than the slowest warm-up iteration,
+ * counted from one start to the next so that it covers the benchmark's
+ * barrier too. Timed iteration i then starts on every rank at start + i *
+ * window of the common time base. The time a rank reports is its completion
+ * time after that common start, and the collective latency is the
+ * completion time of the last rank. An iteration that some rank reaches
+ * after its start time is left out of the collective latency.
+ */
+static struct omb_sync_start_t {
+    double first_start;
+    double window;
+    double warmup_max;
+    double warmup_last;
+    double clock_error;
+    int curr_late;
+    int num_alloc;
+    double *results;
+    int num_rows;
+    int *row_nprocs;
+    int *row_columns;
+    int *row_sizes;
+    double *row_latency;
+    double *row_window;
+    int *row_late;
+} omb_sync_start;
+
+double omb_sync_start_wait(MPI_Comm comm, int itr)
+{
+    int rank = 0;
+    double local[2], global[2], schedule[2];
+    double start = MPI_Wtime();
+    struct timespec pause = {0, OMB_IDLE_SLEEP_NS};
+
+    if (!options.omb_sync_start) {
+        return start;
+    }
+    if (itr < options.skip) {
+        /* The first warm-up iteration pays for connection setup */
+        if (1 < itr) {
+            omb_sync_start.warmup_max = MAX(omb_sync_start.warmup_max,
+                                            start - omb_sync_start.warmup_last);
+        }
+        omb_sync_start.warmup_last = start;
+        return start;
+    }
+    if (itr == options.skip) {
+        MPI_CHECK(MPI_Comm_rank(comm, &rank));
+        omb_clock_sync(comm);
+        local[0] = omb_sync_start.warmup_max;
+        local[1] = omb_clock.error;
+        MPI_CHECK(MPI_Allreduce(local, global, 2, MPI_DOUBLE, MPI_MAX, comm));
+        if (0 == rank) {
+            if (0 < options.omb_sync_window) {
+                schedule[1] = options.omb_sync_window * 1e-6;
+            } else if (0 < global[0]) {
+                schedule[1] =
+                    OMB_SYNC_START_FACTOR * (global[0] + 2 * global[1]);
+            } else {
+                schedule[1] = OMB_SYNC_START_DEFAULT_WINDOW;
+            }
+            schedule[0] = omb_clock_global(MPI_Wtime()) +
+                          MAX(schedule[1], OMB_SYNC_START_LEAD);
+        }
+        MPI_CHECK(MPI_Bcast(schedule, 2, MPI_DOUBLE, 0, comm));
+        omb_sync_start.first_start = schedule[0];
+        omb_sync_start.window = schedule[1];
+        /* The table covers every sweep pass, so keep the worst error */
+        omb_sync_start.clock_error =
+            MAX(omb_sync_start.clock_error, global[1]);
+        omb_sync_start.warmup_max = 0;
+        if (omb_sync_start.num_alloc < options.iterations) {
+            omb_sync_start.results =
+                realloc(omb_sync_start.results,
+                        2 * options.iterations * sizeof(double));
+            OMB_CHECK_NULL_AND_EXIT(omb_sync_start.results,
+                                    "Unable to allocate memory");
+            omb_sync_start.num_alloc = options.iterations;
+        }
+    }
+
+    start = omb_clock_local(omb_sync_start.first_start +
+                            (itr - options.skip) * omb_sync_start.window);
+    omb_sync_start.curr_late = (MPI_Wtime() > start);
+    /* Sleep through most of a long wait, then spin for an exact start */
+    while (start - MPI_Wtime() > OMB_SYNC_START_SPIN) {
+        nanosleep(&pause, NULL);
+    }
+    while (MPI_Wtime() < start) {
+    }
+    return start;
+}
+
+void omb_sync_start_end(int itr, double t_start, double t_stop)
+{
+    int idx = itr - options.skip;
+
+    if (!options.omb_sync_start || itr < options.skip) {
+        return;
+    }
+    omb_sync_start.results[2 * idx] = t_stop - t_start;
+    omb_sync_start.results[2 * idx + 1] = omb_sync_start.curr_late;
+}
+
+void omb_sync_start_record(MPI_Comm comm, int size)
+{
+    int rank = 0, nprocs = 0, itr = 0, row = 0, num_late = 0;
+    double *merged = NULL, sum = 0.0;
+
+    if (!options.omb_sync_start) {
+        return;
+    }
+    MPI_CHECK(MPI_Comm_rank(comm, &rank));
+    MPI_CHECK(MPI_Comm_size(comm, &nprocs));
+    if (0 == rank) {
+        merged = malloc(2 * options.iterations * sizeof(double));
+        OMB_CHECK_NULL_AND_EXIT(merged, "Unable to allocate memory");
+    }
+    MPI_CHECK(MPI_Reduce(omb_sync_start.results, merged,
+                         2 * options.iterations, MPI_DOUBLE, MPI_MAX, 0,
+                         comm));
+    if (0 != rank) {
+        return;
+    }
+    for (itr = 0; itr < options.iterations; itr++) {
+        if (0 < merged[2 * itr + 1]) {
+            num_late++;
+        } else {
+            sum += merged[2 * itr];
+        }
+    }
+    free(merged);
+
+    row = omb_sync_start.num_rows++;
+    omb_sync_start.row_nprocs =
+        realloc(omb_sync_start.row_nprocs, (row + 1) * sizeof(int));
+    omb_sync_start.row_columns =
+        realloc(omb_sync_start.row_columns, (row + 1) * sizeof(int));
+    omb_sync_start.row_sizes =
+        realloc(omb_sync_start.row_sizes, (row + 1) * sizeof(int));
+    omb_sync_start.row_latency =
+        realloc(omb_sync_start.row_latency, (row + 1) * sizeof(double));
+    omb_sync_start.row_window =
+        realloc(omb_sync_start.row_window, (row + 1) * sizeof(double));
+    omb_sync_start.row_late =
+        realloc(omb_sync_start.row_late, (row + 1) * sizeof(int));
+    OMB_CHECK_NULL_AND_EXIT(omb_sync_start.row_nprocs,
+                            "Unable to allocate memory");
+    OMB_CHECK_NULL_AND_EXIT(omb_sync_start.row_columns,
+                            "Unable to allocate memory");
+    OMB_CHECK_NULL_AND_EXIT(omb_sync_start.row_sizes,
+                            "Unable to allocate memory");
+    OMB_CHECK_NULL_AND_EXIT(omb_sync_start.row_latency,
+                            "Unable to allocate memory");
+    OMB_CHECK_NULL_AND_EXIT(omb_sync_start.row_window,
+                            "Unable to allocate memory");
+    OMB_CHECK_NULL_AND_EXIT(omb_sync_start.row_late,
+                            "Unable to allocate memory");
+    omb_sync_start.row_nprocs[row] = nprocs;
+    omb_sync_start.row_columns[row] = omb_sweep.curr_column;
+    omb_sync_start.row_sizes[row] = size;
+    omb_sync_start.row_latency[row] =
+        (num_late < options.iterations) ?
+            sum * 1e6 / (options.iterations - num_late) :
+            -1;
+    omb_sync_start.row_window[row] = omb_sync_start.window * 1e6;
+    omb_sync_start.row_late[row] = num_late;
+}
+
+void omb_sync_start_finalize(int rank)
+{
+    int row = 0, num_late = 0;
+    int by_pass = 0 < omb_sweep.num_algos || options.omb_cold_cache;
+    char name[OMB_ALGO_NAME_MAX_LEN + 8];
+
+    if (0 == rank && 0 < omb_sync_start.num_rows) {
+        fprintf(stdout,
+                "\n# Synchronized start: collective latency is the"
+                " completion of the last rank\n"
+                "# after the common start, clock offset error up to"
+                " %.2f us\n",
+                omb_sync_start.clock_error * 1e6);
+        if (0 < options.omb_num_comm_sizes) {
+            fprintf(stdout, "%-*s%-*s", 10, "# Procs", 10, "Size");
+        } else {
+            fprintf(stdout, "%-*s", 10, "# Size");
+        }
+        fprintf(stdout, "%*s%*s%*s%s\n", FIELD_WIDTH, "Coll Latency(us)",
+                FIELD_WIDTH, "Window(us)", FIELD_WIDTH, "Late Iterations",
+                by_pass ? "  Pass" : "");
+        for (row = 0; row < omb_sync_start.num_rows; row++) {
+            if (0 < options.omb_num_comm_sizes) {
+                fprintf(stdout, "%-*d", 10, omb_sync_start.row_nprocs[row]);
+            }
+            fprintf(stdout, "%-*d", 10, omb_sync_start.row_sizes[row]);
+            if (0 > omb_sync_start.row_latency[row]) {
+                fprintf(stdout, "%*s", FIELD_WIDTH, "-");
+            } else {
+                fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                        omb_sync_start.row_latency[row]);
+            }
+            fprintf(stdout, "%*.*f%*d", FIELD_WIDTH, FLOAT_PRECISION,
+                    omb_sync_start.row_window[row], FIELD_WIDTH,
+                    omb_sync_start.row_late[row]);
+            if (by_pass) {
+                omb_sweep_pass_name(omb_sync_start.row_columns[row], name,
+                                    sizeof(name));
+                fprintf(stdout, "  %s", name);
+            }
+            fprintf(stdout, "\n");
+            num_late += omb_sync_start.row_late[row];
+        }
+        if (0 < num_late) {
+            fprintf(stdout, "# Late iterations start behind schedule, pass a"
+                            " longer window with -y<us>\n");
+        }
+        fflush(stdout);
+    }
+    free(omb_sync_start.results);
+    free(omb_sync_start.row_nprocs);
+    free(omb_sync_start.row_columns);
+    free(omb_sync_start.row_sizes);
+    free(omb_sync_start.row_latency);
+    free(omb_sync_start.row_window);
+    free(omb_sync_start.row_late);
+    omb_sync_start.num_rows = 0;
+}
+
+/*
+ * Adaptive Message Sizes
+ *
+ * The power of two sweep runs first. Every point is turned into a time per
+ * message, the latency itself or the size over the bandwidth, which is
+ * linear in the size while the MPI library keeps one protocol. For each
+ * three consecutive sizes the line through the first two predicts the time
+ * of the third, and a time above the line by more than the threshold marks
+ * a switch point between the last two; past a switch point the slope before
+ * it is kept. A time below the line is a cheaper path, cache or noise, and
+ * not a protocol switch. Every marked interval is then bisected: a midpoint
+ * closer to the line shifted onto the upper end than to the lower line moves
+ * the upper end down, otherwise the lower end moves up, until the interval
+ * is narrower than OMB_ADAPTIVE_RESOLUTION of its size. Both ends are
+ * measured once more and the faster time of each kept, so that a slow
+ * outlier in the sweep is not taken for a step. Rank 0 decides the sizes and
+ * broadcasts them to the peer.
+ */
+static struct omb_adaptive_t {
+    int saved;
+    int iterations;
+    int skip;
+    enum omb_adaptive_state_t state;
+    int num_points;
+    int sizes[OMB_ADAPTIVE_MAX_POINTS];
+    double times[OMB_ADAPTIVE_MAX_POINTS];
+    int next_point;
+    int carry_point;
+    double carry_slope;
+    int lo;
+    int hi;
+    double t_lo;
+    double t_hi;
+    double slope;
+    int num_switches;
+    int sw_lo[OMB_ADAPTIVE_MAX_SWITCHES];
+    int sw_hi[OMB_ADAPTIVE_MAX_SWITCHES];
+    double sw_t_lo[OMB_ADAPTIVE_MAX_SWITCHES];
+    double sw_t_hi[OMB_ADAPTIVE_MAX_SWITCHES];
+    double sw_jump[OMB_ADAPTIVE_MAX_SWITCHES];
+} omb_adaptive;
+
+/* Relative step up from the line, negative when the time falls below it */
+static double omb_adaptive_jump(int lo, double t_lo, int hi, double t_hi,
+                                double slope)
+{
+    double pred = t_lo + slope * (hi - lo);
+
+    return (t_hi - pred) / fmax(t_hi, pred);
+}
+
+static int omb_adaptive_converged()
+{
+    int width = omb_adaptive.hi / OMB_ADAPTIVE_RESOLUTION;
+
+    return omb_adaptive.hi - omb_adaptive.lo <=
+           (width > OMB_ADAPTIVE_ALIGN ? width : OMB_ADAPTIVE_ALIGN);
+}
+
+static int omb_adaptive_midpoint()
+{
+    int mid = omb_adaptive.lo + (omb_adaptive.hi - omb_adaptive.lo) / 2;
+
+    if (mid - mid % OMB_ADAPTIVE_ALIGN > omb_adaptive.lo) {
+        mid -= mid % OMB_ADAPTIVE_ALIGN;
+    }
+    return mid;
+}
+
+/*
+ * Keeps a bisected interval only if the step is still there once it is
+ * narrow, a bend in the slope or noise in the sweep has none. The interval
+ * is too narrow for the slope to matter.
+ */
+static void omb_adaptive_add_switch()
+{
+    int sw = omb_adaptive.num_switches;
+    double jump = omb_adaptive_jump(omb_adaptive.lo, omb_adaptive.t_lo,
+                                    omb_adaptive.hi, omb_adaptive.t_hi, 0);
+
+    if (OMB_ADAPTIVE_MAX_SWITCHES == sw ||
+        jump * 100 <= options.omb_adaptive_threshold) {
+        return;
+    }
+    omb_adaptive.sw_lo[sw] = omb_adaptive.lo;
+    omb_adaptive.sw_hi[sw] = omb_adaptive.hi;
+    omb_adaptive.sw_t_lo[sw] = omb_adaptive.t_lo;
+    omb_adaptive.sw_t_hi[sw] = omb_adaptive.t_hi;
+    omb_adaptive.sw_jump[sw] = jump;
+    omb_adaptive.num_switches++;
+}
+
+/* Finds the next interval of the power of two sweep to bisect */
+static int omb_adaptive_scan()
+{
+    int a = 0, m = 0, b = 0;
+    double slope = 0, jump = 0;
+
+    for (; omb_adaptive.next_point < omb_adaptive.num_points;
+         omb_adaptive.next_point++) {
+        b = omb_adaptive.next_point;
+        m = b - 1;
+        a = b - 2;
+        if (omb_adaptive.carry_point == b) {
+            slope = omb_adaptive.carry_slope;
+        } else {
+            slope = (omb_adaptive.times[m] - omb_adaptive.times[a]) /
+                    (omb_adaptive.sizes[m] - omb_adaptive.sizes[a]);
+            slope = fmax(slope, 0);
+        }
+        jump = omb_adaptive_jump(omb_adaptive.sizes[m], omb_adaptive.times[m],
+                                 omb_adaptive.sizes[b], omb_adaptive.times[b],
+                                 slope);
+        if (jump * 100 <= options.omb_adaptive_threshold) {
+            continue;
+        }
+        /* The line through a switch point predicts nothing after it */
+        omb_adaptive.carry_point = b + 1;
+        omb_adaptive.carry_slope = slope;
+        omb_adaptive.next_point++;
+        omb_adaptive.lo = omb_adaptive.sizes[m];
+        omb_adaptive.hi = omb_adaptive.sizes[b];
+        omb_adaptive.t_lo = omb_adaptive.times[m];
+        omb_adaptive.t_hi = omb_adaptive.times[b];
+        omb_adaptive.slope = slope;
+        if (omb_adaptive_converged()) {
+            omb_adaptive.state = OMB_ADAPTIVE_CONFIRM_LO;
+            return omb_adaptive.lo;
+        }
+        omb_adaptive.state = OMB_ADAPTIVE_BISECT;
+        return omb_adaptive_midpoint();
+    }
+    omb_adaptive.state = OMB_ADAPTIVE_DONE;
+    return options.max_message_size + 1;
+}
+
+static int omb_adaptive_step(int size, double value)
+{
+    double t_size = 0, pred_lo = 0, pred_hi = 0;
+
+    if (0 >= value || (BW == options.subtype && 0 == size)) {
+        t_size = -1;
+    } else {
+        t_size = (BW == options.subtype) ? size / value : value;
+    }
+    if (OMB_ADAPTIVE_SWEEP == omb_adaptive.state) {
+        if (0 < t_size && OMB_ADAPTIVE_MAX_POINTS > omb_adaptive.num_points) {
+            omb_adaptive.sizes[omb_adaptive.num_points] = size;
+            omb_adaptive.times[omb_adaptive.num_points] = t_size;
+            omb_adaptive.num_points++;
+        }
+        if (0 == size) {
+            return 1;
+        }
+        if (size <= options.max_message_size / 2) {
+            return size * 2;
+        }
+        omb_adaptive.next_point = 2;
+        return omb_adaptive_scan();
+    }
+    if (0 > t_size) {
+        return omb_adaptive_scan();
+    }
+    switch (omb_adaptive.state) {
+        case OMB_ADAPTIVE_BISECT:
+            pred_lo = omb_adaptive.t_lo +
+                      omb_adaptive.slope * (size - omb_adaptive.lo);
+            pred_hi = omb_adaptive.t_hi -
+                      omb_adaptive.slope * (omb_adaptive.hi - size);
+            if (fabs(t_size - pred_hi) < fabs(t_size - pred_lo)) {
+                omb_adaptive.hi = size;
+                omb_adaptive.t_hi = t_size;
+            } else {
+                omb_adaptive.lo = size;
+                omb_adaptive.t_lo = t_size;
+            }
+            if (!omb_adaptive_converged()) {
+                return omb_adaptive_midpoint();
+            }
+            omb_adaptive.state = OMB_ADAPTIVE_CONFIRM_LO;
+            return omb_adaptive.lo;
+        case OMB_ADAPTIVE_CONFIRM_LO:
+            omb_adaptive.t_lo = fmin(omb_adaptive.t_lo, t_size);
+            omb_adaptive.state = OMB_ADAPTIVE_CONFIRM_HI;
+            return omb_adaptive.hi;
+        case OMB_ADAPTIVE_CONFIRM_HI:
+            omb_adaptive.t_hi = fmin(omb_adaptive.t_hi, t_size);
+            omb_adaptive_add_switch();
+            return omb_adaptive_scan();
+        default:
+            return options.max_message_size + 1;
+    }
+}
+
+int omb_adaptive_first(double *value)
+{
+    if (!omb_adaptive.saved) {
+        omb_adaptive.iterations = options.iterations;
+        omb_adaptive.skip = options.skip;
+        omb_adaptive.saved = 1;
+    }
+    omb_adaptive.state = OMB_ADAPTIVE_SWEEP;
+    omb_adaptive.num_points = 0;
+    omb_adaptive.num_switches = 0;
+    omb_adaptive.carry_point = -1;
+    *value = 0;
+    return options.min_message_size;
+}
+
+int omb_adaptive_next(MPI_Comm comm, int size, double *value)
+{
+    int rank = 0, next = 0;
+
+    if (!options.omb_adaptive) {
+        return size ? size * 2 : 1;
+    }
+    MPI_CHECK(MPI_Comm_rank(comm, &rank));
+    if (0 == rank) {
+        next = omb_adaptive_step(size, *value);
+    }
+    MPI_CHECK(MPI_Bcast(&next, 1, MPI_INT, 0, comm));
+    if (next <= LARGE_MESSAGE_SIZE) {
+        options.iterations = omb_adaptive.iterations;
+        options.skip = omb_adaptive.skip;
+    }
+    *value = 0;
+    return next;
+}
+
+void omb_adaptive_finalize(int rank)
+{
+    int sw = 0;
+    double v_lo = 0, v_hi = 0;
+    const char *unit = (BW == options.subtype) ? "BW(MB/s)" : "Lat(us)";
+    char label_lo[OMB_ADAPTIVE_LABEL_LEN], label_hi[OMB_ADAPTIVE_LABEL_LEN];
+
+    if (!options.omb_adaptive || 0 != rank) {
+        return;
+    }
+    fprintf(stdout,
+            "\n# Protocol switch points: time per message above the"
+            " linear trend by more than %.2f%%\n",
+            options.omb_adaptive_threshold);
+    if (0 == omb_adaptive.num_switches) {
+        fprintf(stdout, "# None found\n");
+        fflush(stdout);
+        return;
+    }
+    snprintf(label_lo, sizeof(label_lo), "Below %s", unit);
+    snprintf(label_hi, sizeof(label_hi), "Above %s", unit);
+    fprintf(stdout, "%-*s%*s%*s%*s%*s\n", 10, "# Below", FIELD_WIDTH, "Above",
+            FIELD_WIDTH, label_lo, FIELD_WIDTH, label_hi, FIELD_WIDTH,
+            "Change(%)");
+    for (sw = 0; sw < omb_adaptive.num_switches; sw++) {
+        if (BW == options.subtype) {
+            v_lo = omb_adaptive.sw_lo[sw] / omb_adaptive.sw_t_lo[sw];
+            v_hi = omb_adaptive.sw_hi[sw] / omb_adaptive.sw_t_hi[sw];
+        } else {
+            v_lo = omb_adaptive.sw_t_lo[sw];
+            v_hi = omb_adaptive.sw_t_hi[sw];
+        }
+        fprintf(stdout, "%-*d%*d%*.*f%*.*f%*.*f\n", 10, omb_adaptive.sw_lo[sw],
+                FIELD_WIDTH, omb_adaptive.sw_hi[sw], FIELD_WIDTH,
+                FLOAT_PRECISION, v_lo, FIELD_WIDTH, FLOAT_PRECISION, v_hi,
+                FIELD_WIDTH, FLOAT_PRECISION, omb_adaptive.sw_jump[sw] * 100);
+    }
+    fflush(stdout);
+}
+
+/*
+ * Model Fitting
+ *
+ * Lines are fitted by least squares weighted with 1 / y^2, so that the
+ * relative error is minimized and the small sizes of a power of two sweep
+ * weigh as much as the large ones. Points with y <= 0 are left out.
+ */
+void omb_fit_line(const double *x, const double *y, int n, double *alpha,
+                  double *beta)
+{
+    int i = 0;
+    double w = 0, sw = 0, sx = 0, sy = 0, sxx = 0, sxy = 0, denom = 0;
+
+    for (i = 0; i < n; i++) {
+        if (0 >= y[i]) {
+            continue;
+        }
+        w = 1 / (y[i] * y[i]);
+        sw += w;
+        sx += w * x[i];
+        sy += w * y[i];
+        sxx += w * x[i] * x[i];
+        sxy += w * x[i] * y[i];
+    }
+    denom = sw * sxx - sx * sx;
+    if (0 >= denom) {
+        *beta = 0;
+        *alpha = (0 < sw) ? sy / sw : 0;
+        return;
+    }
+    *beta = (sw * sxy - sx * sy) / denom;
+    *alpha = (sy - *beta * sx) / sw;
+}
+
+static double omb_fit_error(const double *x, const double *y, int n,
+                            double alpha, double beta)
+{
+    int i = 0;
+    double error = 0;
+
+    for (i = 0; i < n; i++) {
+        if (0 < y[i]) {
+            error = fmax(error, fabs(alpha + beta * x[i] - y[i]) / y[i]);
+        }
+    }
+    return error;
+}
+
+/*
+ * Splits points sorted by x into regimes, each the longest run of points
+ * from where the previous one ends that a line fits within tolerance (a
+ * relative error). A regime has at least min_points points, so that two
+ * noisy neighbours cannot make a regime of their own: fewer points left at
+ * the end join the last regime. Regime r covers points first[r] to
+ * first[r + 1] - 1, first needs n + 1 entries and alpha and beta n.
+ * Returns the number of regimes.
+ */
+int omb_fit_regimes(const double *x, const double *y, int n, double tolerance,
+                    int min_points, int *first, double *alpha, double *beta)
+{
+    int num_regimes = 0, start = 0, end = 0;
+    double a = 0, b = 0;
+
+    min_points = MAX(min_points, 2);
+    while (start < n) {
+        end = MIN(start + min_points, n);
+        omb_fit_line(x + start, y + start, end - start, &a, &b);
+        while (end < n) {
+            double next_a = 0, next_b = 0;
+
+            omb_fit_line(x + start, y + start, end + 1 - start, &next_a,
+                         &next_b);
+            if (omb_fit_error(x + start, y + start, end + 1 - start, next_a,
+                              next_b) > tolerance) {
+                break;
+            }
+            a = next_a;
+            b = next_b;
+            end++;
+        }
+        if (end - start < min_points && 0 < num_regimes) {
+            num_regimes--;
+            start = first[num_regimes];
+            omb_fit_line(x + start, y + start, end - start, &a, &b);
+        }
+        first[num_regimes] = start;
+        alpha[num_regimes] = a;
+        beta[num_regimes] = b;
+        num_regimes++;
+        start = end;
+    }
+    first[num_regimes] = n;
+    return num_regimes;
+}
+
 int omb_ascending_cmp_double(const void *a, const void *b)
 {
     double v1 = *(const double *)a;
@@ -711,22 +2412,117 @@ int omb_ascending_cmp_double(const void *a, const void *b)
     }
 }
 
+static int omb_hist_index(double lat)
+{
+    uint64_t value = (lat > 0) ? (uint64_t)(lat * 1e3) : 0;
+    int shift = 0;
+
+    while ((value >> shift) >= OMB_HIST_SUB_BUCKETS) {
+        shift++;
+    }
+    if (shift > OMB_HIST_MAX_SHIFT) {
+        return OMB_HIST_NUM_BUCKETS - 1;
+    }
+    return shift * (OMB_HIST_SUB_BUCKETS / 2) + (int)(value >> shift);
+}
+
+/* Midpoint of a bucket, in us */
+static double omb_hist_value(int index)
+{
+    int shift = (index < OMB_HIST_SUB_BUCKETS) ?
+                    0 :
+                    index / (OMB_HIST_SUB_BUCKETS / 2) - 1;
+    uint64_t low = (uint64_t)(index - shift * (OMB_HIST_SUB_BUCKETS / 2))
+                   << shift;
+
+    return (low + ((1ULL << shift) - 1) / 2.0) / 1e3;
+}
+
+static void omb_hist_merge(void *in, void *inout, int *len,
+                           MPI_Datatype *datatype)
+{
+    struct omb_hist_t *src = in, *dst = inout;
+    int itr = 0, bucket = 0;
+
+    for (itr = 0; itr < *len; itr++) {
+        for (bucket = 0; bucket < OMB_HIST_NUM_BUCKETS; bucket++) {
+            dst[itr].counts[bucket] += src[itr].counts[bucket];
+        }
+        dst[itr].total += src[itr].total;
+        dst[itr].min = MIN(dst[itr].min, src[itr].min);
+        dst[itr].max = MAX(dst[itr].max, src[itr].max);
+    }
+}
+
+static double omb_hist_percentile(struct omb_hist_t *hist, double percentile)
+{
+    uint64_t target = (uint64_t)ceil(hist->total * percentile / 100);
+    uint64_t seen = 0;
+    int bucket = 0;
+
+    if (target >= hist->total) {
+        return hist->max;
+    }
+    for (bucket = 0; bucket < OMB_HIST_NUM_BUCKETS; bucket++) {
+        seen += hist->counts[bucket];
+        if (seen >= target && 0 < seen) {
+            return MIN(MAX(omb_hist_value(bucket), hist->min), hist->max);
+        }
+    }
+    return hist->max;
+}
+
+/*
+ * Tail latencies over every iteration of every rank. Each rank bins its own
+ * samples and the histograms are summed on rank 0 with a user reduction, so
+ * the message and the memory used do not grow with the iteration count.
+ */
 struct omb_stat_t omb_get_stats(double *lat_arr)
 {
-    int rank = 0, comm_size = 0;
-    double avg_lat_arr[options.iterations];
-    int i = 0;
+    int rank = 0, itr = 0, bucket = 0;
     struct omb_stat_t omb_stats;
+    struct omb_hist_t *hist = NULL, *merged = NULL;
+    MPI_Datatype hist_type;
+    MPI_Op hist_op;
 
     if (!options.omb_tail_lat) {
         return omb_stats;
     }
     OMB_CHECK_NULL_AND_EXIT(lat_arr, "Passed array is NULL");
     MPI_CHECK(MPI_Comm_rank(MPI_COMM_WORLD, &rank));
-    MPI_CHECK(MPI_Comm_size(MPI_COMM_WORLD, &comm_size));
-    MPI_CHECK(MPI_Reduce(lat_arr, avg_lat_arr, options.iterations, MPI_DOUBLE,
-                         MPI_SUM, 0, MPI_COMM_WORLD));
-    return omb_calculate_tail_lat(avg_lat_arr, rank, comm_size);
+    hist = calloc(2, sizeof(struct omb_hist_t));
+    OMB_CHECK_NULL_AND_EXIT(hist, "Unable to allocate memory");
+    merged = hist + 1;
+    hist->min = (0 < options.iterations) ? lat_arr[0] : 0;
+    hist->max = hist->min;
+    for (itr = 0; itr < options.iterations; itr++) {
+        bucket = omb_hist_index(lat_arr[itr]);
+        hist->counts[bucket]++;
+        hist->min = MIN(hist->min, lat_arr[itr]);
+        hist->max = MAX(hist->max, lat_arr[itr]);
+    }
+    hist->total = options.iterations;
+
+    MPI_CHECK(MPI_Type_contiguous(sizeof(struct omb_hist_t), MPI_BYTE,
+                                  &hist_type));
+    MPI_CHECK(MPI_Type_commit(&hist_type));
+    MPI_CHECK(MPI_Op_create(omb_hist_merge, 1, &hist_op));
+    MPI_CHECK(MPI_Reduce(hist, merged, 1, hist_type, hist_op, 0,
+                         MPI_COMM_WORLD));
+    MPI_CHECK(MPI_Op_free(&hist_op));
+    MPI_CHECK(MPI_Type_free(&hist_type));
+
+    if (0 == rank) {
+        itr = 0;
+        while (itr < OMB_STAT_MAX_NUM &&
+               -1 != options.omb_stat_percentiles[itr]) {
+            omb_stats.res_arr[itr] =
+                omb_hist_percentile(merged, options.omb_stat_percentiles[itr]);
+            itr++;
+        }
+    }
+    free(hist);
+    return omb_stats;
 }
 
 struct omb_stat_t omb_calculate_tail_lat(double *avg_lat_arr, int rank,
@@ -743,9 +2539,10 @@ struct omb_stat_t omb_calculate_tail_lat(double *avg_lat_arr, int rank,
     itr = 0;
     while (itr < OMB_STAT_MAX_NUM && -1 != options.omb_stat_percentiles[itr]) {
         omb_stats.res_arr[itr] =
-            avg_lat_arr[(int)round(options.iterations *
-                                   options.omb_stat_percentiles[itr] / 100) -
-                        1] /
+            avg_lat_arr[MAX(0, (int)ceil(options.iterations *
+                                         options.omb_stat_percentiles[itr] /
+                                         100) -
+                                   1)] /
             comm_size;
         itr++;
     }
@@ -921,6 +2718,7 @@ void print_stats(int rank, int size, double avg_time, double min_time,
         fprintf(stdout, "\n");
     }
     fflush(stdout);
+    omb_sweep_record(size, avg_time);
 }
 
 void print_stats_validate(int rank, int size, double avg_time, double min_time,
@@ -959,6 +2757,864 @@ void print_stats_validate(int rank, int size, double avg_time, double min_time,
         fprintf(stdout, "\n");
     }
     fflush(stdout);
+    omb_sweep_record(size, avg_time);
+}
+
+/*
+ * User-level reference collectives, selected with -U. They are built on
+ * point to point calls only, so that an algorithm of the MPI library can be
+ * told apart from its implementation. Blocks are addressed by the extent of
+ * the datatype, reductions go through MPI_Reduce_local and assume a
+ * commutative operation. Ranks are renumbered relative to the root
+ * (virtual ranks) for the rooted collectives.
+ */
+
+/* Typed copy of a local buffer, the signatures must match */
+static void omb_ref_copy(const void *src, int src_count, MPI_Datatype src_type,
+                         void *dst, int dst_count, MPI_Datatype dst_type)
+{
+    MPI_CHECK(MPI_Sendrecv(src, src_count, src_type, 0, OMB_REF_TAG, dst,
+                           dst_count, dst_type, 0, OMB_REF_TAG, MPI_COMM_SELF,
+                           MPI_STATUS_IGNORE));
+}
+
+static MPI_Aint omb_ref_extent(MPI_Datatype datatype)
+{
+    MPI_Aint lb = 0, extent = 0;
+
+    MPI_CHECK(MPI_Type_get_extent(datatype, &lb, &extent));
+    return extent;
+}
+
+static void *omb_ref_alloc(int count, MPI_Datatype datatype)
+{
+    void *buf = malloc(MAX(count, 1) * omb_ref_extent(datatype));
+
+    OMB_CHECK_NULL_AND_EXIT(buf, "Unable to allocate memory");
+    return buf;
+}
+
+/* Elements per segment, count itself when the message is not segmented */
+static int omb_ref_seg_count(int count, MPI_Datatype datatype,
+                             int default_segsize)
+{
+    int type_size = 0;
+    int segsize = (OMB_REF_SEGSIZE_AUTO == options.omb_ref_segsize) ?
+                      default_segsize :
+                      options.omb_ref_segsize;
+
+    MPI_CHECK(MPI_Type_size(datatype, &type_size));
+    if (0 >= segsize || 0 == type_size || segsize / type_size >= count) {
+        return MAX(count, 1);
+    }
+    return MAX(segsize / type_size, 1);
+}
+
+/*
+ * Pipelined bcast along a tree: each segment is received from the parent
+ * (none at the root) and sent on to the children while the next one
+ * arrives. At most two segments per child are in flight.
+ */
+static void omb_ref_tree_bcast(char *buf, int count, MPI_Datatype datatype,
+                               int parent, const int *children,
+                               int num_children, MPI_Comm comm)
+{
+    int seg_count = omb_ref_seg_count(count, datatype, OMB_REF_BCAST_SEGSIZE);
+    int num_segs = (count + seg_count - 1) / seg_count;
+    int seg = 0, child = 0, offset = 0;
+    MPI_Aint extent = omb_ref_extent(datatype);
+    MPI_Request recv_request = MPI_REQUEST_NULL;
+    MPI_Request *send_requests = NULL, *requests = NULL;
+
+    send_requests = malloc(2 * MAX(num_children, 1) * sizeof(MPI_Request));
+    OMB_CHECK_NULL_AND_EXIT(send_requests, "Unable to allocate memory");
+    for (child = 0; child < 2 * num_children; child++) {
+        send_requests[child] = MPI_REQUEST_NULL;
+    }
+    if (0 < num_segs && 0 <= parent) {
+        MPI_CHECK(MPI_Irecv(buf, MIN(seg_count, count), datatype, parent,
+                            OMB_REF_TAG, comm, &recv_request));
+    }
+    for (seg = 0; seg < num_segs; seg++) {
+        offset = seg * seg_count;
+        if (0 <= parent) {
+            MPI_CHECK(MPI_Wait(&recv_request, MPI_STATUS_IGNORE));
+            if (seg + 1 < num_segs) {
+                MPI_CHECK(MPI_Irecv(
+                    buf + (offset + seg_count) * extent,
+                    MIN(seg_count, count - offset - seg_count), datatype,
+                    parent, OMB_REF_TAG, comm, &recv_request));
+            }
+        }
+        requests = send_requests + (seg % 2) * num_children;
+        MPI_CHECK(MPI_Waitall(num_children, requests, MPI_STATUSES_IGNORE));
+        for (child = 0; child < num_children; child++) {
+            MPI_CHECK(MPI_Isend(buf + offset * extent,
+                                MIN(seg_count, count - offset), datatype,
+                                children[child], OMB_REF_TAG, comm,
+                                &requests[child]));
+        }
+    }
+    MPI_CHECK(
+        MPI_Waitall(2 * num_children, send_requests, MPI_STATUSES_IGNORE));
+    free(send_requests);
+}
+
+/* Binomial tree on virtual ranks, larger subtrees are served first */
+static void omb_ref_bcast_binomial(char *buf, int count, MPI_Datatype datatype,
+                                   int root, MPI_Comm comm)
+{
+    int rank = 0, size = 0, vrank = 0, mask = 1, parent = -1;
+    int children[32], num_children = 0;
+
+    MPI_CHECK(MPI_Comm_rank(comm, &rank));
+    MPI_CHECK(MPI_Comm_size(comm, &size));
+    vrank = (rank - root + size) % size;
+    if (0 == vrank) {
+        while (mask < size) {
+            mask <<= 1;
+        }
+    } else {
+        mask = vrank & -vrank;
+        parent = (vrank - mask + root) % size;
+    }
+    for (mask >>= 1; mask > 0; mask >>= 1) {
+        if (vrank + mask < size) {
+            children[num_children++] = (vrank + mask + root) % size;
+        }
+    }
+    omb_ref_tree_bcast(buf, count, datatype, parent, children, num_children,
+                       comm);
+}
+
+static void omb_ref_bcast_chain(char *buf, int count, MPI_Datatype datatype,
+                                int root, MPI_Comm comm)
+{
+    int rank = 0, size = 0, vrank = 0, parent = -1, child = 0;
+
+    MPI_CHECK(MPI_Comm_rank(comm, &rank));
+    MPI_CHECK(MPI_Comm_size(comm, &size));
+    vrank = (rank - root + size) % size;
+    if (0 < vrank) {
+        parent = (rank - 1 + size) % size;
+    }
+    child = (rank + 1) % size;
+    omb_ref_tree_bcast(buf, count, datatype, parent, &child,
+                       (vrank + 1 < size) ? 1 : 0, comm);
+}
+
+/* Depth of a node of the binary tree laid out as a heap */
+static int omb_ref_heap_depth(int node)
+{
+    int depth = 0;
+
+    while ((2 << depth) - 1 <= node) {
+        depth++;
+    }
+    return depth;
+}
+
+/*
+ * Split binary tree: the first half of the message is pipelined down the
+ * left subtree of a binary tree, the second half down the right one, then
+ * every node swaps halves with the node at the same place in the other
+ * subtree. Left nodes without such a partner, on a partial last level, get
+ * the second half from the parent the missing partner would have had.
+ */
+static void omb_ref_bcast_split_binary(char *buf, int count,
+                                       MPI_Datatype datatype, int root,
+                                       MPI_Comm comm)
+{
+    int rank = 0, size = 0, vrank = 0, half = 0, other = 0, depth = 0;
+    int partner = 0, seg_count = 0, num_segs = 0, seg = 0, offset = 0;
+    int child = 0, children[2], num_children = 0;
+    int half_count[2], half_offset[2];
+    MPI_Aint extent = omb_ref_extent(datatype);
+    MPI_Request requests[2][2] = {{MPI_REQUEST_NULL, MPI_REQUEST_NULL},
+                                  {MPI_REQUEST_NULL, MPI_REQUEST_NULL}};
+
+    MPI_CHECK(MPI_Comm_rank(comm, &rank));
+    MPI_CHECK(MPI_Comm_size(comm, &size));
+    if (1 == size) {
+        return;
+    }
+    vrank = (rank - root + size) % size;
+    half_count[0] = (count + 1) / 2;
+    half_count[1] = count - half_count[0];
+    half_offset[0] = 0;
+    half_offset[1] = half_count[0];
+
+    if (0 == vrank) {
+        /* The root interleaves the segments of the two halves */
+        seg_count =
+            omb_ref_seg_count(half_count[0], datatype, OMB_REF_BCAST_SEGSIZE);
+        num_segs = (half_count[0] + seg_count - 1) / seg_count;
+        for (seg = 0; seg < num_segs; seg++) {
+            offset = seg * seg_count;
+            for (half = 0; half < 2; half++) {
+                if (half + 1 >= size || offset >= half_count[half]) {
+                    continue;
+                }
+                MPI_CHECK(MPI_Wait(&requests[half][seg % 2],
+                                   MPI_STATUS_IGNORE));
+                MPI_CHECK(MPI_Isend(
+                    buf + (half_offset[half] + offset) * extent,
+                    MIN(seg_count, half_count[half] - offset), datatype,
+                    (half + 1 + root) % size, OMB_REF_TAG, comm,
+                    &requests[half][seg % 2]));
+            }
+        }
+        MPI_CHECK(MPI_Waitall(4, &requests[0][0], MPI_STATUSES_IGNORE));
+    } else {
+        depth = omb_ref_heap_depth(vrank);
+        half = (vrank + 1 - (1 << depth) < (1 << (depth - 1))) ? 0 : 1;
+        for (child = 2 * vrank + 1; child <= 2 * vrank + 2; child++) {
+            if (child < size) {
+                children[num_children++] = (child + root) % size;
+            }
+        }
+        omb_ref_tree_bcast(buf + half_offset[half] * extent, half_count[half],
+                           datatype, ((vrank - 1) / 2 + root) % size, children,
+                           num_children, comm);
+
+        other = 1 - half;
+        partner = (0 == half) ? vrank + (1 << (depth - 1)) :
+                                vrank - (1 << (depth - 1));
+        if (partner < size) {
+            MPI_CHECK(MPI_Sendrecv(
+                buf + half_offset[half] * extent, half_count[half], datatype,
+                (partner + root) % size, OMB_REF_TAG,
+                buf + half_offset[other] * extent, half_count[other],
+                datatype, (partner + root) % size, OMB_REF_TAG, comm,
+                MPI_STATUS_IGNORE));
+        } else {
+            MPI_CHECK(MPI_Recv(buf + half_offset[other] * extent,
+                               half_count[other], datatype,
+                               ((partner - 1) / 2 + root) % size, OMB_REF_TAG,
+                               comm, MPI_STATUS_IGNORE));
+        }
+    }
+
+    /* The root and the right nodes feed the left nodes left unpaired */
+    if (0 != vrank && 1 != half) {
+        return;
+    }
+    for (child = (0 == vrank) ? 2 : 2 * vrank + 1; child <= 2 * vrank + 2;
+         child++) {
+        if (child < size) {
+            continue;
+        }
+        depth = omb_ref_heap_depth(child);
+        partner = child - (1 << (depth - 1));
+        if (partner < size) {
+            MPI_CHECK(MPI_Send(buf + half_offset[1] * extent, half_count[1],
+                               datatype, (partner + root) % size, OMB_REF_TAG,
+                               comm));
+        }
+    }
+}
+
+/*
+ * Binomial scatter: every node receives the blocks of its whole subtree,
+ * in virtual rank order, and passes the halves on. Blocks use the receive
+ * signature, the root reorders the send buffer into it.
+ */
+static void omb_ref_scatter_binomial(const char *sendbuf, int sendcount,
+                                     MPI_Datatype sendtype, char *recvbuf,
+                                     int recvcount, MPI_Datatype recvtype,
+                                     int root, MPI_Comm comm)
+{
+    int rank = 0, size = 0, vrank = 0, mask = 1, num_blocks = 0;
+    MPI_Aint block = recvcount * omb_ref_extent(recvtype);
+    MPI_Aint send_block = sendcount * omb_ref_extent(sendtype);
+    char *tmp = recvbuf;
+
+    MPI_CHECK(MPI_Comm_rank(comm, &rank));
+    MPI_CHECK(MPI_Comm_size(comm, &size));
+    vrank = (rank - root + size) % size;
+    if (0 == vrank) {
+        while (mask < size) {
+            mask <<= 1;
+        }
+        num_blocks = size;
+        tmp = omb_ref_alloc(size * recvcount, recvtype);
+        omb_ref_copy(sendbuf + root * send_block, (size - root) * sendcount,
+                     sendtype, tmp, (size - root) * recvcount, recvtype);
+        omb_ref_copy(sendbuf, root * sendcount, sendtype,
+                     tmp + (size - root) * block, root * recvcount, recvtype);
+    } else {
+        mask = vrank & -vrank;
+        num_blocks = MIN(mask, size - vrank);
+        if (1 < num_blocks) {
+            tmp = omb_ref_alloc(num_blocks * recvcount, recvtype);
+        }
+        MPI_CHECK(MPI_Recv(tmp, num_blocks * recvcount, recvtype,
+                           (vrank - mask + root) % size, OMB_REF_TAG, comm,
+                           MPI_STATUS_IGNORE));
+    }
+    for (mask >>= 1; mask > 0; mask >>= 1) {
+        if (vrank + mask < size) {
+            MPI_CHECK(MPI_Send(tmp + mask * block,
+                               MIN(mask, size - vrank - mask) * recvcount,
+                               recvtype, (vrank + mask + root) % size,
+                               OMB_REF_TAG, comm));
+        }
+    }
+    if (tmp != recvbuf) {
+        if (MPI_IN_PLACE != (void *)recvbuf) {
+            omb_ref_copy(tmp, recvcount, recvtype, recvbuf, recvcount,
+                         recvtype);
+        }
+        free(tmp);
+    }
+}
+
+/* Binomial gather, the mirror of the scatter with the send signature */
+static void omb_ref_gather_binomial(const char *sendbuf, int sendcount,
+                                    MPI_Datatype sendtype, char *recvbuf,
+                                    int recvcount, MPI_Datatype recvtype,
+                                    int root, MPI_Comm comm)
+{
+    int rank = 0, size = 0, vrank = 0, mask = 1, bit = 0, num_blocks = 0;
+    MPI_Aint block = sendcount * omb_ref_extent(sendtype);
+    MPI_Aint recv_block = 0;
+    char *tmp = (char *)sendbuf;
+
+    MPI_CHECK(MPI_Comm_rank(comm, &rank));
+    MPI_CHECK(MPI_Comm_size(comm, &size));
+    vrank = (rank - root + size) % size;
+    if (0 == vrank) {
+        while (mask < size) {
+            mask <<= 1;
+        }
+        num_blocks = size;
+        recv_block = recvcount * omb_ref_extent(recvtype);
+        tmp = omb_ref_alloc(size * sendcount, sendtype);
+        if (MPI_IN_PLACE == (void *)sendbuf) {
+            omb_ref_copy(recvbuf + root * recv_block, recvcount, recvtype, tmp,
+                         sendcount, sendtype);
+        } else {
+            omb_ref_copy(sendbuf, sendcount, sendtype, tmp, sendcount,
+                         sendtype);
+        }
+    } else {
+        mask = vrank & -vrank;
+        num_blocks = MIN(mask, size - vrank);
+        if (1 < num_blocks) {
+            tmp = omb_ref_alloc(num_blocks * sendcount, sendtype);
+            omb_ref_copy(sendbuf, sendcount, sendtype, tmp, sendcount,
+                         sendtype);
+        }
+    }
+    for (bit = 1; bit < mask; bit <<= 1) {
+        if (vrank + bit < size) {
+            MPI_CHECK(MPI_Recv(tmp + bit * block,
+                               MIN(bit, size - vrank - bit) * sendcount,
+                               sendtype, (vrank + bit + root) % size,
+                               OMB_REF_TAG, comm, MPI_STATUS_IGNORE));
+        }
+    }
+    if (0 != vrank) {
+        MPI_CHECK(MPI_Send(tmp, num_blocks * sendcount, sendtype,
+                           (vrank - mask + root) % size, OMB_REF_TAG, comm));
+    } else {
+        omb_ref_copy(tmp, (size - root) * sendcount, sendtype,
+                     recvbuf + root * recv_block, (size - root) * recvcount,
+                     recvtype);
+        omb_ref_copy(tmp + (size - root) * block, root * sendcount, sendtype,
+                     recvbuf, root * recvcount, recvtype);
+    }
+    if (tmp != sendbuf) {
+        free(tmp);
+    }
+}
+
+/* Linear scatter or gather: the root talks to every rank directly */
+static void omb_ref_linear(int scatter, const char *sendbuf, int sendcount,
+                           MPI_Datatype sendtype, char *recvbuf,
+                           int recvcount, MPI_Datatype recvtype, int root,
+                           MPI_Comm comm)
+{
+    int rank = 0, size = 0, itr = 0;
+    MPI_Aint send_block = sendcount * omb_ref_extent(sendtype);
+    MPI_Aint recv_block = recvcount * omb_ref_extent(recvtype);
+    MPI_Request *requests = NULL;
+
+    MPI_CHECK(MPI_Comm_rank(comm, &rank));
+    MPI_CHECK(MPI_Comm_size(comm, &size));
+    if (rank != root) {
+        if (scatter) {
+            MPI_CHECK(MPI_Recv(recvbuf, recvcount, recvtype, root,
+                               OMB_REF_TAG, comm, MPI_STATUS_IGNORE));
+        } else {
+            MPI_CHECK(MPI_Send(sendbuf, sendcount, sendtype, root,
+                               OMB_REF_TAG, comm));
+        }
+        return;
+    }
+    requests = malloc(size * sizeof(MPI_Request));
+    OMB_CHECK_NULL_AND_EXIT(requests, "Unable to allocate memory");
+    for (itr = 0; itr < size; itr++) {
+        requests[itr] = MPI_REQUEST_NULL;
+        if (itr == root) {
+            continue;
+        }
+        if (scatter) {
+            MPI_CHECK(MPI_Isend(sendbuf + itr * send_block, sendcount,
+                                sendtype, itr, OMB_REF_TAG, comm,
+                                &requests[itr]));
+        } else {
+            MPI_CHECK(MPI_Irecv(recvbuf + itr * recv_block, recvcount,
+                                recvtype, itr, OMB_REF_TAG, comm,
+                                &requests[itr]));
+        }
+    }
+    if (scatter && MPI_IN_PLACE != (void *)recvbuf) {
+        omb_ref_copy(sendbuf + root * send_block, sendcount, sendtype,
+                     recvbuf, recvcount, recvtype);
+    } else if (!scatter && MPI_IN_PLACE != (void *)sendbuf) {
+        omb_ref_copy(sendbuf, sendcount, sendtype,
+                     recvbuf + root * recv_block, recvcount, recvtype);
+    }
+    MPI_CHECK(MPI_Waitall(size, requests, MPI_STATUSES_IGNORE));
+    free(requests);
+}
+
+/*
+ * Power of two ranks for recursive doubling and Rabenseifner: of the first
+ * 2 * (size - pof2) ranks the even ones hand their vector to the next odd
+ * one and sit out, returns the new rank or -1.
+ */
+static int omb_ref_fold(char *buf, char *tmp, int count, MPI_Datatype datatype,
+                        MPI_Op op, int pof2, MPI_Comm comm)
+{
+    int rank = 0, size = 0, rem = 0;
+
+    MPI_CHECK(MPI_Comm_rank(comm, &rank));
+    MPI_CHECK(MPI_Comm_size(comm, &size));
+    rem = size - pof2;
+    if (rank >= 2 * rem) {
+        return rank - rem;
+    }
+    if (0 == rank % 2) {
+        MPI_CHECK(MPI_Send(buf, count, datatype, rank + 1, OMB_REF_TAG, comm));
+        return -1;
+    }
+    MPI_CHECK(MPI_Recv(tmp, count, datatype, rank - 1, OMB_REF_TAG, comm,
+                       MPI_STATUS_IGNORE));
+    MPI_CHECK(MPI_Reduce_local(tmp, buf, count, datatype, op));
+    return rank / 2;
+}
+
+/* Hands the result back to the ranks omb_ref_fold left out */
+static void omb_ref_unfold(char *buf, int count, MPI_Datatype datatype,
+                           int pof2, MPI_Comm comm)
+{
+    int rank = 0, size = 0;
+
+    MPI_CHECK(MPI_Comm_rank(comm, &rank));
+    MPI_CHECK(MPI_Comm_size(comm, &size));
+    if (rank >= 2 * (size - pof2)) {
+        return;
+    }
+    if (0 == rank % 2) {
+        MPI_CHECK(MPI_Recv(buf, count, datatype, rank + 1, OMB_REF_TAG, comm,
+                           MPI_STATUS_IGNORE));
+    } else {
+        MPI_CHECK(MPI_Send(buf, count, datatype, rank - 1, OMB_REF_TAG, comm));
+    }
+}
+
+static int omb_ref_real_rank(int newrank, int rem)
+{
+    return (newrank < rem) ? 2 * newrank + 1 : newrank + rem;
+}
+
+static void omb_ref_allreduce_recursive_doubling(char *buf, int count,
+                                                 MPI_Datatype datatype,
+                                                 MPI_Op op, MPI_Comm comm)
+{
+    int size = 0, pof2 = 1, newrank = 0, mask = 0, peer = 0;
+    char *tmp = omb_ref_alloc(count, datatype);
+
+    MPI_CHECK(MPI_Comm_size(comm, &size));
+    while (2 * pof2 <= size) {
+        pof2 <<= 1;
+    }
+    newrank = omb_ref_fold(buf, tmp, count, datatype, op, pof2, comm);
+    for (mask = 1; 0 <= newrank && mask < pof2; mask <<= 1) {
+        peer = omb_ref_real_rank(newrank ^ mask, size - pof2);
+        MPI_CHECK(MPI_Sendrecv(buf, count, datatype, peer, OMB_REF_TAG, tmp,
+                               count, datatype, peer, OMB_REF_TAG, comm,
+                               MPI_STATUS_IGNORE));
+        MPI_CHECK(MPI_Reduce_local(tmp, buf, count, datatype, op));
+    }
+    omb_ref_unfold(buf, count, datatype, pof2, comm);
+    free(tmp);
+}
+
+/*
+ * Rabenseifner: reduce-scatter by recursive halving, then allgather by
+ * recursive doubling, over pof2 blocks of the vector.
+ */
+static void omb_ref_allreduce_rabenseifner(char *buf, int count,
+                                           MPI_Datatype datatype, MPI_Op op,
+                                           MPI_Comm comm)
+{
+    int size = 0, pof2 = 1, rem = 0, newrank = 0, mask = 0, peer = 0;
+    int send_idx = 0, recv_idx = 0, last_idx = 0, send_cnt = 0, recv_cnt = 0;
+    int itr = 0, *cnts = NULL, *disps = NULL;
+    MPI_Aint extent = omb_ref_extent(datatype);
+    char *tmp = NULL;
+
+    MPI_CHECK(MPI_Comm_size(comm, &size));
+    while (2 * pof2 <= size) {
+        pof2 <<= 1;
+    }
+    if (count < pof2) {
+        omb_ref_allreduce_recursive_doubling(buf, count, datatype, op, comm);
+        return;
+    }
+    rem = size - pof2;
+    tmp = omb_ref_alloc(count, datatype);
+    newrank = omb_ref_fold(buf, tmp, count, datatype, op, pof2, comm);
+    if (0 > newrank) {
+        omb_ref_unfold(buf, count, datatype, pof2, comm);
+        free(tmp);
+        return;
+    }
+
+    cnts = malloc(pof2 * sizeof(int));
+    disps = malloc(pof2 * sizeof(int));
+    OMB_CHECK_NULL_AND_EXIT(cnts, "Unable to allocate memory");
+    OMB_CHECK_NULL_AND_EXIT(disps, "Unable to allocate memory");
+    for (itr = 0; itr < pof2; itr++) {
+        cnts[itr] = count / pof2 + (itr < count % pof2 ? 1 : 0);
+        disps[itr] = (0 == itr) ? 0 : disps[itr - 1] + cnts[itr - 1];
+    }
+
+    last_idx = pof2;
+    for (mask = 1; mask < pof2; mask <<= 1) {
+        peer = omb_ref_real_rank(newrank ^ mask, rem);
+        send_cnt = recv_cnt = 0;
+        if (newrank < (newrank ^ mask)) {
+            send_idx = recv_idx + pof2 / (mask * 2);
+            for (itr = send_idx; itr < last_idx; itr++) {
+                send_cnt += cnts[itr];
+            }
+            for (itr = recv_idx; itr < send_idx; itr++) {
+                recv_cnt += cnts[itr];
+            }
+        } else {
+            recv_idx = send_idx + pof2 / (mask * 2);
+            for (itr = send_idx; itr < recv_idx; itr++) {
+                send_cnt += cnts[itr];
+            }
+            for (itr = recv_idx; itr < last_idx; itr++) {
+                recv_cnt += cnts[itr];
+            }
+        }
+        MPI_CHECK(MPI_Sendrecv(buf + disps[send_idx] * extent, send_cnt,
+                               datatype, peer, OMB_REF_TAG,
+                               tmp + disps[recv_idx] * extent, recv_cnt,
+                               datatype, peer, OMB_REF_TAG, comm,
+                               MPI_STATUS_IGNORE));
+        MPI_CHECK(MPI_Reduce_local(tmp + disps[recv_idx] * extent,
+                                   buf + disps[recv_idx] * extent, recv_cnt,
+                                   datatype, op));
+        send_idx = recv_idx;
+        if (2 * mask < pof2) {
+            last_idx = recv_idx + pof2 / (mask * 2);
+        }
+    }
+
+    for (mask = pof2 / 2; mask > 0; mask >>= 1) {
+        peer = omb_ref_real_rank(newrank ^ mask, rem);
+        send_cnt = recv_cnt = 0;
+        if (newrank < (newrank ^ mask)) {
+            if (mask != pof2 / 2) {
+                last_idx = last_idx + pof2 / (mask * 2);
+            }
+            recv_idx = send_idx + pof2 / (mask * 2);
+            for (itr = send_idx; itr < recv_idx; itr++) {
+                send_cnt += cnts[itr];
+            }
+            for (itr = recv_idx; itr < last_idx; itr++) {
+                recv_cnt += cnts[itr];
+            }
+        } else {
+            recv_idx = send_idx - pof2 / (mask * 2);
+            for (itr = send_idx; itr < last_idx; itr++) {
+                send_cnt += cnts[itr];
+            }
+            for (itr = recv_idx; itr < send_idx; itr++) {
+                recv_cnt += cnts[itr];
+            }
+        }
+        MPI_CHECK(MPI_Sendrecv(buf + disps[send_idx] * extent, send_cnt,
+                               datatype, peer, OMB_REF_TAG,
+                               buf + disps[recv_idx] * extent, recv_cnt,
+                               datatype, peer, OMB_REF_TAG, comm,
+                               MPI_STATUS_IGNORE));
+        if (newrank > (newrank ^ mask)) {
+            send_idx = recv_idx;
+        }
+    }
+
+    omb_ref_unfold(buf, count, datatype, pof2, comm);
+    free(cnts);
+    free(disps);
+    free(tmp);
+}
+
+/*
+ * Ring: reduce-scatter then allgather around the ring, size - 1 steps
+ * each. With a segment size the vector is done in phases of one segment
+ * per rank, so that blocks stay small (Open MPI's segmented ring).
+ */
+static void omb_ref_allreduce_ring(char *buf, int count,
+                                   MPI_Datatype datatype, MPI_Op op,
+                                   MPI_Comm comm)
+{
+    int rank = 0, size = 0, step = 0, phase = 0, phase_count = 0;
+    int send_block = 0, recv_block = 0, n = 0;
+    int left = 0, right = 0;
+    MPI_Aint extent = omb_ref_extent(datatype);
+    char *tmp = NULL, *base = NULL;
+
+    MPI_CHECK(MPI_Comm_rank(comm, &rank));
+    MPI_CHECK(MPI_Comm_size(comm, &size));
+    left = (rank - 1 + size) % size;
+    right = (rank + 1) % size;
+    phase_count = omb_ref_seg_count((count + size - 1) / size, datatype, 0);
+    phase_count = MIN(phase_count * size, count);
+    tmp = omb_ref_alloc(phase_count / size + 1, datatype);
+
+#define OMB_REF_BLOCK_COUNT(b) (n / size + ((b) < n % size ? 1 : 0))
+#define OMB_REF_BLOCK_OFFSET(b) ((b) * (n / size) + MIN((b), n % size))
+    for (phase = 0; phase < count; phase += phase_count) {
+        base = buf + phase * extent;
+        n = MIN(phase_count, count - phase);
+        for (step = 0; step < size - 1; step++) {
+            send_block = (rank - step + size) % size;
+            recv_block = (rank - step - 1 + size) % size;
+            MPI_CHECK(MPI_Sendrecv(
+                base + OMB_REF_BLOCK_OFFSET(send_block) * extent,
+                OMB_REF_BLOCK_COUNT(send_block), datatype, right, OMB_REF_TAG,
+                tmp, OMB_REF_BLOCK_COUNT(recv_block), datatype, left,
+                OMB_REF_TAG, comm, MPI_STATUS_IGNORE));
+            MPI_CHECK(MPI_Reduce_local(
+                tmp, base + OMB_REF_BLOCK_OFFSET(recv_block) * extent,
+                OMB_REF_BLOCK_COUNT(recv_block), datatype, op));
+        }
+        for (step = 0; step < size - 1; step++) {
+            send_block = (rank + 1 - step + size) % size;
+            recv_block = (rank - step + size) % size;
+            MPI_CHECK(MPI_Sendrecv(
+                base + OMB_REF_BLOCK_OFFSET(send_block) * extent,
+                OMB_REF_BLOCK_COUNT(send_block), datatype, right, OMB_REF_TAG,
+                base + OMB_REF_BLOCK_OFFSET(recv_block) * extent,
+                OMB_REF_BLOCK_COUNT(recv_block), datatype, left, OMB_REF_TAG,
+                comm, MPI_STATUS_IGNORE));
+        }
+    }
+#undef OMB_REF_BLOCK_COUNT
+#undef OMB_REF_BLOCK_OFFSET
+    free(tmp);
+}
+
+static void omb_ref_alltoall_pairwise(const char *sendbuf, int sendcount,
+                                      MPI_Datatype sendtype, char *recvbuf,
+                                      int recvcount, MPI_Datatype recvtype,
+                                      MPI_Comm comm)
+{
+    int rank = 0, size = 0, step = 0, dst = 0, src = 0;
+    MPI_Aint send_block = sendcount * omb_ref_extent(sendtype);
+    MPI_Aint recv_block = recvcount * omb_ref_extent(recvtype);
+
+    MPI_CHECK(MPI_Comm_rank(comm, &rank));
+    MPI_CHECK(MPI_Comm_size(comm, &size));
+    omb_ref_copy(sendbuf + rank * send_block, sendcount, sendtype,
+                 recvbuf + rank * recv_block, recvcount, recvtype);
+    for (step = 1; step < size; step++) {
+        dst = (rank + step) % size;
+        src = (rank - step + size) % size;
+        MPI_CHECK(MPI_Sendrecv(sendbuf + dst * send_block, sendcount, sendtype,
+                               dst, OMB_REF_TAG, recvbuf + src * recv_block,
+                               recvcount, recvtype, src, OMB_REF_TAG, comm,
+                               MPI_STATUS_IGNORE));
+    }
+}
+
+/*
+ * Bruck: after rotating block i to (rank + i), step k sends every block
+ * whose index has bit k set to rank + k, log2(size) steps in all, and a
+ * final inverse rotation puts the blocks in rank order. The blocks of a
+ * step are described by an indexed datatype rather than packed.
+ */
+static void omb_ref_alltoall_bruck(const char *sendbuf, int sendcount,
+                                   MPI_Datatype sendtype, char *recvbuf,
+                                   int recvcount, MPI_Datatype recvtype,
+                                   MPI_Comm comm)
+{
+    int rank = 0, size = 0, bit = 0, itr = 0, num_blocks = 0;
+    int *displs = NULL;
+    MPI_Aint send_block = sendcount * omb_ref_extent(sendtype);
+    MPI_Datatype blocks;
+    char *tmp = NULL, *rtmp = NULL;
+
+    MPI_CHECK(MPI_Comm_rank(comm, &rank));
+    MPI_CHECK(MPI_Comm_size(comm, &size));
+    tmp = omb_ref_alloc(size * recvcount, recvtype);
+    rtmp = omb_ref_alloc(size * recvcount, recvtype);
+    displs = malloc(size * sizeof(int));
+    OMB_CHECK_NULL_AND_EXIT(displs, "Unable to allocate memory");
+
+    omb_ref_copy(sendbuf + rank * send_block, (size - rank) * sendcount,
+                 sendtype, tmp, (size - rank) * recvcount, recvtype);
+    omb_ref_copy(sendbuf, rank * sendcount, sendtype,
+                 tmp + (size - rank) * recvcount * omb_ref_extent(recvtype),
+                 rank * recvcount, recvtype);
+    for (bit = 1; bit < size; bit <<= 1) {
+        num_blocks = 0;
+        for (itr = 0; itr < size; itr++) {
+            if (itr & bit) {
+                displs[num_blocks++] = itr * recvcount;
+            }
+        }
+        MPI_CHECK(MPI_Type_create_indexed_block(num_blocks, recvcount, displs,
+                                                recvtype, &blocks));
+        MPI_CHECK(MPI_Type_commit(&blocks));
+        MPI_CHECK(MPI_Sendrecv(tmp, 1, blocks, (rank + bit) % size,
+                               OMB_REF_TAG, rtmp, 1, blocks,
+                               (rank - bit + size) % size, OMB_REF_TAG, comm,
+                               MPI_STATUS_IGNORE));
+        omb_ref_copy(rtmp, 1, blocks, tmp, 1, blocks);
+        MPI_CHECK(MPI_Type_free(&blocks));
+    }
+    for (itr = 0; itr < size; itr++) {
+        displs[itr] = ((rank - itr + size) % size) * recvcount;
+    }
+    MPI_CHECK(MPI_Type_create_indexed_block(size, recvcount, displs, recvtype,
+                                            &blocks));
+    MPI_CHECK(MPI_Type_commit(&blocks));
+    omb_ref_copy(tmp, size * recvcount, recvtype, recvbuf, 1, blocks);
+    MPI_CHECK(MPI_Type_free(&blocks));
+    free(displs);
+    free(rtmp);
+    free(tmp);
+}
+
+int omb_bcast(void *buffer, int count, MPI_Datatype datatype, int root,
+              MPI_Comm comm)
+{
+    switch (options.omb_ref_algo) {
+        case OMB_REF_BINOMIAL:
+            omb_ref_bcast_binomial(buffer, count, datatype, root, comm);
+            return MPI_SUCCESS;
+        case OMB_REF_CHAIN:
+            omb_ref_bcast_chain(buffer, count, datatype, root, comm);
+            return MPI_SUCCESS;
+        case OMB_REF_SPLIT_BINARY:
+            omb_ref_bcast_split_binary(buffer, count, datatype, root, comm);
+            return MPI_SUCCESS;
+        default:
+            return MPI_Bcast(buffer, count, datatype, root, comm);
+    }
+}
+
+int omb_scatter(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+                MPI_Comm comm)
+{
+    switch (options.omb_ref_algo) {
+        case OMB_REF_BINOMIAL:
+            omb_ref_scatter_binomial(sendbuf, sendcount, sendtype, recvbuf,
+                                     recvcount, recvtype, root, comm);
+            return MPI_SUCCESS;
+        case OMB_REF_LINEAR:
+            omb_ref_linear(1, sendbuf, sendcount, sendtype, recvbuf,
+                           recvcount, recvtype, root, comm);
+            return MPI_SUCCESS;
+        default:
+            return MPI_Scatter(sendbuf, sendcount, sendtype, recvbuf,
+                               recvcount, recvtype, root, comm);
+    }
+}
+
+int omb_gather(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+               void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+               MPI_Comm comm)
+{
+    switch (options.omb_ref_algo) {
+        case OMB_REF_BINOMIAL:
+            omb_ref_gather_binomial(sendbuf, sendcount, sendtype, recvbuf,
+                                    recvcount, recvtype, root, comm);
+            return MPI_SUCCESS;
+        case OMB_REF_LINEAR:
+            omb_ref_linear(0, sendbuf, sendcount, sendtype, recvbuf,
+                           recvcount, recvtype, root, comm);
+            return MPI_SUCCESS;
+        default:
+            return MPI_Gather(sendbuf, sendcount, sendtype, recvbuf,
+                              recvcount, recvtype, root, comm);
+    }
+}
+
+int omb_allreduce(const void *sendbuf, void *recvbuf, int count,
+                  MPI_Datatype datatype, MPI_Op op, MPI_Comm comm)
+{
+    if (OMB_REF_NONE == options.omb_ref_algo) {
+        return MPI_Allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+    }
+    if (MPI_IN_PLACE != sendbuf) {
+        omb_ref_copy(sendbuf, count, datatype, recvbuf, count, datatype);
+    }
+    switch (options.omb_ref_algo) {
+        case OMB_REF_RING:
+            omb_ref_allreduce_ring(recvbuf, count, datatype, op, comm);
+            break;
+        case OMB_REF_RECURSIVE_DOUBLING:
+            omb_ref_allreduce_recursive_doubling(recvbuf, count, datatype, op,
+                                                 comm);
+            break;
+        default:
+            omb_ref_allreduce_rabenseifner(recvbuf, count, datatype, op,
+                                           comm);
+            break;
+    }
+    return MPI_SUCCESS;
+}
+
+int omb_alltoall(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                 void *recvbuf, int recvcount, MPI_Datatype recvtype,
+                 MPI_Comm comm)
+{
+    int size = 0;
+    char *copy = NULL;
+
+    if (OMB_REF_NONE == options.omb_ref_algo) {
+        return MPI_Alltoall(sendbuf, sendcount, sendtype, recvbuf, recvcount,
+                            recvtype, comm);
+    }
+    if (MPI_IN_PLACE == sendbuf) {
+        MPI_CHECK(MPI_Comm_size(comm, &size));
+        copy = omb_ref_alloc(size * recvcount, recvtype);
+        omb_ref_copy(recvbuf, size * recvcount, recvtype, copy,
+                     size * recvcount, recvtype);
+        sendbuf = copy;
+        sendcount = recvcount;
+        sendtype = recvtype;
+    }
+    if (OMB_REF_BRUCK == options.omb_ref_algo) {
+        omb_ref_alltoall_bruck(sendbuf, sendcount, sendtype, recvbuf,
+                               recvcount, recvtype, comm);
+    } else {
+        omb_ref_alltoall_pairwise(sendbuf, sendcount, sendtype, recvbuf,
+                                  recvcount, recvtype, comm);
+    }
+    free(copy);
+    return MPI_SUCCESS;
 }
 
 int omb_get_root_rank(int itr, size_t comm_size)
@@ -2366,7 +5022,7 @@ int allocate_memory_coll(void **buffer, size_t size, enum accel_type type)
 
     switch (type) {
         case NONE:
-            return posix_memalign(buffer, alignment, size);
+            return omb_mem_alloc(buffer, alignment, size, OMB_MEM_COLL);
 #ifdef _ENABLE_CUDA_
         case CUDA:
             CUDA_CHECK(cudaMalloc(buffer, size));
@@ -2545,14 +5201,14 @@ int allocate_memory_pt2pt_mul(char **sbuf, char **rbuf, int rank, int pairs)
                 return 1;
             }
         } else {
-            if (posix_memalign((void **)sbuf, align_size,
-                               options.max_message_size)) {
+            if (omb_mem_alloc((void **)sbuf, align_size,
+                              options.max_message_size, OMB_MEM_SBUF)) {
                 fprintf(stderr, "Error allocating host memory\n");
                 return 1;
             }
 
-            if (posix_memalign((void **)rbuf, align_size,
-                               options.max_message_size)) {
+            if (omb_mem_alloc((void **)rbuf, align_size,
+                              options.max_message_size, OMB_MEM_RBUF)) {
                 fprintf(stderr, "Error allocating host memory\n");
                 return 1;
             }
@@ -2582,14 +5238,14 @@ int allocate_memory_pt2pt_mul(char **sbuf, char **rbuf, int rank, int pairs)
                 return 1;
             }
         } else {
-            if (posix_memalign((void **)sbuf, align_size,
-                               options.max_message_size)) {
+            if (omb_mem_alloc((void **)sbuf, align_size,
+                              options.max_message_size, OMB_MEM_SBUF)) {
                 fprintf(stderr, "Error allocating host memory\n");
                 return 1;
             }
 
-            if (posix_memalign((void **)rbuf, align_size,
-                               options.max_message_size)) {
+            if (omb_mem_alloc((void **)rbuf, align_size,
+                              options.max_message_size, OMB_MEM_RBUF)) {
                 fprintf(stderr, "Error allocating host memory\n");
                 return 1;
             }
@@ -2635,12 +5291,12 @@ int allocate_memory_pt2pt_mul_size(char **sbuf, char **rbuf, int rank,
                 return 1;
             }
         } else {
-            if (posix_memalign((void **)sbuf, align_size, size)) {
+            if (omb_mem_alloc((void **)sbuf, align_size, size, OMB_MEM_SBUF)) {
                 fprintf(stderr, "Error allocating host memory\n");
                 return 1;
             }
 
-            if (posix_memalign((void **)rbuf, align_size, size)) {
+            if (omb_mem_alloc((void **)rbuf, align_size, size, OMB_MEM_RBUF)) {
                 fprintf(stderr, "Error allocating host memory\n");
                 return 1;
             }
@@ -2670,12 +5326,12 @@ int allocate_memory_pt2pt_mul_size(char **sbuf, char **rbuf, int rank,
                 return 1;
             }
         } else {
-            if (posix_memalign((void **)sbuf, align_size, size)) {
+            if (omb_mem_alloc((void **)sbuf, align_size, size, OMB_MEM_SBUF)) {
                 fprintf(stderr, "Error allocating host memory\n");
                 return 1;
             }
 
-            if (posix_memalign((void **)rbuf, align_size, size)) {
+            if (omb_mem_alloc((void **)rbuf, align_size, size, OMB_MEM_RBUF)) {
                 fprintf(stderr, "Error allocating host memory\n");
                 return 1;
             }
@@ -2714,14 +5370,14 @@ int allocate_memory_pt2pt(char **sbuf, char **rbuf, int rank)
                     return 1;
                 }
             } else {
-                if (posix_memalign((void **)sbuf, align_size,
-                                   options.max_message_size)) {
+                if (omb_mem_alloc((void **)sbuf, align_size,
+                                  options.max_message_size, OMB_MEM_SBUF)) {
                     fprintf(stderr, "Error allocating host memory\n");
                     return 1;
                 }
 
-                if (posix_memalign((void **)rbuf, align_size,
-                                   options.max_message_size)) {
+                if (omb_mem_alloc((void **)rbuf, align_size,
+                                  options.max_message_size, OMB_MEM_RBUF)) {
                     fprintf(stderr, "Error allocating host memory\n");
                     return 1;
                 }
@@ -2749,14 +5405,14 @@ int allocate_memory_pt2pt(char **sbuf, char **rbuf, int rank)
                     return 1;
                 }
             } else {
-                if (posix_memalign((void **)sbuf, align_size,
-                                   options.max_message_size)) {
+                if (omb_mem_alloc((void **)sbuf, align_size,
+                                  options.max_message_size, OMB_MEM_SBUF)) {
                     fprintf(stderr, "Error allocating host memory\n");
                     return 1;
                 }
 
-                if (posix_memalign((void **)rbuf, align_size,
-                                   options.max_message_size)) {
+                if (omb_mem_alloc((void **)rbuf, align_size,
+                                  options.max_message_size, OMB_MEM_RBUF)) {
                     fprintf(stderr, "Error allocating host memory\n");
                     return 1;
                 }
@@ -2802,12 +5458,14 @@ int allocate_memory_pt2pt_size(char **sbuf, char **rbuf, int rank,
                     return 1;
                 }
             } else {
-                if (posix_memalign((void **)sbuf, align_size, size)) {
+                if (omb_mem_alloc((void **)sbuf, align_size, size,
+                                  OMB_MEM_SBUF)) {
                     fprintf(stderr, "Error allocating host memory\n");
                     return 1;
                 }
 
-                if (posix_memalign((void **)rbuf, align_size, size)) {
+                if (omb_mem_alloc((void **)rbuf, align_size, size,
+                                  OMB_MEM_RBUF)) {
                     fprintf(stderr, "Error allocating host memory\n");
                     return 1;
                 }
@@ -2835,12 +5493,14 @@ int allocate_memory_pt2pt_size(char **sbuf, char **rbuf, int rank,
                     return 1;
                 }
             } else {
-                if (posix_memalign((void **)sbuf, align_size, size)) {
+                if (omb_mem_alloc((void **)sbuf, align_size, size,
+                                  OMB_MEM_SBUF)) {
                     fprintf(stderr, "Error allocating host memory\n");
                     return 1;
                 }
 
-                if (posix_memalign((void **)rbuf, align_size, size)) {
+                if (omb_mem_alloc((void **)rbuf, align_size, size,
+                                  OMB_MEM_RBUF)) {
                     fprintf(stderr, "Error allocating host memory\n");
                     return 1;
                 }
@@ -3027,7 +5687,7 @@ void free_buffer(void *buffer, enum accel_type type)
 {
     switch (type) {
         case NONE:
-            free(buffer);
+            omb_mem_free(buffer);
             break;
         case MANAGED:
         case CUDA:
@@ -3242,10 +5902,10 @@ void free_memory(void *sbuf, void *rbuf, int rank)
                 free_device_buffer(rbuf);
             } else {
                 if (sbuf) {
-                    free(sbuf);
+                    omb_mem_free(sbuf);
                 }
                 if (rbuf) {
-                    free(rbuf);
+                    omb_mem_free(rbuf);
                 }
             }
             break;
@@ -3255,10 +5915,10 @@ void free_memory(void *sbuf, void *rbuf, int rank)
                 free_device_buffer(rbuf);
             } else {
                 if (sbuf) {
-                    free(sbuf);
+                    omb_mem_free(sbuf);
                 }
                 if (rbuf) {
-                    free(rbuf);
+                    omb_mem_free(rbuf);
                 }
             }
             break;
@@ -3272,16 +5932,16 @@ void free_memory_pt2pt_mul(void *sbuf, void *rbuf, int rank, int pairs)
             free_device_buffer(sbuf);
             free_device_buffer(rbuf);
         } else {
-            free(sbuf);
-            free(rbuf);
+            omb_mem_free(sbuf);
+            omb_mem_free(rbuf);
         }
     } else {
         if ('D' == options.dst || 'M' == options.dst) {
             free_device_buffer(sbuf);
             free_device_buffer(rbuf);
         } else {
-            free(sbuf);
-            free(rbuf);
+            omb_mem_free(sbuf);
+            omb_mem_free(rbuf);
         }
     }
 }
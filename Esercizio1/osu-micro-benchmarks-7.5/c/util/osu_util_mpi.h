@@ -95,6 +95,23 @@ typedef struct omb_stat_t {
     double res_arr[OMB_STAT_MAX_NUM];
 } omb_stat_t;
 
+/*
+ * Log-linear latency histogram in nanoseconds, laid out like an HDR
+ * histogram: values below OMB_HIST_SUB_BUCKETS are exact, above that every
+ * power of two is split in OMB_HIST_SUB_BUCKETS / 2 buckets, so a value is
+ * never more than 2 / OMB_HIST_SUB_BUCKETS (0.8%) off its bucket.
+ */
+#define OMB_HIST_SUB_BUCKETS 256
+#define OMB_HIST_MAX_SHIFT   40
+#define OMB_HIST_NUM_BUCKETS                                                   \
+    ((OMB_HIST_MAX_SHIFT + 2) * OMB_HIST_SUB_BUCKETS / 2)
+typedef struct omb_hist_t {
+    uint64_t counts[OMB_HIST_NUM_BUCKETS];
+    uint64_t total;
+    double min;
+    double max;
+} omb_hist_t;
+
 void print_bad_usage_message(int rank);
 void print_help_message(int rank);
 void print_help_message_common();
@@ -286,5 +303,133 @@ typedef struct omb_mpi_init_data_t {
 void omb_mpi_finalize(omb_mpi_init_data omb_init_h);
 omb_mpi_init_data omb_mpi_init(int *argc, char ***argv);
 
+/*
+ * Collective Sweeps (communicator sizes, algorithms, cache state) and topology
+ */
+#define OMB_ALGO_CVAR_FORMAT  "coll_tuned_%s_algorithm"
+#define OMB_ALGO_DYNAMIC_CVAR "coll_tuned_use_dynamic_rules"
+#define OMB_ALGO_MAX_NUM      32
+#define OMB_ALGO_NAME_MAX_LEN 128
+#define OMB_SWEEP_MAX_COLUMNS (2 * OMB_ALGO_MAX_NUM)
+#define OMB_IDLE_SLEEP_NS     50000
+
+/* Where a rank runs: logical CPU, core, socket, NUMA node and L3 (CCX) */
+struct omb_rank_place_t {
+    int cpu;
+    int core;
+    int socket;
+    int numa;
+    int l3;
+};
+
+int omb_read_sysfs_int(const char *path);
+void omb_get_rank_place(struct omb_rank_place_t *place);
+/* Completes a request sleeping between tests, so that idle ranks stay quiet */
+void omb_quiet_wait(MPI_Request *request);
+#define OMB_CACHE_NUM_POOLS       2
+#define OMB_CACHE_SBUF            0
+#define OMB_CACHE_RBUF            1
+#define OMB_CACHE_LLC_FACTOR      2
+#define OMB_CACHE_DEFAULT_POOL_MB 256
+#define OMB_CACHE_MIN_SLOTS       2
+int omb_cache_num_passes();
+void omb_cache_select(int cache_itr, int rank);
+int omb_cache_is_cold();
+/* The buffer for iteration itr: buf itself when hot, a pool slot when cold */
+void *omb_cache_buf(void *buf, size_t bytes, int itr, int pool);
+void omb_cache_free();
+int omb_sweep_init(MPI_Comm comm, int rank);
+MPI_Comm omb_sweep_select(int sweep_itr, MPI_Comm comm, int rank);
+void omb_sweep_record(int size, double avg_time);
+void omb_sweep_finalize(MPI_Comm comm, int rank);
+
+/*
+ * Clock Synchronization and Synchronized Start
+ */
+#define OMB_CLOCK_SYNC_PINGS          20
+#define OMB_CLOCK_SYNC_TAG            1001
+#define OMB_SYNC_START_FACTOR         2
+#define OMB_SYNC_START_DEFAULT_WINDOW 1e-3
+#define OMB_SYNC_START_LEAD           1e-3
+#define OMB_SYNC_START_SPIN           2e-4
+void omb_clock_sync(MPI_Comm comm);
+double omb_clock_global(double t_local);
+double omb_clock_local(double t_global);
+double omb_sync_start_wait(MPI_Comm comm, int itr);
+void omb_sync_start_end(int itr, double t_start, double t_stop);
+void omb_sync_start_record(MPI_Comm comm, int size);
+void omb_sync_start_finalize(int rank);
+
+/*
+ * Adaptive Message Sizes
+ */
+#define OMB_ADAPTIVE_MAX_POINTS   64
+#define OMB_ADAPTIVE_MAX_SWITCHES 16
+#define OMB_ADAPTIVE_ALIGN        64
+#define OMB_ADAPTIVE_RESOLUTION   64
+#define OMB_ADAPTIVE_LABEL_LEN    32
+enum omb_adaptive_state_t {
+    OMB_ADAPTIVE_SWEEP,
+    OMB_ADAPTIVE_BISECT,
+    OMB_ADAPTIVE_CONFIRM_LO,
+    OMB_ADAPTIVE_CONFIRM_HI,
+    OMB_ADAPTIVE_DONE
+};
+int omb_adaptive_first(double *value);
+int omb_adaptive_next(MPI_Comm comm, int size, double *value);
+void omb_adaptive_finalize(int rank);
+
+/*
+ * Model Fitting
+ */
+#define OMB_FIT_TOLERANCE  0.1
+#define OMB_FIT_MIN_POINTS 4
+void omb_fit_line(const double *x, const double *y, int n, double *alpha,
+                  double *beta);
+int omb_fit_regimes(const double *x, const double *y, int n, double tolerance,
+                    int min_points, int *first, double *alpha, double *beta);
+
+/*
+ * Buffer Placement
+ */
+#define OMB_MEM_SBUF         0
+#define OMB_MEM_RBUF         1
+#define OMB_MEM_COLL         2
+#define OMB_MEM_NUM_ROLES    3
+#define OMB_MEM_MAX_NODES    64
+#define OMB_MEM_MAX_SAMPLES  4096
+#define OMB_MEM_LINE_LEN     256
+#define OMB_MEM_REPORT_LEN   1024
+#define OMB_MEM_SHM_NAME_LEN 64
+#define OMB_MEM_HUGE_DEFAULT (2 * 1024 * 1024)
+/* From linux/mempolicy.h, so that libnuma is not needed */
+#define OMB_MPOL_BIND        2
+#define OMB_MPOL_MF_STRICT   (1 << 0)
+#define OMB_MPOL_MF_MOVE     (1 << 1)
+/* Drop-in for posix_memalign placing host buffers as asked with -M */
+int omb_mem_alloc(void **buffer, size_t alignment, size_t size, int role);
+void omb_mem_free(void *buffer);
+void omb_mem_report(MPI_Comm comm);
+
+/*
+ * Reference Collectives
+ */
+#define OMB_REF_TAG           1002
+#define OMB_REF_BCAST_SEGSIZE 8192
+/* Dispatch to the -U algorithm, or to the MPI library when none is set */
+int omb_bcast(void *buffer, int count, MPI_Datatype datatype, int root,
+              MPI_Comm comm);
+int omb_scatter(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+                MPI_Comm comm);
+int omb_gather(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+               void *recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+               MPI_Comm comm);
+int omb_allreduce(const void *sendbuf, void *recvbuf, int count,
+                  MPI_Datatype datatype, MPI_Op op, MPI_Comm comm);
+int omb_alltoall(const void *sendbuf, int sendcount, MPI_Datatype sendtype,
+                 void *recvbuf, int recvcount, MPI_Datatype recvtype,
+                 MPI_Comm comm);
+
 int omb_get_root_rank(int itr, size_t comm_size);
 void omb_scatter_offset_copy(void *buf, int root_rank, size_t size);
@@ -54,25 +54,48 @@
             {"in-place", no_argument, 0, 'l'},                                 \
             {"tail-lat", optional_argument, 0, 'z'},                           \
             {"partitions", optional_argument, 0, 'q'},                         \
+            {"algorithm", required_argument, 0, 'A'},                          \
+            {"comm-sizes", required_argument, 0, 'S'},                         \
+            {"sync-start", optional_argument, 0, 'y'},                         \
+            {"adaptive-sizes", optional_argument, 0, 'B'},                     \
+            {"cold-cache", optional_argument, 0, 'C'},                         \
+            {"mem-placement", required_argument, 0, 'M'},                      \
+            {"trace", required_argument, 0, 'F'},                              \
+            {"gap-scale", required_argument, 0, 'g'},                          \
+            {"remap", required_argument, 0, 'n'},                              \
+            {"collectives", required_argument, 0, 'e'},                        \
+            {"segment-sizes", required_argument, 0, 'E'},                      \
+            {"output", required_argument, 0, 'O'},                             \
+            {"reference", required_argument, 0, 'U'},                          \
         {                                                                      \
             "root-rank", required_argument, 0, 'k'                             \
         }                                                                      \
     }
 /*OMBOP[__ACCEL]__<options.bench>__<options.subtype>*/
-#define OMBOP__PT2PT__LAT                    "+:hvm:x:i:b:c::u:G:D:P:T:Iz::"
-#define OMBOP__PT2PT__PART_LAT               "+:hvm:x:i:b:c::u:G:D:P:T:Iz::q:"
-#define OMBOP__ACCEL__PT2PT__LAT             "+:x:i:m:d:hvc::u:G:D:T:Iz::"
-#define OMBOP__ACCEL__PT2PT__PART_LAT        "+:x:i:m:d:hvc::u:G:D:T:Iz::q:"
-#define OMBOP__PT2PT__BW                     "+:hvm:x:i:t:W:b:c::u:G:D:P:T:Iz::"
-#define OMBOP__ACCEL__PT2PT__BW              "+:x:i:t:m:d:W:hvb:c::u:G:D:T:Iz::"
-#define OMBOP__PT2PT__LAT_MT                 "+:hvm:x:i:t:c::u:G:D:T:Iz::"
+#define OMBOP__PT2PT__LAT                                                      \
+    "+:hvm:x:i:b:c::u:G:D:P:T:Iz::B::C::M:"
+#define OMBOP__PT2PT__PART_LAT               "+:hvm:x:i:b:c::u:G:D:P:T:Iz::q:M:"
+#define OMBOP__ACCEL__PT2PT__LAT                                               \
+    "+:x:i:m:d:hvc::u:G:D:T:Iz::B::C::M:"
+#define OMBOP__ACCEL__PT2PT__PART_LAT        "+:x:i:m:d:hvc::u:G:D:T:Iz::q:M:"
+#define OMBOP__PT2PT__BW                                                       \
+    "+:hvm:x:i:t:W:b:c::u:G:D:P:T:Iz::B::C::M:"
+#define OMBOP__ACCEL__PT2PT__BW                                                \
+    "+:x:i:t:m:d:W:hvb:c::u:G:D:T:Iz::B::C::M:"
+#define OMBOP__PT2PT__LAT_MT                 "+:hvm:x:i:t:c::u:G:D:T:Iz::M:"
 #define OMBOP__ACCEL__PT2PT__LAT_MT          OMBOP__ACCEL__PT2PT__LAT
-#define OMBOP__PT2PT__LAT_MP                 "+:hvm:x:i:t:c::u:G:D:P:T:Iz::"
+#define OMBOP__PT2PT__LAT_MP                 "+:hvm:x:i:t:c::u:G:D:P:T:Iz::M:"
 #define OMBOP__ACCEL__PT2PT__LAT_MP          OMBOP__ACCEL__PT2PT__LAT
-#define OMBOP__COLLECTIVE__ALLTOALL          "+:hvfm:i:x:a:c::u:G:D:P:T:Ilz::"
-#define OMBOP__ACCEL__COLLECTIVE__ALLTOALL   "+:d:hvfm:i:x:a:c::u:G:D:T:Ilz::"
-#define OMBOP__PT2PT__CONG_BW                "+:hvm:x:i:W:b:G:D:P:T:Iz::"
-#define OMBOP__ACCEL__PT2PT__CONG_BW         "p:W:R:x:i:m:d:Vhvb:G:D:T:Iz::"
+#define OMBOP__COLLECTIVE__ALLTOALL                                            \
+    "+:hvfm:i:x:a:c::u:G:D:P:T:Ilz::A:S:y::C::M:U:"
+#define OMBOP__ACCEL__COLLECTIVE__ALLTOALL                                     \
+    "+:d:hvfm:i:x:a:c::u:G:D:T:Ilz::A:S:y::C::M:U:"
+#define OMBOP__PT2PT__CONG_BW                "+:hvm:x:i:W:b:G:D:P:T:Iz::M:"
+#define OMBOP__ACCEL__PT2PT__CONG_BW         "p:W:R:x:i:m:d:Vhvb:G:D:T:Iz::M:"
+#define OMBOP__PT2PT__PAIR_MAT               "+:hvm:x:i:W:p:M:"
+#define OMBOP__ACCEL__PT2PT__PAIR_MAT        OMBOP__PT2PT__PAIR_MAT
+#define OMBOP__PT2PT__LOGGP                  "+:hvm:x:i:W:M:"
+#define OMBOP__ACCEL__PT2PT__LOGGP           OMBOP__PT2PT__LOGGP
 #define OMBOP__COLLECTIVE__GATHER            OMBOP__COLLECTIVE__ALLTOALL "k:"
 #define OMBOP__ACCEL__COLLECTIVE__GATHER     OMBOP__ACCEL__COLLECTIVE__ALLTOALL "k:"
 #define OMBOP__COLLECTIVE__ALL_GATHER        OMBOP__COLLECTIVE__ALLTOALL
@@ -80,19 +103,29 @@
 #define OMBOP__COLLECTIVE__SCATTER           OMBOP__COLLECTIVE__ALLTOALL "k:"
 #define OMBOP__ACCEL__COLLECTIVE__SCATTER                                      \
     OMBOP__ACCEL__COLLECTIVE__ALLTOALL "k:"
-#define OMBOP__COLLECTIVE__BCAST              "+:hvfm:i:x:a:c::u:G:D:P:T:Iz::"
-#define OMBOP__ACCEL__COLLECTIVE__BCAST       "+:d:hvfm:i:x:a:c::u:G:D:T:Iz::"
-#define OMBOP__COLLECTIVE__NHBR_GATHER        "+:hvfm:i:x:a:c::u:N:G:D:P:T:Iz::"
-#define OMBOP__ACCEL__COLLECTIVE__NHBR_GATHER "+:d:hvfm:i:x:a:c::u:N:G:D:T:Iz::"
+#define OMBOP__COLLECTIVE__BCAST                                               \
+    "+:hvfm:i:x:a:c::u:G:D:P:T:Iz::A:S:y::C::M:U:"
+#define OMBOP__ACCEL__COLLECTIVE__BCAST                                        \
+    "+:d:hvfm:i:x:a:c::u:G:D:T:Iz::A:S:y::C::M:U:"
+#define OMBOP__COLLECTIVE__NHBR_GATHER                                         \
+    "+:hvfm:i:x:a:c::u:N:G:D:P:T:Iz::M:"
+#define OMBOP__ACCEL__COLLECTIVE__NHBR_GATHER                                  \
+    "+:d:hvfm:i:x:a:c::u:N:G:D:T:Iz::M:"
 #define OMBOP__COLLECTIVE__NHBR_ALLTOALL      OMBOP__COLLECTIVE__NHBR_GATHER
 #define OMBOP__ACCEL__COLLECTIVE__NHBR_ALLTOALL                                \
     OMBOP__ACCEL__COLLECTIVE__NHBR_GATHER
-#define OMBOP__COLLECTIVE__BARRIER           "+:hvfm:i:x:a:u:G:P:Iz::"
-#define OMBOP__ACCEL__COLLECTIVE__BARRIER    "+:d:hvfm:i:x:a:u:G:Iz::"
+#define OMBOP__COLLECTIVE__REPLAY            "+:hvi:x:F:g:n:M:"
+#define OMBOP__ACCEL__COLLECTIVE__REPLAY     OMBOP__COLLECTIVE__REPLAY
+#define OMBOP__COLLECTIVE__TUNE              "+:hvm:i:x:A:S:e:E:O:M:"
+#define OMBOP__ACCEL__COLLECTIVE__TUNE       OMBOP__COLLECTIVE__TUNE
+#define OMBOP__COLLECTIVE__BARRIER           "+:hvfm:i:x:a:u:G:P:Iz::A:S:"
+#define OMBOP__ACCEL__COLLECTIVE__BARRIER    "+:d:hvfm:i:x:a:u:G:Iz::A:S:"
 #define OMBOP__COLLECTIVE__LAT               "+:hvfm:i:x:a:z::"
 #define OMBOP__ACCEL__COLLECTIVE__LAT        "+:d:hvfm:i:x:a:z::"
-#define OMBOP__COLLECTIVE__ALL_REDUCE        "+:hvfm:i:x:a:c::u:G:P:T:Ilz::"
-#define OMBOP__ACCEL__COLLECTIVE__ALL_REDUCE "+:d:hvfm:i:x:a:c::u:G:T:Ilz::"
+#define OMBOP__COLLECTIVE__ALL_REDUCE                                          \
+    "+:hvfm:i:x:a:c::u:G:P:T:Ilz::A:S:y::C::M:U:"
+#define OMBOP__ACCEL__COLLECTIVE__ALL_REDUCE                                   \
+    "+:d:hvfm:i:x:a:c::u:G:T:Ilz::A:S:y::C::M:U:"
 #define OMBOP__COLLECTIVE__REDUCE            OMBOP__COLLECTIVE__ALL_REDUCE "k:"
 #define OMBOP__ACCEL__COLLECTIVE__REDUCE                                       \
     OMBOP__ACCEL__COLLECTIVE__ALL_REDUCE "k:"
@@ -101,9 +134,10 @@
     OMBOP__ACCEL__COLLECTIVE__ALL_REDUCE
 #define OMBOP__COLLECTIVE__NBC_BARRIER        "+:hvfm:i:x:t:a:G:P:Iz::"
 #define OMBOP__ACCEL__COLLECTIVE__NBC_BARRIER "+:d:hvfm:i:x:t:a:G:Iz::"
-#define OMBOP__COLLECTIVE__NBC_ALLTOALL       "+:hvfm:i:x:t:a:c::u:G:D:P:T:Ilz::"
+#define OMBOP__COLLECTIVE__NBC_ALLTOALL                                        \
+    "+:hvfm:i:x:t:a:c::u:G:D:P:T:Ilz::M:"
 #define OMBOP__ACCEL__COLLECTIVE__NBC_ALLTOALL                                 \
-    "+:d:hvfm:i:x:t:a:c::u:G:D:T:Ilz::"
+    "+:d:hvfm:i:x:t:a:c::u:G:D:T:Ilz::M:"
 #define OMBOP__COLLECTIVE__NBC_GATHER OMBOP__COLLECTIVE__NBC_ALLTOALL "k:"
 #define OMBOP__ACCEL__COLLECTIVE__NBC_GATHER                                   \
     OMBOP__ACCEL__COLLECTIVE__NBC_ALLTOALL "k:"
@@ -113,20 +147,21 @@
 #define OMBOP__COLLECTIVE__NBC_SCATTER OMBOP__COLLECTIVE__NBC_ALLTOALL "k:"
 #define OMBOP__ACCEL__COLLECTIVE__NBC_SCATTER                                  \
     OMBOP__ACCEL__COLLECTIVE__NBC_ALLTOALL "k:"
-#define OMBOP__COLLECTIVE__NBC_BCAST        "+:hvfm:i:x:t:a:c::u:G:D:P:T:Iz::"
-#define OMBOP__ACCEL__COLLECTIVE__NBC_BCAST "+:d:hvfm:i:x:t:a:c::u:G:D:T:Iz::"
-#define OMBOP__COLLECTIVE__NBC_ALL_REDUCE   "+:hvfm:i:x:t:a:c::u:G:P:T:Ilz::"
+#define OMBOP__COLLECTIVE__NBC_BCAST        "+:hvfm:i:x:t:a:c::u:G:D:P:T:Iz::M:"
+#define OMBOP__ACCEL__COLLECTIVE__NBC_BCAST "+:d:hvfm:i:x:t:a:c::u:G:D:T:Iz::M:"
+#define OMBOP__COLLECTIVE__NBC_ALL_REDUCE   "+:hvfm:i:x:t:a:c::u:G:P:T:Ilz::M:"
 #define OMBOP__ACCEL__COLLECTIVE__NBC_ALL_REDUCE                               \
-    "+:d:hvfm:i:x:t:a:c::u:G:T:Ilz::"
+    "+:d:hvfm:i:x:t:a:c::u:G:T:Ilz::M:"
 #define OMBOP__COLLECTIVE__NBC_REDUCE OMBOP__COLLECTIVE__NBC_ALL_REDUCE "k:"
 #define OMBOP__ACCEL__COLLECTIVE__NBC_REDUCE                                   \
     OMBOP__ACCEL__COLLECTIVE__NBC_ALL_REDUCE "k:"
 #define OMBOP__COLLECTIVE__NBC_REDUCE_SCATTER OMBOP__COLLECTIVE__NBC_ALL_REDUCE
 #define OMBOP__ACCEL__COLLECTIVE__NBC_REDUCE_SCATTER                           \
     OMBOP__ACCEL__COLLECTIVE__NBC_ALL_REDUCE
-#define OMBOP__COLLECTIVE__NBC_NHBR_GATHER "+:hvfm:i:x:t:a:c::u:N:G:D:P:T:Iz::"
+#define OMBOP__COLLECTIVE__NBC_NHBR_GATHER                                     \
+    "+:hvfm:i:x:t:a:c::u:N:G:D:P:T:Iz::M:"
 #define OMBOP__ACCEL__COLLECTIVE__NBC_NHBR_GATHER                              \
-    "+:d:hvfm:i:x:t:a:c::u:N:G:D:T:Iz::"
+    "+:d:hvfm:i:x:t:a:c::u:N:G:D:T:Iz::M:"
 #define OMBOP__COLLECTIVE__NBC_NHBR_ALLTOALL OMBOP__COLLECTIVE__NBC_NHBR_GATHER
 #define OMBOP__ACCEL__COLLECTIVE__NBC_NHBR_ALLTOALL                            \
     OMBOP__ACCEL__COLLECTIVE__NBC_NHBR_GATHER
@@ -134,15 +169,15 @@
 #define OMBOP__ACCEL__ONE_SIDED__BW  "+:w:s:hvm:d:x:i:W:G:I"
 #define OMBOP__ONE_SIDED__LAT        "+:w:s:hvm:x:i:G:P:I"
 #define OMBOP__ACCEL__ONE_SIDED__LAT "+:w:s:hvm:d:x:i:G:I"
-#define OMBOP__MBW_MR                "p:W:R:x:i:m:Vhvb:c::u:G:D:P:T:Iz::"
-#define OMBOP__ACCEL__MBW_MR         "p:W:R:x:i:m:d:Vhvb:c::u:G:D:T:Iz::"
+#define OMBOP__MBW_MR                "p:W:R:x:i:m:Vhvb:c::u:G:D:P:T:Iz::M:"
+#define OMBOP__ACCEL__MBW_MR         "p:W:R:x:i:m:d:Vhvb:c::u:G:D:T:Iz::M:"
 #define OMBOP__OSHM                  ":hvfm:i:";
 #define OMBOP__UPC                   OMBOP__OSHM
 #define OMBOP__UPCXX                 OMBOP__OSHM
 #define OMBOP__STARTUP__INIT         "I"
 /*Persistent Collectives*/
-#define OMBOP__COLLECTIVE__ALLTOALL_P        "+:hvfm:i:x:a:c::u:G:D:P:T:Ilz::"
-#define OMBOP__ACCEL__COLLECTIVE__ALLTOALL_P "+:d:hvfm:i:x:a:c::u:G:D:T:Ilz::"
+#define OMBOP__COLLECTIVE__ALLTOALL_P        "+:hvfm:i:x:a:c::u:G:D:P:T:Ilz::M:"
+#define OMBOP__ACCEL__COLLECTIVE__ALLTOALL_P "+:d:hvfm:i:x:a:c::u:G:D:T:Ilz::M:"
 #define OMBOP__COLLECTIVE__GATHER_P          OMBOP__COLLECTIVE__ALLTOALL_P
 #define OMBOP__ACCEL__COLLECTIVE__GATHER_P   OMBOP__ACCEL__COLLECTIVE__ALLTOALL_P
 #define OMBOP__COLLECTIVE__ALL_GATHER_P      OMBOP__COLLECTIVE__ALLTOALL_P
@@ -150,12 +185,14 @@
     OMBOP__ACCEL__COLLECTIVE__ALLTOALL_P
 #define OMBOP__COLLECTIVE__SCATTER_P           OMBOP__COLLECTIVE__ALLTOALL_P
 #define OMBOP__ACCEL__COLLECTIVE__SCATTER_P    OMBOP__ACCEL__COLLECTIVE__ALLTOALL_P
-#define OMBOP__COLLECTIVE__BCAST_P             "+:hvfm:i:x:a:c::u:G:D:P:T:Iz::"
-#define OMBOP__ACCEL__COLLECTIVE__BCAST_P      "+:d:hvfm:i:x:a:c::u:G:D:T:Iz::"
+#define OMBOP__COLLECTIVE__BCAST_P                                             \
+    "+:hvfm:i:x:a:c::u:G:D:P:T:Iz::M:"
+#define OMBOP__ACCEL__COLLECTIVE__BCAST_P                                      \
+    "+:d:hvfm:i:x:a:c::u:G:D:T:Iz::M:"
 #define OMBOP__COLLECTIVE__BARRIER_P           "+:hvfm:i:x:a:u:G:P:Iz::"
 #define OMBOP__ACCEL__COLLECTIVE__BARRIER_P    "+:d:hvfm:i:x:a:u:G:Iz::"
-#define OMBOP__COLLECTIVE__ALL_REDUCE_P        "+:hvfm:i:x:a:c::u:G:P:T:Ilz::"
-#define OMBOP__ACCEL__COLLECTIVE__ALL_REDUCE_P "+:d:hvfm:i:x:a:c::u:G:T:Ilz::"
+#define OMBOP__COLLECTIVE__ALL_REDUCE_P        "+:hvfm:i:x:a:c::u:G:P:T:Ilz::M:"
+#define OMBOP__ACCEL__COLLECTIVE__ALL_REDUCE_P "+:d:hvfm:i:x:a:c::u:G:T:Ilz::M:"
 #define OMBOP__COLLECTIVE__REDUCE_P            OMBOP__COLLECTIVE__ALL_REDUCE_P
 #define OMBOP__ACCEL__COLLECTIVE__REDUCE_P                                     \
     OMBOP__ACCEL__COLLECTIVE__ALL_REDUCE_P
@@ -249,10 +286,74 @@
                   "Default:MPI_CHAR. Reduction defaults: MPI_INT"},            \
             {'I', "Enable session based MPI initialization."},                 \
             {'l', "Run benchmark with MPI_IN_PLACE support."},                 \
-            {'z', "Print tail latencies."                                      \
-                  "~~-z Outputs P99, P90, P50 percentiles"                     \
-                  "~~-z<1-99,1-99,1-99..> Comma seperated percentile range"},  \
+            {'z', "Print tail latencies over all ranks and iterations."        \
+                  "~~-z Outputs P50, P90, P99, P99.9 and P100 (max)"           \
+                  "~~-z<0-100,0-100,..> Comma seperated percentiles, at most"  \
+                  "~~5, fractions allowed e.g. -z50,99.9"},                    \
             {'q', "Number of MPI partitions."},                                \
+            {'A', "[all,ALGO,...] - Sweep collective algorithms in one run,"   \
+                  "~~selecting each through the MPI tool interface (MPI_T)."   \
+                  "~~ALGO is an algorithm number or name. Open MPI needs"      \
+                  "~~--mca coll_tuned_use_dynamic_rules 1 at launch."},        \
+            {'S', "N1,N2,...[:first|socket|ccx] - Sweep communicator sizes"    \
+                  "~~in one run. Each pass splits the first N ranks of the"    \
+                  "~~placement order off MPI_COMM_WORLD, the others wait."     \
+                  "~~first: rank order (default), socket: round robin"         \
+                  "~~over sockets, ccx: round robin over L3 caches (CCX)."},   \
+            {'y', "Start each timed iteration at the same instant on all"      \
+                  "~~ranks, from clocks synchronized by ping-pong, instead"    \
+                  "~~of after a barrier. Ranks report their completion time"   \
+                  "~~after the common start; the final table gives the"        \
+                  "~~latency of the last rank."                                \
+                  "~~-y    Window between starts from the warm-up iterations"  \
+                  "~~-y<N> Window of N us"},                                   \
+            {'B', "Bisect message sizes after the power of two sweep"          \
+                  "~~where the time per message leaves the linear trend,"      \
+                  "~~and report the protocol switch points found (eager"       \
+                  "~~limit, rendezvous, pipelining)."                          \
+                  "~~-B    Threshold of 15% off the trend"                     \
+                  "~~-B<N> Threshold of N%"},                                  \
+            {'C', "Run every size twice: hot, reusing the same buffers as"     \
+                  "~~usual, then cold, taking for each iteration the next"     \
+                  "~~buffer of a pool larger than the last level cache"        \
+                  "~~-C    Pool of twice the L3 size"                          \
+                  "~~-C<N> Pool of N MB per buffer"},                          \
+            {'M', "KIND[:NODE[,NODE]] - place host buffers by memory kind"     \
+                  "~~and NUMA node, and print where their pages landed"        \
+                  "~~KIND: host (anonymous mapping), thp (transparent huge"    \
+                  "~~pages), huge (explicit huge pages), shm (shared memory"   \
+                  "~~segment). NODE: a node number or local, the first node"   \
+                  "~~binds send buffers and the second receive buffers"        \
+                  "~~(collective buffers use the first)."                      \
+                  "~~-M thp:0,1 //THP, send on node 0, receive on node 1"},    \
+            {'F', "FILE - trace to replay, one event per line:"                \
+                  "~~RANK OP PEER|ROOT|- BYTES GAP_US, where OP is send,"      \
+                  "~~recv, isend, irecv, waitall, barrier, bcast, reduce,"     \
+                  "~~allreduce, gather, scatter, allgather or alltoall;"       \
+                  "~~a line phase NAME starts a new phase on all ranks"},      \
+            {'g', "FACTOR - scale the compute gaps of the trace by FACTOR"     \
+                  "~~(0 drops them). Default: 1"},                             \
+            {'n', "R0,R1,... - replay trace rank i on MPI rank Ri."            \
+                  "~~A path instead reads the ranks from that file."           \
+                  "~~-n 3,2,1,0 //reverse four ranks"},                        \
+            {'e', "LIST - collectives to tune: bcast, reduce, allreduce,"      \
+                  "~~gather, scatter, allgather, alltoall."                    \
+                  "~~Default: bcast,allreduce"},                               \
+            {'E', "LIST - segment sizes in bytes to try with every"            \
+                  "~~algorithm, 0 leaves the library default."                 \
+                  "~~Default: 0,8192,65536"},                                  \
+            {'O', "PREFIX - write the Open MPI dynamic rules to PREFIX.rules"  \
+                  "~~and the decision table to PREFIX.json."                   \
+                  "~~Default: osu_tune"},                                      \
+            {'U', "ALGO[:SEGMENT] - time a user-level reference"               \
+                  "~~implementation of the collective, built on point to"      \
+                  "~~point calls, instead of the MPI library's."               \
+                  "~~bcast: binomial, chain, split_binary (SEGMENT bytes"      \
+                  "~~per pipelined message, default 8192, 0 for none)."        \
+                  "~~scatter, gather: binomial, linear."                       \
+                  "~~allreduce: ring (SEGMENT bytes per block and phase,"      \
+                  "~~default whole blocks), recursive_doubling,"               \
+                  "~~rabenseifner. alltoall: bruck, pairwise"},                \
         {                                                                      \
             'k', "Set root rank. Default: fixed:0"                             \
                  "~~-k fixed:[RANK] //Fixed root rank."                        \
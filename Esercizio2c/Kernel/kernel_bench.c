@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <complex.h>
+#include <omp.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#else
+#define HAVE_TSC 0
+#endif
+
+#include "../MPI/mandelbrot.h"
+
+// Signature shared by every kernel under test: computes one row of iteration counts
+typedef void (*row_kernel)(double imag, double x_l, double delta_x, int xsize, int max_iter, int *out);
+
+static void row_complex(double imag, double x_l, double delta_x, int xsize, int max_iter, int *out){
+
+    for (int xx = 0; xx < xsize; xx++){
+        double complex c = (x_l + xx * delta_x) + imag * I;
+        out[xx] = mandelbrot(c, max_iter);
+    }
+}
+
+static void row_real(double imag, double x_l, double delta_x, int xsize, int max_iter, int *out){
+
+    for (int xx = 0; xx < xsize; xx++){
+        out[xx] = mandelbrot_real(x_l + xx * delta_x, imag, max_iter);
+    }
+}
+
+static const struct {
+    const char *name;
+    row_kernel kernel;
+} kernels[] = {
+    {"complex",   row_complex},     // mandelbrot() used by the renderers, the reference
+    {"real",      row_real},
+    {"simd",      mandelbrot_row_simd},
+};
+
+// Fixed views stressing the three regimes of the escape-time loop
+static const struct {
+    const char *name;
+    double xl, yl, xr, yr;
+} views[] = {
+    {"interior",  -0.50, -0.25,  0.10,  0.25},     // mostly inside the main cardioid: max_iter iterations per pixel
+    {"boundary",  -0.78,  0.06, -0.72,  0.12},     // seahorse valley: long and divergent escape times
+    {"exterior",   0.50, -1.50,  2.00,  1.50},     // almost everything escapes within a few iterations
+    {"full",      -2.00, -1.50,  1.00,  1.50},     // the view of the scaling runs
+};
+
+#define NKERNELS (int)(sizeof(kernels) / sizeof(kernels[0]))
+#define NVIEWS (int)(sizeof(views) / sizeof(views[0]))
+
+static inline unsigned long long read_tsc(void){
+#if HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Function that renders the view with a kernel, rows distributed dynamically over the threads
+static void render(row_kernel kernel, int xsize, int ysize, int max_iter, double xl, double yl, double xr, double yr, int *image){
+
+    const double delta_x = (xr - xl) / xsize;
+    const double delta_y = (yr - yl) / ysize;
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int yy = 0; yy < ysize; yy++){
+        kernel(yl + yy * delta_y, xl, delta_x, xsize, max_iter, image + (size_t)yy * xsize);
+    }
+}
+
+int main(int argc, char **argv){
+
+    const int xsize = (argc > 1) ? atoi(argv[1]) : 512;
+    const int ysize = (argc > 2) ? atoi(argv[2]) : 512;
+    const int max_iter = (argc > 3) ? atoi(argv[3]) : 1024;
+    const int repetitions = (argc > 4) ? atoi(argv[4]) : 3;
+
+    const int threads = omp_get_max_threads();
+    const size_t pixels = (size_t)xsize * ysize;
+
+    int *reference = malloc(pixels * sizeof(int));
+    int *image = malloc(pixels * sizeof(int));
+    long long total_mismatches = 0;
+
+    printf("# Mandelbrot kernel benchmark: %dx%d, max_iter %d, %d threads, best of %d\n", xsize, ysize, max_iter, threads, repetitions);
+    printf("# cycles/iter are TSC cycles%s\n", HAVE_TSC ? "" : " (not available on this architecture)");
+    printf("%-10s %-10s %14s %12s %12s %14s %12s\n", "view", "kernel", "Giter/s/core", "ns/pixel", "cycles/iter", "iter/pixel", "mismatches");
+
+    for (int v = 0; v < NVIEWS; v++){
+
+        render(kernels[0].kernel, xsize, ysize, max_iter, views[v].xl, views[v].yl, views[v].xr, views[v].yr, reference);
+
+        // Iterations actually executed: n for an escaping pixel, max_iter + 1 for one in the set
+        long long iterations = 0;
+        #pragma omp parallel for reduction(+:iterations)
+        for (size_t i = 0; i < pixels; i++){
+            iterations += (reference[i] == 0) ? max_iter + 1 : reference[i];
+        }
+
+        for (int k = 0; k < NKERNELS; k++){
+
+            double best = 1e30;
+            unsigned long long best_cycles = 0;
+
+            for (int r = 0; r < repetitions; r++){
+
+                unsigned long long c0 = read_tsc();
+                double t0 = omp_get_wtime();
+                render(kernels[k].kernel, xsize, ysize, max_iter, views[v].xl, views[v].yl, views[v].xr, views[v].yr, image);
+                double elapsed = omp_get_wtime() - t0;
+                unsigned long long cycles = read_tsc() - c0;
+
+                if (elapsed < best){
+                    best = elapsed;
+                    best_cycles = cycles;
+                }
+            }
+
+            long long mismatches = 0;
+            for (size_t i = 0; i < pixels; i++) mismatches += (image[i] != reference[i]);
+            total_mismatches += mismatches;
+
+            printf("%-10s %-10s %14.4f %12.2f %12.2f %14.1f %12lld\n", views[v].name, kernels[k].name,
+                   iterations / (best * threads) * 1e-9,
+                   best * threads * 1e9 / pixels,
+                   (double)best_cycles * threads / iterations,
+                   (double)iterations / pixels,
+                   mismatches);
+        }
+    }
+
+    free(reference);
+    free(image);
+
+    // A kernel that disagrees with the reference fails the run, so that scripts can check it
+    if (total_mismatches > 0){
+        fprintf(stderr, "%lld pixels differ from the reference kernel\n", total_mismatches);
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,14 +1,33 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <complex.h>
 #include <time.h>
+#include <sched.h>
 #include <mpi.h>
 #include <omp.h>
 
+#include "mandelbrot.h"
+#include "gather_compress.h"
+#include "supersample.h"
+#include "buddhabrot.h"
+#include "placement.h"
+#include "render_service.h"
+#include "perf_counters.h"
+#include "tile_send.h"
+#include "checkpoint.h"
+#include "colorize.h"
+#include "distance.h"
+
 // Function that writes the image xsize*ysize with a color depth depending on the value of I_max
-void write_pgm_image(void *image, int maxval, int xsize, int ysize, const char *image_name){
+int write_pgm_image(void *image, int maxval, int xsize, int ysize, const char *image_name){
     
     FILE* image_file = fopen(image_name, "w");
+    if (image_file == NULL){
+        perror(image_name);
+        return -1;
+    }
     
     int color_depth = (maxval < 256) ? sizeof(char) : sizeof(short int);
     
@@ -18,30 +37,47 @@ void write_pgm_image(void *image, int maxval, int xsize, int ysize, const char *
     
     fclose(image_file);
 
-    return ;
+    return 0;
 }
 
-// Function computing the Mandelbrot set
-int mandelbrot(double complex c, int max_iter){
-    
-    double complex z = 0 + 0 * I;
-    int n = 0;
+// Function that computes the pixels of image row yy
+static inline void gradient_row(void *pixel, int yy, int start_row, int xsize, double x_l, double y_l, double delta_x, double delta_y, int max_iter){
 
-    while (n <= max_iter && cabs(z) < 2){
-        
-        z = z * z + c;
-        n++;
-    
+    double imag = y_l + yy * delta_y;
+
+    for (int xx = 0; xx < xsize; xx++){
+
+        double real = x_l + xx * delta_x;
+
+        double complex c = real + imag * I;
+
+        int iter = mandelbrot(c, max_iter);
+
+        int idx = (yy - start_row)* xsize + xx;
+
+        if (max_iter < 256){
+            ((char*)pixel)[idx] = (char)(iter);
+        } else {
+           ((short int*)pixel)[idx] = (short int)(iter); 
+        }
     }
-    
-    return (cabs(z) >= 2) ? n : 0;
+}
+
+// Function that computes row yy unless a previous run already saved it in the checkpoint
+static inline void checkpointed_row(void *pixel, int yy, int start_row, int xsize, double x_l, double y_l, double delta_x, double delta_y, int max_iter, checkpoint *ckpt){
+
+    if (checkpoint_restore_row(ckpt, yy - start_row)) return;
+
+    gradient_row(pixel, yy, start_row, xsize, x_l, y_l, delta_x, delta_y, max_iter);
+    checkpoint_row_computed(ckpt, yy - start_row);
 }
 
 // Function that assigns a specific value for each pixel according to the Mandelbrot function output
-void *generate_gradient(int xsize, int ysize, int start_row, int end_row, double complex c_L, double complex c_R, int max_iter){
+void *generate_gradient(int xsize, int ysize, int start_row, int end_row, double complex c_L, double complex c_R, int max_iter, perf_session *perf, int runtime_schedule, checkpoint *ckpt){
     
     size_t image_size = (max_iter < 256) ? sizeof(char) : sizeof(short int);
     void *pixel = malloc((end_row - start_row)* xsize * image_size);
+    checkpoint_attach(ckpt, pixel);
 
     const double x_l = creal(c_L), x_r = creal(c_R);
     const double y_l = cimag(c_L), y_r = cimag(c_R);
@@ -54,6 +90,10 @@ void *generate_gradient(int xsize, int ysize, int start_row, int end_row, double
     //omp_set_num_threads(2);
     #pragma omp parallel
     {
+        // Hardware counters of this thread, when profiling is enabled
+        int perf_fds[PERF_NEVENTS][PERF_MAX_FP_EVENTS];
+        perf_thread_start(perf, perf_fds);
+
         int myid = omp_get_thread_num();
         int total_threads = omp_get_num_threads();
 
@@ -66,68 +106,98 @@ void *generate_gradient(int xsize, int ysize, int start_row, int end_row, double
         int mystart = start_row + myid * sizet + ((myid < remt) ? myid : remt);
         int myend = mystart + sizet + (myid < remt ? 1 : 0);
 
-        #pragma omp parallel for schedule(dynamic) shared(pixel) private(yy,xx)
-        for (int yy = mystart; yy < myend; yy++ ){
-
-            double imag = y_l + yy * delta_y;
-
-            for (int xx = 0; xx < xsize; xx++){
+        if (runtime_schedule){
 
-                double real = x_l + xx * delta_x;
+            // Rows handed out with the policy set by --schedule instead of the fixed split.
+            // First touch goes through the same schedule, so that with a static policy every
+            // row is zeroed by the thread that later computes it
+            #pragma omp for schedule(runtime)
+            for (int yy = start_row; yy < end_row; yy++){
+                memset((char*)pixel + (size_t)(yy - start_row) * xsize * image_size, 0, (size_t)xsize * image_size);
+            }
 
-                double complex c = real + imag * I;
+            #pragma omp for schedule(runtime)
+            for (int yy = start_row; yy < end_row; yy++){
+                checkpointed_row(pixel, yy, start_row, xsize, x_l, y_l, delta_x, delta_y, max_iter, ckpt);
+            }
 
-                int iter = mandelbrot(c, max_iter);
+        } else {
 
-                int idx = (yy - start_row)* xsize + xx;
+            // First touch of the rows this thread writes, so that their pages land on its NUMA node
+            memset((char*)pixel + (size_t)(mystart - start_row) * xsize * image_size, 0, (size_t)(myend - mystart) * xsize * image_size);
 
-                if (max_iter < 256){
-                    ((char*)pixel)[idx] = (char)(iter);
-                } else {
-                   ((short int*)pixel)[idx] = (short int)(iter); 
-                }
+            #pragma omp parallel for schedule(dynamic) shared(pixel) private(yy,xx)
+            for (int yy = mystart; yy < myend; yy++ ){
+                checkpointed_row(pixel, yy, start_row, xsize, x_l, y_l, delta_x, delta_y, max_iter, ckpt);
             }
-        }       
+        }
 
+        perf_thread_stop(perf, perf_fds);
     }
 
     return pixel;
 }
 
-int main(int argc, char **argv){
-    
-    // Hybrid code initialization
-    int mpi_provided_thread_level; 
-    MPI_Init_thread( &argc, &argv, MPI_THREAD_FUNNELED, &mpi_provided_thread_level); 
-    if ( mpi_provided_thread_level < MPI_THREAD_FUNNELED ) { 
-        printf("a problem arise when asking for MPI_THREAD_FUNNELED level\n"); 
-        MPI_Finalize(); 
-        exit( 1 ); 
-    }    
+// View parameters handed to gradient_tile by the threaded tile render
+typedef struct {
+    int xsize, max_iter;
+    double x_l, y_l, delta_x, delta_y;
+} gradient_view;
+
+// Function that computes rows [first_row, first_row + rows) into buffer
+static void gradient_tile(void *buffer, int first_row, int rows, void *context){
+
+    const gradient_view *view = context;
+
+    for (int yy = first_row; yy < first_row + rows; yy++){
+        gradient_row(buffer, yy, first_row, view->xsize, view->x_l, view->y_l, view->delta_x, view->delta_y, view->max_iter);
+    }
+}
+
+// Settings of the escape-time pipeline that do not depend on the view
+typedef struct {
+    int compress_rows;          // --compress[=ROWS]: encode the gather in blocks of ROWS rows
+    int aa_samples;             // --aa[=N[:T]]: supersample N x N the pixels differing by more than T from a neighbour
+    int aa_threshold;
+    enum bind_policy bind;      // --bind=compact|scatter: pin the OpenMP threads of every rank
+    int perf;                   // --perf: read the hardware counters of every thread around the compute phase
+    int schedule;               // --schedule=static|dynamic|guided[:CHUNK]: OpenMP policy for the rows
+    int thread_send;            // --thread-send[=ROWS]: every thread sends its tiles of ROWS rows (needs MPI_THREAD_MULTIPLE)
+    double checkpoint;          // --checkpoint[=SECONDS]: save the computed rows in the background every SECONDS
+    int restart;                // --restart: reuse the rows saved by an interrupted run of the same render
+} render_settings;
+
+// Statistics of one escape-time render (meaningful on rank 0)
+typedef struct {
+    supersample_stats aa;
+    compress_stats gather;
+    tile_send_stats tiles;
+    double gather_time;         // time rank 0 spent gathering after its compute phase
+} render_stats;
+
+// Function that renders the view with all the ranks of comm and returns the full image on rank 0 (NULL elsewhere)
+void *render_view(int xsize, int ysize, double complex c_L, double complex c_R, int max_iter, const render_settings *settings, render_stats *stats, MPI_Comm comm){
 
-    // Definition of the communicator group for MPI 
     int size, rank;
-    MPI_Comm_size(MPI_COMM_WORLD, &size);
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(comm, &size);
+    MPI_Comm_rank(comm, &rank);
 
-    //printf("Process ID: %d of %d total processes\n", rank, size);
+    // Tiles are sent by the threads that compute them, overlapping the gather with the compute phase
+    if (settings->thread_send > 0){
 
-    // Input arguments reading
-    double real_xl = atof(argv[3]);
-    double real_yl = atof(argv[4]);
-    double real_xr = atof(argv[5]);
-    double real_yr = atof(argv[6]);
+        perf_session perf;
+        perf_init(&perf, settings->perf);
 
-    const int xsize = atoi(argv[1]);
-    const int ysize = atoi(argv[2]);
-    
-    const int max_iter = atoi(argv[7]);
+        gradient_view view = {xsize, max_iter, creal(c_L), cimag(c_L), (creal(c_R) - creal(c_L)) / xsize, (cimag(c_R) - cimag(c_L)) / ysize};
+        void *image = render_tiles_multiple(xsize, ysize, (max_iter < 256) ? sizeof(char) : sizeof(short int), settings->thread_send,
+                                            gradient_tile, &view, &perf, settings->schedule, 0, comm, &stats->tiles);
 
-    const double complex c_L = real_xl + (real_yl * I);
-    const double complex c_R = real_xr + (real_yr * I);
- 
-    clock_t start_time;
-    if (rank == 0) start_time = clock();
+        perf_report(&perf, 0, comm);
+        perf_free(&perf);
+        stats->gather_time = stats->tiles.exposed_time;
+
+        return image;
+    }
 
     // Each process calculates the number of rows it will handle
     const int rows_per_P = ysize / size;
@@ -135,9 +205,28 @@ int main(int argc, char **argv){
     int start_row = rank * rows_per_P + ((rank < rem) ? rank : rem);
     int end_row = start_row + rows_per_P + (rank < rem ? 1 : 0); 
 
+    // Rows saved by the background checkpoints of this rank
+    checkpoint *ckpt = NULL;
+    if (settings->checkpoint > 0){
+        checkpoint_key key = {xsize, ysize, max_iter, rank, size, creal(c_L), cimag(c_L), creal(c_R), cimag(c_R)};
+        ckpt = checkpoint_open("mandelbrot.ckpt", &key, end_row - start_row, xsize * ((max_iter < 256) ? sizeof(char) : sizeof(short int)),
+                               settings->checkpoint, settings->restart);
+    }
+
     // Each process computes its portion of the image
-    void *local_image = generate_gradient(xsize, ysize, start_row, end_row, c_L, c_R, max_iter);
+    perf_session perf;
+    perf_init(&perf, settings->perf);
+
+    void *local_image = generate_gradient(xsize, ysize, start_row, end_row, c_L, c_R, max_iter, &perf, settings->schedule, ckpt);
+
+    perf_report(&perf, 0, comm);
+    perf_free(&perf);
     int local_image_size = (end_row - start_row)* xsize * ((max_iter < 256) ? sizeof(char) : sizeof(short int));
+
+    // Anti-aliasing of the pixels lying on an edge of the base image
+    if (settings->aa_samples > 1){
+        adaptive_supersample(local_image, xsize, ysize, start_row, end_row, c_L, c_R, max_iter, settings->aa_samples, settings->aa_threshold, comm, &stats->aa);
+    }
     
     // Rank 0 will gather local images of other ranks
     void *final_image = NULL;
@@ -147,6 +236,12 @@ int main(int argc, char **argv){
     if (rank == 0) {
         final_image = malloc(xsize * ysize * ((max_iter < 256) ? sizeof(char) : sizeof(short int)));
 
+        // The master thread receives and writes the image, so it places the buffer on its own node
+        memset(final_image, 0, xsize * ysize * ((max_iter < 256) ? sizeof(char) : sizeof(short int)));
+        if (settings->bind != BIND_NONE){
+            printf("Gather buffer on NUMA node %d, master thread on node %d\n", page_node(final_image), cpu_node(sched_getcpu()));
+        }
+
         recv_counts = malloc(size * sizeof(int));
         offset = malloc(size * sizeof(int));
 
@@ -168,12 +263,267 @@ int main(int argc, char **argv){
     }
     
     // Gather results from all processes
-    MPI_Gatherv(local_image, local_image_size, MPI_BYTE, final_image, recv_counts, offset, MPI_BYTE, 0, MPI_COMM_WORLD);
+    double gather_start = MPI_Wtime();
+    if (settings->compress_rows > 0){
+        compressed_gatherv(local_image, end_row - start_row, final_image, recv_counts, offset, xsize, (max_iter < 256) ? sizeof(char) : sizeof(short int), settings->compress_rows, 0, comm, &stats->gather);
+    } else {
+        MPI_Gatherv(local_image, local_image_size, MPI_BYTE, final_image, recv_counts, offset, MPI_BYTE, 0, comm);
+    }
+    stats->gather_time = MPI_Wtime() - gather_start;
+
+    if (settings->checkpoint > 0) checkpoint_close(ckpt, 0, comm);
     
     free(local_image);
     free(recv_counts);
     free(offset);
 
+    return final_image;
+}
+
+// Function serving one request of the render service: every rank renders, rank 0 writes the image
+int serve_render(const render_request *request, void *context){
+
+    const render_settings *settings = context;
+    render_stats stats;
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    void *image = render_view(request->xsize, request->ysize, request->xl + request->yl * I, request->xr + request->yr * I,
+                              request->max_iter, settings, &stats, MPI_COMM_WORLD);
+
+    int status = 0;
+    if (rank == 0){
+        status = write_pgm_image(image, request->max_iter, request->xsize, request->ysize, request->output);
+        free(image);
+    }
+
+    return status;
+}
+
+int main(int argc, char **argv){
+    
+    // Hybrid code initialization: threads sending their own tiles need MPI_THREAD_MULTIPLE
+    int thread_level = MPI_THREAD_FUNNELED;
+    for (int i = 1; i < argc; i++){
+        if (strncmp(argv[i], "--thread-send", 13) == 0) thread_level = MPI_THREAD_MULTIPLE;
+    }
+
+    int mpi_provided_thread_level; 
+    MPI_Init_thread( &argc, &argv, thread_level, &mpi_provided_thread_level); 
+    if ( mpi_provided_thread_level < MPI_THREAD_FUNNELED ) { 
+        printf("a problem arise when asking for MPI_THREAD_FUNNELED level\n"); 
+        MPI_Finalize(); 
+        exit( 1 ); 
+    }    
+
+    // Definition of the communicator group for MPI 
+    int size, rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    //printf("Process ID: %d of %d total processes\n", rank, size);
+
+    // Input arguments reading (the view can be omitted in service mode, where each request brings its own)
+    const int positional = (argc > 7 && strncmp(argv[1], "--", 2) != 0);
+
+    double real_xl = positional ? atof(argv[3]) : 0.0;
+    double real_yl = positional ? atof(argv[4]) : 0.0;
+    double real_xr = positional ? atof(argv[5]) : 0.0;
+    double real_yr = positional ? atof(argv[6]) : 0.0;
+
+    const int xsize = positional ? atoi(argv[1]) : 0;
+    const int ysize = positional ? atoi(argv[2]) : 0;
+    
+    const int max_iter = positional ? atoi(argv[7]) : 0;
+
+    // Optional arguments following the positional ones
+    render_settings settings = {0, 0, AA_THRESHOLD, BIND_NONE, 0, 0, 0, 0.0, 0};
+    long long buddha_samples = 0;   // --buddhabrot[=SAMPLES]: render the orbit density instead of the escape time
+    int buddha_importance = 1;      // --uniform: sample c uniformly instead of following the pilot density
+    const char *service_path = NULL;    // --serve=PATH: stay alive and render the requests sent to a UNIX socket
+    int calibrate = 0;                  // --calibrate: time the render only, without writing the image or the CSV
+    int color = 0;                      // --color: write a smooth, histogram-equalized RGB image instead of the PGM
+    int distance = 0;                   // --distance: shade the distance to the set instead of the escape time
+
+    for (int i = positional ? 8 : 1; i < argc; i++){
+        if (strcmp(argv[i], "--compress") == 0){
+            settings.compress_rows = COMPRESS_BLOCK_ROWS;
+        } else if (strncmp(argv[i], "--compress=", 11) == 0){
+            settings.compress_rows = atoi(argv[i] + 11);
+        } else if (strcmp(argv[i], "--aa") == 0){
+            settings.aa_samples = AA_SAMPLES;
+        } else if (strncmp(argv[i], "--aa=", 5) == 0){
+            settings.aa_samples = atoi(argv[i] + 5);
+            char *colon = strchr(argv[i], ':');
+            if (colon != NULL) settings.aa_threshold = atoi(colon + 1);
+        } else if (strcmp(argv[i], "--buddhabrot") == 0){
+            buddha_samples = BUDDHA_SAMPLES;
+        } else if (strncmp(argv[i], "--buddhabrot=", 13) == 0){
+            buddha_samples = atoll(argv[i] + 13);
+        } else if (strcmp(argv[i], "--uniform") == 0){
+            buddha_importance = 0;
+        } else if (strncmp(argv[i], "--bind=", 7) == 0){
+            settings.bind = parse_bind_policy(argv[i] + 7);
+            if (settings.bind == BIND_INVALID){
+                if (rank == 0) printf("Unknown binding %s, use --bind=compact or --bind=scatter\n", argv[i] + 7);
+                MPI_Finalize();
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--perf") == 0){
+            settings.perf = 1;
+        } else if (strncmp(argv[i], "--schedule=", 11) == 0){
+            const char *kind = argv[i] + 11;
+            const char *colon = strchr(kind, ':');
+            int chunk = (colon != NULL) ? atoi(colon + 1) : 0;
+            settings.schedule = 1;
+            if (strncmp(kind, "static", 6) == 0) omp_set_schedule(omp_sched_static, chunk);
+            else if (strncmp(kind, "dynamic", 7) == 0) omp_set_schedule(omp_sched_dynamic, chunk);
+            else if (strncmp(kind, "guided", 6) == 0) omp_set_schedule(omp_sched_guided, chunk);
+            else settings.schedule = 0;
+        } else if (strcmp(argv[i], "--thread-send") == 0){
+            settings.thread_send = TILE_ROWS;
+        } else if (strncmp(argv[i], "--thread-send=", 14) == 0){
+            settings.thread_send = atoi(argv[i] + 14);
+        } else if (strcmp(argv[i], "--checkpoint") == 0){
+            settings.checkpoint = CKPT_INTERVAL;
+        } else if (strncmp(argv[i], "--checkpoint=", 13) == 0){
+            settings.checkpoint = atof(argv[i] + 13);
+        } else if (strcmp(argv[i], "--restart") == 0){
+            settings.restart = 1;
+            if (settings.checkpoint == 0) settings.checkpoint = CKPT_INTERVAL;
+        } else if (strcmp(argv[i], "--distance") == 0){
+            distance = 1;
+        } else if (strcmp(argv[i], "--color") == 0){
+            color = 1;
+        } else if (strcmp(argv[i], "--calibrate") == 0){
+            calibrate = 1;
+        } else if (strncmp(argv[i], "--serve=", 8) == 0){
+            service_path = argv[i] + 8;
+        } else if (rank == 0){
+            printf("Unknown option %s ignored\n", argv[i]);
+        }
+    }
+
+    // The funneled gather time is only reported to compare it with --thread-send, or with --perf
+    int report_gather = settings.thread_send > 0 || settings.perf;
+
+    // Without MPI_THREAD_MULTIPLE only the master thread may communicate
+    if (settings.thread_send > 0 && mpi_provided_thread_level < MPI_THREAD_MULTIPLE){
+        if (rank == 0) printf("MPI_THREAD_MULTIPLE not provided, falling back to the funneled gather\n");
+        settings.thread_send = 0;
+    }
+
+    // Supersampling, compression and checkpoints work on the whole local block, so they keep the funneled gather
+    if (settings.thread_send > 0 && (settings.aa_samples > 1 || settings.compress_rows > 0 || settings.checkpoint > 0)){
+        if (rank == 0) printf("--thread-send ignored together with --aa, --compress or --checkpoint\n");
+        settings.thread_send = 0;
+    }
+
+    const double complex c_L = real_xl + (real_yl * I);
+    const double complex c_R = real_xr + (real_yr * I);
+ 
+    // Thread placement, done before any buffer is touched
+    if (settings.bind != BIND_NONE){
+        if (bind_threads(settings.bind) != 0) printf("Rank %d: could not pin its threads\n", rank);
+        report_topology(settings.bind, 0, MPI_COMM_WORLD);
+    }
+
+    // Resident service mode: MPI stays initialized and the buffers warm between renders
+    if (service_path != NULL){
+
+        int served = serve_requests(service_path, serve_render, &settings, 0, MPI_COMM_WORLD);
+        if (rank == 0) printf("Render service stopped after %d requests\n", served);
+
+        MPI_Finalize();
+        return (served < 0) ? 1 : 0;
+    }
+
+    if (!positional){
+        if (rank == 0) printf("Usage: %s xsize ysize xl yl xr yr max_iter [options] | --serve=PATH [options]\n", argv[0]);
+        MPI_Finalize();
+        return 1;
+    }
+
+    clock_t start_time;
+    if (rank == 0) start_time = clock();
+
+    // Orbit-density rendering mode
+    if (buddha_samples > 0){
+
+        buddhabrot_stats bstats;
+        float *histogram = generate_buddhabrot(xsize, ysize, c_L, c_R, max_iter, buddha_samples, buddha_importance, 0, MPI_COMM_WORLD, &bstats);
+
+        if (rank == 0){
+
+            void *image = buddhabrot_to_image(histogram, xsize, ysize, (max_iter < 256) ? 255 : 65535);
+            write_pgm_image(image, (max_iter < 256) ? 255 : 65535, xsize, ysize, "buddhabrot.pgm");
+            free(image);
+            free(histogram);
+
+            printf("Buddhabrot: %lld samples, %lld orbits, %s sampling (pilot %.4f s), %.2f s, %.3e samples/s per core\n",
+                   bstats.samples, bstats.orbits, buddha_importance ? "importance" : "uniform", bstats.pilot_time,
+                   bstats.time, bstats.samples / (bstats.time * size * bstats.threads));
+        }
+
+        MPI_Finalize();
+        return 0;
+    }
+
+    // Colorized rendering mode: the palette is applied by every rank before the gather
+    if (color){
+
+        colorize_stats cstats;
+        unsigned char *image = render_colorized(xsize, ysize, c_L, c_R, max_iter, 0, MPI_COMM_WORLD, &cstats);
+
+        if (rank == 0){
+
+            write_ppm_image(image, xsize, ysize, "mandelbrot.ppm");
+            free(image);
+
+            printf("Color: %lld escaping pixels equalized, compute %.4f s, histogram and palette %.4f s, gather %.4f s\n",
+                   cstats.escaped, cstats.compute_time, cstats.color_time, cstats.gather_time);
+        }
+
+        MPI_Finalize();
+        return 0;
+    }
+
+    // Distance-estimation rendering mode
+    if (distance){
+
+        distance_stats dstats;
+        unsigned char *image = render_distance(xsize, ysize, c_L, c_R, max_iter, 0, MPI_COMM_WORLD, &dstats);
+
+        if (rank == 0){
+
+            write_pgm_image(image, 255, xsize, ysize, "distance.pgm");
+            free(image);
+
+            printf("Distance: %lld tiles of %dx%d, %lld skipped as background, %lld skipped as interior, %.4f s\n",
+                   dstats.tiles, DE_TILE, DE_TILE, dstats.exterior_skipped, dstats.interior_skipped, dstats.time);
+        }
+
+        MPI_Finalize();
+        return 0;
+    }
+
+    // Each process computes its portion of the image and rank 0 gathers it
+    render_stats stats;
+    MPI_Barrier(MPI_COMM_WORLD);
+    double wall_start = MPI_Wtime();
+
+    void *final_image = render_view(xsize, ysize, c_L, c_R, max_iter, &settings, &stats, MPI_COMM_WORLD);
+
+    // Calibration runs of the auto-tuner only report the wall time of the render
+    if (calibrate){
+        if (rank == 0){
+            printf("Calibration: %.6f\n", MPI_Wtime() - wall_start);
+            free(final_image);
+        }
+        MPI_Finalize();
+        return 0;
+    }
+
     // Rank 0 process writes the final image to a file
     if (rank == 0){
         
@@ -192,6 +542,27 @@ int main(int argc, char **argv){
         }
 
         printf("Time: %.2f\n", elapsed_time);
+
+        if (settings.aa_samples > 1){
+            printf("Anti-aliasing: %lld edge pixels (%.2f%% of the image) at %dx%d samples, max %lld per rank, %.4f s\n",
+                   stats.aa.edge_pixels, 100.0 * stats.aa.edge_pixels / ((double)xsize * ysize),
+                   settings.aa_samples, settings.aa_samples, stats.aa.max_work, stats.aa.time);
+        }
+
+        if (settings.compress_rows > 0){
+            printf("Gather: %s, %lld -> %lld bytes (ratio %.2f), encode %.4f s, decode %.4f s\n",
+                   stats.gather.used ? "compressed" : "raw fallback", stats.gather.raw_bytes, stats.gather.sent_bytes,
+                   stats.gather.sent_bytes > 0 ? (double)stats.gather.raw_bytes / stats.gather.sent_bytes : 1.0,
+                   stats.gather.encode_time, stats.gather.decode_time);
+        }
+
+        if (settings.thread_send > 0){
+            printf("Thread send: %d tiles of %d rows, %.4f s in MPI_Send over all threads, %.1f%% overlapped with compute, %.4f s exposed after compute\n",
+                   stats.tiles.tiles, stats.tiles.tile_rows, stats.tiles.send_time,
+                   stats.tiles.send_time > 0 ? 100.0 * stats.tiles.hidden_time / stats.tiles.send_time : 0.0, stats.tiles.exposed_time);
+        } else if (report_gather){
+            printf("Funneled gather: %.4f s exposed after compute\n", stats.gather_time);
+        }
         
         
         
@@ -0,0 +1,111 @@
+#!/bin/bash
+
+# Auto-tuned hybrid render.
+#
+#   ./autotune.sh [--force] [--tune-only] CORES xsize ysize xl yl xr yr max_iter [render options]
+#
+# Looks up the best MPI ranks x OMP_NUM_THREADS split, OpenMP row schedule and thread binding
+# for this machine and problem class in the tuning file; if there is none (or with --force) it runs short calibration
+# renders of every combination at a quarter of the resolution and stores the fastest one.
+# The render is then launched with the stored configuration (unless --tune-only).
+#
+# The machine is identified by the node name without its number and the number of cores,
+# the problem class by log2 of the number of pixels and log2 of max_iter.
+
+TUNING_FILE=${TUNING_FILE:-tuning.txt}
+RENDER=${RENDER:-./MPI_scaling}
+SCHEDULES=${SCHEDULES:-"static static:1 dynamic:1 dynamic:4 dynamic:16 guided:1 guided:4"}
+BINDS=${BINDS:-"compact scatter"}
+
+force=0
+tune_only=0
+while [[ "$1" == --* ]]; do
+	case "$1" in
+		--force) force=1 ;;
+		--tune-only) tune_only=1 ;;
+		*) echo "Unknown option $1"; exit 1 ;;
+	esac
+	shift
+done
+
+if [ $# -lt 8 ]; then
+	echo "Usage: $0 [--force] [--tune-only] CORES xsize ysize xl yl xr yr max_iter [render options]"
+	exit 1
+fi
+
+cores=$1; xsize=$2; ysize=$3; xl=$4; yl=$5; xr=$6; yr=$7; max_iter=$8
+shift 8
+extra="$@"
+
+log2(){
+	local n=$1 bits=0
+	while [ $n -gt 1 ]; do n=$((n / 2)); bits=$((bits + 1)); done
+	echo $bits
+}
+
+machine="$(hostname -s | sed 's/[0-9]*$//')-${cores}c"
+class="p$(log2 $((xsize * ysize)))_i$(log2 $max_iter)"
+
+# Launches the renderer with the given split, schedule and binding
+launch(){
+	local ranks=$1 threads=$2 schedule=$3 bind=$4
+	shift 4
+	OMP_NUM_THREADS=$threads mpirun -np $ranks --map-by slot:PE=$threads --bind-to core \
+		$RENDER "$@" --bind=$bind --schedule=$schedule
+}
+
+# Entries without a binding field come from before it was tuned and are calibrated again
+entry=$(awk -v m="$machine" -v c="$class" '$1 == m && $2 == c && NF == 7' "$TUNING_FILE" 2>/dev/null | tail -n 1)
+
+if [ -z "$entry" ] || [ $force -eq 1 ]; then
+
+	cx=$((xsize / 4)); cy=$((ysize / 4))
+	[ $cx -lt 64 ] && cx=64
+	[ $cy -lt 64 ] && cy=64
+
+	echo "Tuning $machine / $class with ${cx}x${cy} calibration renders..."
+
+	best=""
+	best_time=""
+
+	for ((ranks = 1; ranks <= cores; ranks++)); do
+
+		[ $((cores % ranks)) -ne 0 ] && continue
+		threads=$((cores / ranks))
+
+		for schedule in $SCHEDULES; do
+			for bind in $BINDS; do
+
+				t=$(launch $ranks $threads $schedule $bind $cx $cy $xl $yl $xr $yr $max_iter --calibrate $extra 2>/dev/null \
+					| awk '/^Calibration:/ {print $2}')
+
+				if [ -z "$t" ]; then
+					echo "  $ranks x $threads $schedule $bind: failed"
+					continue
+				fi
+
+				echo "  $ranks x $threads $schedule $bind: $t s"
+
+				if [ -z "$best_time" ] || awk -v a="$t" -v b="$best_time" 'BEGIN {exit !(a < b)}'; then
+					best="$ranks $threads $schedule $bind"
+					best_time=$t
+				fi
+			done
+		done
+	done
+
+	if [ -z "$best" ]; then
+		echo "No calibration run succeeded"
+		exit 1
+	fi
+
+	entry="$machine $class $best $best_time"
+	echo "$entry" >> "$TUNING_FILE"
+fi
+
+read -r _ _ ranks threads schedule bind seconds <<< "$entry"
+echo "Using $ranks ranks x $threads threads, schedule $schedule, binding $bind (calibrated at $seconds s)"
+
+[ $tune_only -eq 1 ] && exit 0
+
+launch $ranks $threads $schedule $bind $xsize $ysize $xl $yl $xr $yr $max_iter $extra
@@ -0,0 +1,264 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <complex.h>
+#include <mpi.h>
+#include <omp.h>
+
+#include "buddhabrot.h"
+
+// Every orbit of a point in the disk of radius 2 stays within it, so c is sampled from this square
+#define SAMPLE_MIN -2.0
+#define SAMPLE_SPAN 4.0
+
+// Samples handed to a thread at a time
+#define SAMPLE_CHUNK 4096
+
+// Per-thread xorshift64* generator
+static inline double next_uniform(uint64_t *state){
+
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+
+    return (double)((x * 0x2545F4914F6CDD1DULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static uint64_t seed_for(int rank, int thread, int stream){
+
+    uint64_t s = 0x9E3779B97F4A7C15ULL * (uint64_t)(rank * 1024 + thread + 1) + (uint64_t)stream;
+    s ^= s >> 31;
+
+    return s ? s : 1;
+}
+
+// Points of the main cardioid and of the period-2 bulb never escape, no need to iterate them
+static inline int surely_inside(double cr, double ci){
+
+    double q = (cr - 0.25) * (cr - 0.25) + ci * ci;
+    if (q * (q + (cr - 0.25)) <= 0.25 * ci * ci) return 1;
+
+    return ((cr + 1.0) * (cr + 1.0) + ci * ci <= 0.0625);
+}
+
+// Function that iterates c and stores its orbit; returns the escape iteration, or 0 if c did not escape
+static inline int orbit(double cr, double ci, int max_iter, double *orbit_re, double *orbit_im){
+
+    double zr = 0.0, zi = 0.0;
+
+    for (int n = 0; n < max_iter; n++){
+
+        double zr2 = zr * zr, zi2 = zi * zi;
+        if (zr2 + zi2 >= 4.0) return n;
+
+        zi = 2.0 * zr * zi + ci;
+        zr = zr2 - zi2 + cr;
+        orbit_re[n] = zr;
+        orbit_im[n] = zi;
+    }
+
+    return 0;
+}
+
+// Function that builds the cumulative sampling density over the pilot grid: every cell is weighted
+// by the orbit length of its escaping pilot points (plus a floor so that no cell has zero probability).
+static double *build_density(int max_iter, int rank, int size, MPI_Comm comm){
+
+    const int cells = BUDDHA_GRID * BUDDHA_GRID;
+    const double cell = SAMPLE_SPAN / BUDDHA_GRID;
+    double *weight = calloc(cells, sizeof(double));
+
+    #pragma omp parallel
+    {
+        uint64_t state = seed_for(rank, omp_get_thread_num(), 1);
+        double *zr = malloc(max_iter * sizeof(double));
+        double *zi = malloc(max_iter * sizeof(double));
+
+        #pragma omp for schedule(dynamic, 16)
+        for (int k = rank; k < cells; k += size){
+
+            double x0 = SAMPLE_MIN + (k % BUDDHA_GRID) * cell;
+            double y0 = SAMPLE_MIN + (k / BUDDHA_GRID) * cell;
+
+            for (int s = 0; s < BUDDHA_PILOT_SAMPLES; s++){
+
+                double cr = x0 + next_uniform(&state) * cell;
+                double ci = y0 + next_uniform(&state) * cell;
+                if (!surely_inside(cr, ci)) weight[k] += orbit(cr, ci, max_iter, zr, zi);
+            }
+        }
+
+        free(zr);
+        free(zi);
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, weight, cells, MPI_DOUBLE, MPI_SUM, comm);
+
+    double total = 0.0;
+    for (int k = 0; k < cells; k++) total += weight[k];
+
+    const double floor_weight = 0.01 * (total > 0.0 ? total : 1.0) / cells;
+    double *cdf = malloc(cells * sizeof(double));
+
+    double acc = 0.0;
+    for (int k = 0; k < cells; k++){
+        acc += weight[k] + floor_weight;
+        cdf[k] = acc;
+    }
+    for (int k = 0; k < cells; k++) cdf[k] /= acc;
+
+    free(weight);
+
+    return cdf;
+}
+
+static inline int pick_cell(const double *cdf, int cells, double u){
+
+    int lo = 0, hi = cells - 1;
+    while (lo < hi){
+        int mid = (lo + hi) / 2;
+        if (cdf[mid] < u) lo = mid + 1;
+        else hi = mid;
+    }
+
+    return lo;
+}
+
+float *generate_buddhabrot(int xsize, int ysize, double complex c_L, double complex c_R, int max_iter,
+                           long long samples, int importance, int root, MPI_Comm comm, buddhabrot_stats *stats){
+
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    const double x_l = creal(c_L), y_l = cimag(c_L);
+    const double scale_x = xsize / (creal(c_R) - x_l);
+    const double scale_y = ysize / (cimag(c_R) - y_l);
+    const size_t pixels = (size_t)xsize * ysize;
+    const int cells = BUDDHA_GRID * BUDDHA_GRID;
+
+    double t0 = MPI_Wtime();
+
+    double *cdf = importance ? build_density(max_iter, rank, size, comm) : NULL;
+
+    stats->pilot_time = MPI_Wtime() - t0;
+
+    const long long my_samples = samples / size + (rank < samples % size ? 1 : 0);
+    const int nthreads = omp_get_max_threads();
+
+    float **hist = calloc(nthreads, sizeof(float*));
+    long long my_orbits = 0;
+
+    #pragma omp parallel reduction(+:my_orbits)
+    {
+        const int tid = omp_get_thread_num();
+        const int nt = omp_get_num_threads();
+
+        // Private histogram, first touched by the thread that fills it
+        hist[tid] = calloc(pixels, sizeof(float));
+        float *h = hist[tid];
+
+        uint64_t state = seed_for(rank, tid, 2);
+        double *zr = malloc(max_iter * sizeof(double));
+        double *zi = malloc(max_iter * sizeof(double));
+
+        #pragma omp for schedule(dynamic, 1)
+        for (long long chunk = 0; chunk < my_samples; chunk += SAMPLE_CHUNK){
+
+            long long chunk_end = (chunk + SAMPLE_CHUNK < my_samples) ? chunk + SAMPLE_CHUNK : my_samples;
+
+            for (long long s = chunk; s < chunk_end; s++){
+
+                double cr, ci;
+                float w = 1.0f;
+
+                if (importance){
+                    int k = pick_cell(cdf, cells, next_uniform(&state));
+                    double p = cdf[k] - (k > 0 ? cdf[k - 1] : 0.0);
+                    cr = SAMPLE_MIN + ((k % BUDDHA_GRID) + next_uniform(&state)) * (SAMPLE_SPAN / BUDDHA_GRID);
+                    ci = SAMPLE_MIN + ((k / BUDDHA_GRID) + next_uniform(&state)) * (SAMPLE_SPAN / BUDDHA_GRID);
+                    w = (float)(1.0 / (p * cells));
+                } else {
+                    cr = SAMPLE_MIN + next_uniform(&state) * SAMPLE_SPAN;
+                    ci = SAMPLE_MIN + next_uniform(&state) * SAMPLE_SPAN;
+                }
+
+                if (surely_inside(cr, ci)) continue;
+
+                int n = orbit(cr, ci, max_iter, zr, zi);
+                if (n == 0) continue;
+
+                my_orbits++;
+
+                for (int j = 0; j < n - 1; j++){
+
+                    int px = (int)((zr[j] - x_l) * scale_x);
+                    int py = (int)((zi[j] - y_l) * scale_y);
+                    if (px >= 0 && px < xsize && py >= 0 && py < ysize) h[(size_t)py * xsize + px] += w;
+                }
+            }
+        }
+
+        free(zr);
+        free(zi);
+
+        // Tree reduction of the private histograms: at every level thread t adds thread t + step
+        for (int step = 1; step < nt; step *= 2){
+
+            #pragma omp barrier
+            if (tid % (2 * step) == 0 && tid + step < nt){
+
+                float *src = hist[tid + step];
+                for (size_t i = 0; i < pixels; i++) h[i] += src[i];
+            }
+        }
+    }
+
+    free(cdf);
+
+    float *histogram = (rank == root) ? malloc(pixels * sizeof(float)) : NULL;
+    MPI_Reduce(hist[0], histogram, (int)pixels, MPI_FLOAT, MPI_SUM, root, comm);
+
+    for (int t = 0; t < nthreads; t++) free(hist[t]);
+    free(hist);
+
+    double my_time = MPI_Wtime() - t0;
+
+    stats->samples = samples;
+    stats->threads = nthreads;
+    MPI_Reduce(&my_orbits, &stats->orbits, 1, MPI_LONG_LONG, MPI_SUM, root, comm);
+    MPI_Reduce(&my_time, &stats->time, 1, MPI_DOUBLE, MPI_MAX, root, comm);
+
+    return histogram;
+}
+
+void *buddhabrot_to_image(const float *histogram, int xsize, int ysize, int maxval){
+
+    const size_t pixels = (size_t)xsize * ysize;
+    const int pixel_size = (maxval < 256) ? sizeof(char) : sizeof(short int);
+    void *image = malloc(pixels * pixel_size);
+
+    float top = 0.0f;
+    #pragma omp parallel for reduction(max:top)
+    for (size_t i = 0; i < pixels; i++){
+        if (histogram[i] > top) top = histogram[i];
+    }
+
+    #pragma omp parallel for
+    for (size_t i = 0; i < pixels; i++){
+
+        int value = (top > 0.0f) ? (int)(maxval * sqrtf(histogram[i] / top)) : 0;
+
+        if (pixel_size == 1){
+            ((unsigned char*)image)[i] = (unsigned char)value;
+        } else {
+            ((unsigned short*)image)[i] = (unsigned short)value;
+        }
+    }
+
+    return image;
+}
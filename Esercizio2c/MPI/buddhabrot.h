@@ -0,0 +1,36 @@
+#ifndef BUDDHABROT_H
+#define BUDDHABROT_H
+
+#include <complex.h>
+#include <mpi.h>
+
+// Default number of sampled c values over the whole job
+#define BUDDHA_SAMPLES 10000000LL
+
+// Cells per axis of the pilot grid used to build the importance sampling density
+#define BUDDHA_GRID 128
+
+// Random points tried in every pilot cell
+#define BUDDHA_PILOT_SAMPLES 8
+
+// Statistics of an orbit-density render (meaningful on the root rank)
+typedef struct {
+    long long samples;      // sampled c values over all ranks
+    long long orbits;       // escaping orbits that were accumulated
+    int threads;            // OpenMP threads per rank
+    double pilot_time;      // time spent building the sampling density
+    double time;            // slowest rank time, pilot and reductions included
+} buddhabrot_stats;
+
+// Function that renders the orbit density of the c values escaping within max_iter iterations over
+// the view [c_L, c_R]. Every thread accumulates into a private histogram, the histograms are merged
+// with a tree reduction inside the rank and an MPI_Reduce across ranks. With importance != 0 the
+// samples follow a density built from a pilot pass, with contributions weighted back to uniform.
+// Returns the xsize*ysize histogram on root (NULL elsewhere).
+float *generate_buddhabrot(int xsize, int ysize, double complex c_L, double complex c_R, int max_iter,
+                           long long samples, int importance, int root, MPI_Comm comm, buddhabrot_stats *stats);
+
+// Function that maps the histogram to gray levels in [0, maxval] with a square root tone curve
+void *buddhabrot_to_image(const float *histogram, int xsize, int ysize, int maxval);
+
+#endif
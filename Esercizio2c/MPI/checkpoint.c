@@ -0,0 +1,303 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <mpi.h>
+#include <omp.h>
+
+#include "checkpoint.h"
+
+#define CKPT_MAGIC 0x504b434du    // "MCKP"
+
+// Rows of the data area start on a page boundary
+#define CKPT_ALIGN 4096
+
+// Life of a local row: computed rows are saved by the next checkpoint, restorable rows come from a previous run
+enum row_state { ROW_PENDING, ROW_COMPUTED, ROW_WRITING, ROW_SAVED, ROW_RESTORABLE };
+
+// File layout: [magic][key][one flag byte per row][padding][rows]
+// A flag is set only after the data of its row reached the disk, so a killed writer never leaves a row half saved.
+struct checkpoint {
+    int fd;
+    char path[CKPT_PATH_LEN];
+    int rows;
+    size_t row_bytes;
+    off_t flags_offset, data_offset;
+    double interval;
+
+    char *buffer;
+    unsigned char *state;
+    unsigned char *flags;
+
+    pthread_t writer;
+    int writer_running;
+    int stop;
+    int failed;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+
+    // Statistics
+    int checkpoints;
+    long long rows_saved;
+    long long rows_restored;
+    double write_time;
+};
+
+static int pwrite_all(int fd, const void *data, size_t bytes, off_t offset){
+
+    while (bytes > 0){
+        ssize_t n = pwrite(fd, data, bytes, offset);
+        if (n < 0){
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        data = (const char*)data + n;
+        bytes -= n;
+        offset += n;
+    }
+
+    return 0;
+}
+
+static int pread_all(int fd, void *data, size_t bytes, off_t offset){
+
+    while (bytes > 0){
+        ssize_t n = pread(fd, data, bytes, offset);
+        if (n <= 0){
+            if (n < 0 && errno == EINTR) continue;
+            return -1;
+        }
+        data = (char*)data + n;
+        bytes -= n;
+        offset += n;
+    }
+
+    return 0;
+}
+
+// Function that saves every row computed since the last call: the data first, then the flags
+static void flush_rows(checkpoint *ckpt){
+
+    double t0 = omp_get_wtime();
+    int first = -1, last = -1;
+    long long saved = 0;
+
+    for (int r = 0; r < ckpt->rows && !ckpt->failed; ){
+
+        if (__atomic_load_n(&ckpt->state[r], __ATOMIC_ACQUIRE) != ROW_COMPUTED){
+            r++;
+            continue;
+        }
+
+        // Consecutive computed rows are written with a single call
+        int end = r;
+        while (end < ckpt->rows && __atomic_load_n(&ckpt->state[end], __ATOMIC_ACQUIRE) == ROW_COMPUTED){
+            ckpt->state[end] = ROW_WRITING;
+            end++;
+        }
+
+        if (pwrite_all(ckpt->fd, ckpt->buffer + (size_t)r * ckpt->row_bytes, (size_t)(end - r) * ckpt->row_bytes,
+                       ckpt->data_offset + (off_t)r * ckpt->row_bytes) != 0){
+            perror(ckpt->path);
+            ckpt->failed = 1;
+        }
+
+        if (first < 0) first = r;
+        last = end;
+        saved += end - r;
+        r = end;
+    }
+
+    if (saved == 0 || ckpt->failed) return;
+
+    fdatasync(ckpt->fd);
+
+    for (int r = first; r < last; r++){
+        if (ckpt->state[r] == ROW_WRITING){
+            ckpt->flags[r] = 1;
+            ckpt->state[r] = ROW_SAVED;
+        }
+    }
+
+    if (pwrite_all(ckpt->fd, ckpt->flags + first, last - first, ckpt->flags_offset + first) != 0){
+        perror(ckpt->path);
+        ckpt->failed = 1;
+        return;
+    }
+    fdatasync(ckpt->fd);
+
+    ckpt->checkpoints++;
+    ckpt->rows_saved += saved;
+    ckpt->write_time += omp_get_wtime() - t0;
+}
+
+// Background thread: sleeps interval seconds between two flushes, so the compute threads never wait on the disk
+static void *writer_main(void *arg){
+
+    checkpoint *ckpt = arg;
+
+    pthread_mutex_lock(&ckpt->lock);
+    while (!ckpt->stop){
+
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += (time_t)ckpt->interval;
+        deadline.tv_nsec += (long)((ckpt->interval - (time_t)ckpt->interval) * 1e9);
+        if (deadline.tv_nsec >= 1000000000L){
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+
+        while (!ckpt->stop && pthread_cond_timedwait(&ckpt->wake, &ckpt->lock, &deadline) != ETIMEDOUT);
+        if (ckpt->stop) break;
+
+        pthread_mutex_unlock(&ckpt->lock);
+        flush_rows(ckpt);
+        pthread_mutex_lock(&ckpt->lock);
+    }
+    pthread_mutex_unlock(&ckpt->lock);
+
+    return NULL;
+}
+
+// Fields compared one by one, the padding of the key is not initialized
+static int same_key(const checkpoint_key *a, const checkpoint_key *b){
+
+    return a->xsize == b->xsize && a->ysize == b->ysize && a->max_iter == b->max_iter && a->rank == b->rank && a->size == b->size
+        && a->xl == b->xl && a->yl == b->yl && a->xr == b->xr && a->yr == b->yr;
+}
+
+checkpoint *checkpoint_open(const char *prefix, const checkpoint_key *key, int rows, size_t row_bytes, double interval, int restart){
+
+    checkpoint *ckpt = calloc(1, sizeof(checkpoint));
+    snprintf(ckpt->path, sizeof(ckpt->path), "%s.%d", prefix, key->rank);
+
+    ckpt->rows = rows;
+    ckpt->row_bytes = row_bytes;
+    ckpt->interval = (interval > 0) ? interval : CKPT_INTERVAL;
+    ckpt->flags_offset = sizeof(unsigned int) + sizeof(checkpoint_key);
+    ckpt->data_offset = (ckpt->flags_offset + rows + CKPT_ALIGN - 1) / CKPT_ALIGN * CKPT_ALIGN;
+    ckpt->state = calloc(rows > 0 ? rows : 1, 1);
+    ckpt->flags = calloc(rows > 0 ? rows : 1, 1);
+    pthread_mutex_init(&ckpt->lock, NULL);
+    pthread_cond_init(&ckpt->wake, NULL);
+
+    ckpt->fd = open(ckpt->path, O_RDWR | O_CREAT, 0644);
+    if (ckpt->fd < 0){
+        perror(ckpt->path);
+        free(ckpt->state);
+        free(ckpt->flags);
+        free(ckpt);
+        return NULL;
+    }
+
+    // A previous checkpoint is reused only if it belongs to the same render and the same rank
+    int reuse = 0;
+    if (restart){
+
+        unsigned int magic = 0;
+        checkpoint_key old;
+        reuse = pread_all(ckpt->fd, &magic, sizeof(magic), 0) == 0 && magic == CKPT_MAGIC
+             && pread_all(ckpt->fd, &old, sizeof(old), sizeof(magic)) == 0 && same_key(&old, key)
+             && pread_all(ckpt->fd, ckpt->flags, rows, ckpt->flags_offset) == 0;
+
+        if (!reuse) printf("Rank %d: no usable checkpoint in %s, starting from scratch\n", key->rank, ckpt->path);
+    }
+
+    if (reuse){
+        for (int r = 0; r < rows; r++) ckpt->state[r] = ckpt->flags[r] ? ROW_RESTORABLE : ROW_PENDING;
+    } else {
+
+        unsigned int magic = CKPT_MAGIC;
+        memset(ckpt->flags, 0, rows > 0 ? rows : 1);
+
+        if (ftruncate(ckpt->fd, 0) != 0
+         || pwrite_all(ckpt->fd, &magic, sizeof(magic), 0) != 0
+         || pwrite_all(ckpt->fd, key, sizeof(*key), sizeof(magic)) != 0
+         || pwrite_all(ckpt->fd, ckpt->flags, rows, ckpt->flags_offset) != 0
+         || ftruncate(ckpt->fd, ckpt->data_offset + (off_t)rows * row_bytes) != 0){
+            perror(ckpt->path);
+            ckpt->failed = 1;
+        }
+        fdatasync(ckpt->fd);
+    }
+
+    return ckpt;
+}
+
+void checkpoint_attach(checkpoint *ckpt, void *buffer){
+
+    if (ckpt == NULL) return;
+
+    ckpt->buffer = buffer;
+    ckpt->writer_running = !ckpt->failed && pthread_create(&ckpt->writer, NULL, writer_main, ckpt) == 0;
+}
+
+int checkpoint_restore_row(checkpoint *ckpt, int row){
+
+    if (ckpt == NULL || ckpt->state[row] != ROW_RESTORABLE) return 0;
+
+    if (pread_all(ckpt->fd, ckpt->buffer + (size_t)row * ckpt->row_bytes, ckpt->row_bytes, ckpt->data_offset + (off_t)row * ckpt->row_bytes) != 0){
+        ckpt->state[row] = ROW_PENDING;
+        return 0;
+    }
+
+    ckpt->state[row] = ROW_SAVED;
+    __atomic_fetch_add(&ckpt->rows_restored, 1, __ATOMIC_RELAXED);
+
+    return 1;
+}
+
+void checkpoint_row_computed(checkpoint *ckpt, int row){
+
+    if (ckpt != NULL) __atomic_store_n(&ckpt->state[row], ROW_COMPUTED, __ATOMIC_RELEASE);
+}
+
+void checkpoint_close(checkpoint *ckpt, int root, MPI_Comm comm){
+
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+
+    long long my_counts[3] = {0, 0, 0}, counts[3];
+    double my_time = 0.0, max_time;
+
+    if (ckpt != NULL){
+
+        if (ckpt->writer_running){
+            pthread_mutex_lock(&ckpt->lock);
+            ckpt->stop = 1;
+            pthread_cond_signal(&ckpt->wake);
+            pthread_mutex_unlock(&ckpt->lock);
+            pthread_join(ckpt->writer, NULL);
+        }
+
+        my_counts[0] = ckpt->rows_restored;
+        my_counts[1] = ckpt->rows_saved;
+        my_counts[2] = ckpt->checkpoints;
+        my_time = ckpt->write_time;
+    }
+
+    MPI_Reduce(my_counts, counts, 3, MPI_LONG_LONG, MPI_SUM, root, comm);
+    MPI_Reduce(&my_time, &max_time, 1, MPI_DOUBLE, MPI_MAX, root, comm);
+
+    if (rank == root){
+        printf("Checkpoint: %lld rows restored, %lld checkpoints saving %lld rows, %.4f s of background writes on the slowest rank\n",
+               counts[0], counts[2], counts[1], max_time);
+    }
+
+    if (ckpt == NULL) return;
+
+    // The render is complete, the checkpoint is not needed anymore
+    close(ckpt->fd);
+    unlink(ckpt->path);
+
+    pthread_mutex_destroy(&ckpt->lock);
+    pthread_cond_destroy(&ckpt->wake);
+    free(ckpt->state);
+    free(ckpt->flags);
+    free(ckpt);
+}
@@ -0,0 +1,41 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stddef.h>
+#include <mpi.h>
+
+// Default seconds between two background checkpoints
+#define CKPT_INTERVAL 60
+
+#define CKPT_PATH_LEN 256
+
+// Everything that must match for a checkpoint to be reused on restart
+typedef struct {
+    int xsize, ysize, max_iter;
+    int rank, size;
+    double xl, yl, xr, yr;
+} checkpoint_key;
+
+typedef struct checkpoint checkpoint;
+
+// Function that opens the checkpoint file of the calling rank for its rows local rows of row_bytes bytes.
+// With restart, the rows already saved in a file with the same key are marked as restorable;
+// otherwise, or when the key differs, the file starts empty. Returns NULL if the file cannot be opened.
+checkpoint *checkpoint_open(const char *prefix, const checkpoint_key *key, int rows, size_t row_bytes, double interval, int restart);
+
+// Function that sets the local image the rows are computed into and starts the background writer,
+// which every interval seconds saves the rows computed since the previous checkpoint
+void checkpoint_attach(checkpoint *ckpt, void *buffer);
+
+// Function that copies local row row from the checkpoint into the buffer if it was saved by a previous run;
+// returns 1 when the row was restored and needs no compute
+int checkpoint_restore_row(checkpoint *ckpt, int row);
+
+// Function that marks local row row as computed, so that the next checkpoint saves it
+void checkpoint_row_computed(checkpoint *ckpt, int row);
+
+// Function that stops the writer, prints on root the checkpoint statistics of all the ranks and,
+// the render being complete, removes the file
+void checkpoint_close(checkpoint *ckpt, int root, MPI_Comm comm);
+
+#endif
@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <mpi.h>
+#include <omp.h>
+
+#include "mandelbrot.h"
+#include "colorize.h"
+
+// Cosine gradient a + b cos(2 pi (t + d)): dark blue through white to orange over t in [0, 1]
+static void build_palette(unsigned char palette[PALETTE_SIZE][3]){
+
+    const double d[3] = {0.55, 0.45, 0.30};
+
+    for (int k = 0; k < PALETTE_SIZE; k++){
+
+        double t = 0.15 + 0.85 * k / (PALETTE_SIZE - 1);
+
+        for (int ch = 0; ch < 3; ch++){
+            palette[k][ch] = (unsigned char)(255.0 * (0.5 + 0.5 * cos(2.0 * M_PI * (t + d[ch]))));
+        }
+    }
+}
+
+unsigned char *render_colorized(int xsize, int ysize, double complex c_L, double complex c_R, int max_iter,
+                                int root, MPI_Comm comm, colorize_stats *stats){
+
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    // Same block of rows per rank as the escape-time render
+    const int rows_per_P = ysize / size;
+    const int rem = ysize % size;
+    const int start_row = rank * rows_per_P + ((rank < rem) ? rank : rem);
+    const int end_row = start_row + rows_per_P + (rank < rem ? 1 : 0);
+    const size_t local_pixels = (size_t)(end_row - start_row) * xsize;
+
+    const double x_l = creal(c_L), y_l = cimag(c_L);
+    const double delta_x = (creal(c_R) - x_l) / xsize;
+    const double delta_y = (cimag(c_R) - y_l) / ysize;
+
+    double t0 = MPI_Wtime();
+
+    float *mu = malloc((local_pixels > 0 ? local_pixels : 1) * sizeof(float));
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int yy = start_row; yy < end_row; yy++){
+
+        float *row = mu + (size_t)(yy - start_row) * xsize;
+        double imag = y_l + yy * delta_y;
+
+        for (int xx = 0; xx < xsize; xx++){
+            row[xx] = (float)mandelbrot_smooth(x_l + xx * delta_x, imag, max_iter);
+        }
+    }
+
+    double my_times[2];
+    my_times[0] = MPI_Wtime() - t0;
+    t0 = MPI_Wtime();
+
+    // Histogram of the integer part of the escape counts: one partial histogram per thread, merged bin by bin
+    const int nbins = max_iter + 2;
+    const int nthreads = omp_get_max_threads();
+    long long *partial = calloc((size_t)nthreads * nbins, sizeof(long long));
+    long long *histogram = malloc(nbins * sizeof(long long));
+
+    #pragma omp parallel
+    {
+        long long *mine = partial + (size_t)omp_get_thread_num() * nbins;
+
+        #pragma omp for schedule(static)
+        for (size_t i = 0; i < local_pixels; i++){
+            if (mu[i] <= 0.0f) continue;
+            // The smoothed count can run past max_iter + 1, such pixels share the last bin
+            int b = (int)mu[i];
+            mine[b < nbins - 1 ? b : nbins - 1]++;
+        }
+
+        #pragma omp for schedule(static)
+        for (int b = 0; b < nbins; b++){
+            long long sum = 0;
+            for (int t = 0; t < nthreads; t++) sum += partial[(size_t)t * nbins + b];
+            histogram[b] = sum;
+        }
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, histogram, nbins, MPI_LONG_LONG, MPI_SUM, comm);
+
+    // Equalization: cdf[b] is the fraction of escaping pixels whose count is at most b
+    double *cdf = malloc(nbins * sizeof(double));
+    long long escaped = 0;
+    for (int b = 0; b < nbins; b++) escaped += histogram[b];
+
+    long long running = 0;
+    for (int b = 0; b < nbins; b++){
+        running += histogram[b];
+        cdf[b] = (escaped > 0) ? (double)running / escaped : 0.0;
+    }
+
+    unsigned char palette[PALETTE_SIZE][3];
+    build_palette(palette);
+
+    // The fractional part of the count interpolates between the equalized levels of two bins
+    unsigned char *local_rgb = malloc((local_pixels > 0 ? local_pixels : 1) * 3);
+
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < local_pixels; i++){
+
+        unsigned char *px = local_rgb + 3 * i;
+
+        if (mu[i] <= 0.0f){
+            px[0] = px[1] = px[2] = 0;
+            continue;
+        }
+
+        int b = (int)mu[i];
+        if (b > nbins - 1) b = nbins - 1;
+        double lo = (b > 0) ? cdf[b - 1] : 0.0;
+        double t = lo + (cdf[b] - lo) * (mu[i] - b);
+        int k = (int)(t * (PALETTE_SIZE - 1));
+        if (k < 0) k = 0;
+        if (k > PALETTE_SIZE - 1) k = PALETTE_SIZE - 1;
+
+        px[0] = palette[k][0];
+        px[1] = palette[k][1];
+        px[2] = palette[k][2];
+    }
+
+    my_times[1] = MPI_Wtime() - t0;
+
+    free(mu);
+    free(partial);
+    free(histogram);
+    free(cdf);
+
+    double max_times[2];
+    MPI_Reduce(my_times, max_times, 2, MPI_DOUBLE, MPI_MAX, root, comm);
+
+    // Rank root collects the colored rows
+    t0 = MPI_Wtime();
+
+    unsigned char *image = NULL;
+    int *recv_counts = NULL, *offset = NULL;
+
+    if (rank == root){
+
+        image = malloc((size_t)xsize * ysize * 3);
+        recv_counts = malloc(size * sizeof(int));
+        offset = malloc(size * sizeof(int));
+
+        for (int i = 0; i < size; i++){
+            recv_counts[i] = (rows_per_P + (i < rem ? 1 : 0)) * xsize * 3;
+            offset[i] = (i * rows_per_P + ((i < rem) ? i : rem)) * xsize * 3;
+        }
+    }
+
+    MPI_Gatherv(local_rgb, (int)(local_pixels * 3), MPI_BYTE, image, recv_counts, offset, MPI_BYTE, root, comm);
+
+    stats->escaped = escaped;
+    stats->compute_time = max_times[0];
+    stats->color_time = max_times[1];
+    stats->gather_time = MPI_Wtime() - t0;
+
+    free(local_rgb);
+    free(recv_counts);
+    free(offset);
+
+    return image;
+}
+
+int write_ppm_image(const unsigned char *image, int xsize, int ysize, const char *image_name){
+
+    FILE *image_file = fopen(image_name, "wb");
+    if (image_file == NULL){
+        perror(image_name);
+        return -1;
+    }
+
+    fprintf(image_file, "P6\n%d %d\n255\n", xsize, ysize);
+    fwrite(image, 3, (size_t)xsize * ysize, image_file);
+
+    fclose(image_file);
+
+    return 0;
+}
@@ -0,0 +1,28 @@
+#ifndef COLORIZE_H
+#define COLORIZE_H
+
+#include <complex.h>
+#include <mpi.h>
+
+// Entries of the palette the equalized values are mapped to
+#define PALETTE_SIZE 1024
+
+// Statistics of a colorized render (meaningful on the root rank)
+typedef struct {
+    long long escaped;      // pixels outside the set, the ones the histogram is built on
+    double compute_time;    // slowest rank time computing the smooth escape counts
+    double color_time;      // slowest rank time building the histogram and coloring its rows
+    double gather_time;     // time to collect the RGB rows on root
+} colorize_stats;
+
+// Function that renders the view as RGB with smooth (fractional) escape counts and histogram equalization.
+// Every rank computes its block of rows, the iteration histogram is accumulated in per-thread partial
+// histograms and summed with MPI_Allreduce, then every rank colors its own rows before the gather.
+// Returns the xsize*ysize*3 image on root (NULL elsewhere).
+unsigned char *render_colorized(int xsize, int ysize, double complex c_L, double complex c_R, int max_iter,
+                                int root, MPI_Comm comm, colorize_stats *stats);
+
+// Function that writes an RGB image as a binary PPM; returns -1 if the file cannot be opened
+int write_ppm_image(const unsigned char *image, int xsize, int ysize, const char *image_name);
+
+#endif
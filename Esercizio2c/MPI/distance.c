@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <mpi.h>
+#include <omp.h>
+
+#include "mandelbrot.h"
+#include "distance.h"
+
+// Function that estimates the distance of n points, MANDEL_LANES at a time (the last group padded)
+static void distance_points(const double *cr, const double *ci, int n, int max_iter, double *out){
+
+    for (int i = 0; i < n; i += MANDEL_LANES){
+
+        double lr[MANDEL_LANES], li[MANDEL_LANES], ld[MANDEL_LANES];
+
+        for (int l = 0; l < MANDEL_LANES; l++){
+            int k = (i + l < n) ? i + l : n - 1;
+            lr[l] = cr[k];
+            li[l] = ci[k];
+        }
+
+        mandelbrot_distance_lanes(lr, li, max_iter, ld);
+
+        for (int l = 0; l < MANDEL_LANES && i + l < n; l++) out[i + l] = ld[l];
+    }
+}
+
+// Gray level of a distance: square root ramp from the set (0) to the saturation distance (255)
+static inline unsigned char shade(double d, double saturation){
+
+    double v = d / saturation;
+
+    return (v >= 1.0) ? 255 : (unsigned char)(255.0 * sqrt(v));
+}
+
+unsigned char *render_distance(int xsize, int ysize, double complex c_L, double complex c_R, int max_iter,
+                               int root, MPI_Comm comm, distance_stats *stats){
+
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    // Same block of rows per rank as the escape-time render
+    const int rows_per_P = ysize / size;
+    const int rem = ysize % size;
+    const int start_row = rank * rows_per_P + ((rank < rem) ? rank : rem);
+    const int end_row = start_row + rows_per_P + (rank < rem ? 1 : 0);
+
+    const double x_l = creal(c_L), y_l = cimag(c_L);
+    const double delta_x = (creal(c_R) - x_l) / xsize;
+    const double delta_y = (cimag(c_R) - y_l) / ysize;
+    const double saturation = DE_SAT_PIXELS * ((delta_x > delta_y) ? delta_x : delta_y);
+
+    const int tiles_x = (xsize + DE_TILE - 1) / DE_TILE;
+    const int tiles_y = (end_row - start_row + DE_TILE - 1) / DE_TILE;
+
+    unsigned char *local_image = malloc((size_t)(end_row > start_row ? end_row - start_row : 1) * xsize);
+    long long skipped[3] = {(long long)tiles_x * tiles_y, 0, 0};
+
+    double t0 = MPI_Wtime();
+
+    #pragma omp parallel reduction(+:skipped[1:2])
+    {
+        double cr[DE_TILE * DE_TILE], ci[DE_TILE * DE_TILE], d[DE_TILE * DE_TILE];
+        int index[DE_TILE * DE_TILE];
+
+        #pragma omp for schedule(dynamic)
+        for (int tile = 0; tile < tiles_x * tiles_y; tile++){
+
+            const int x0 = (tile % tiles_x) * DE_TILE;
+            const int y0 = start_row + (tile / tiles_x) * DE_TILE;
+            const int w = (xsize - x0 < DE_TILE) ? xsize - x0 : DE_TILE;
+            const int h = (end_row - y0 < DE_TILE) ? end_row - y0 : DE_TILE;
+            unsigned char *dst = local_image + (size_t)(y0 - start_row) * xsize + x0;
+
+            // Exterior: the true distance is at least a quarter of the estimate, so every pixel of the
+            // tile is at least d/4 - radius away from the set and shaded as background if that saturates
+            double center_r = x_l + (x0 + 0.5 * (w - 1)) * delta_x;
+            double center_i = y_l + (y0 + 0.5 * (h - 1)) * delta_y;
+            double center_d;
+            distance_points(&center_r, &center_i, 1, max_iter, &center_d);
+
+            double radius = 0.5 * sqrt((w * delta_x) * (w * delta_x) + (h * delta_y) * (h * delta_y));
+            if (0.25 * center_d - radius >= saturation){
+                for (int y = 0; y < h; y++) memset(dst + (size_t)y * xsize, 255, w);
+                skipped[1]++;
+                continue;
+            }
+
+            // Interior (Mariani-Silver): since the set is connected and full, a closed border lying in it
+            // would enclose only points of the set. Only the border pixels are sampled, and "in the set"
+            // means not escaped within max_iter, so this is a heuristic: a filament of the exterior
+            // passing between two samples would be painted black
+            int n = 0;
+            for (int y = 0; y < h; y++){
+                for (int x = 0; x < w; x++){
+                    if (y == 0 || y == h - 1 || x == 0 || x == w - 1){
+                        cr[n] = x_l + (x0 + x) * delta_x;
+                        ci[n] = y_l + (y0 + y) * delta_y;
+                        index[n++] = y * DE_TILE + x;
+                    }
+                }
+            }
+            const int border = n;
+            distance_points(cr, ci, border, max_iter, d);
+
+            int inside = 1;
+            for (int k = 0; k < border && inside; k++) inside = (d[k] == 0.0);
+
+            if (inside && w > 2 && h > 2){
+                for (int y = 0; y < h; y++) memset(dst + (size_t)y * xsize, 0, w);
+                skipped[2]++;
+                continue;
+            }
+
+            for (int k = 0; k < border; k++) dst[(index[k] / DE_TILE) * xsize + index[k] % DE_TILE] = shade(d[k], saturation);
+
+            // Inner pixels of a tile that needs them, in row order so the lanes hold neighbouring points
+            n = 0;
+            for (int y = 1; y < h - 1; y++){
+                for (int x = 1; x < w - 1; x++){
+                    cr[n] = x_l + (x0 + x) * delta_x;
+                    ci[n] = y_l + (y0 + y) * delta_y;
+                    index[n++] = y * DE_TILE + x;
+                }
+            }
+            distance_points(cr, ci, n, max_iter, d);
+
+            for (int k = 0; k < n; k++) dst[(index[k] / DE_TILE) * xsize + index[k] % DE_TILE] = shade(d[k], saturation);
+        }
+    }
+
+    double my_time = MPI_Wtime() - t0;
+
+    long long totals[3];
+    MPI_Reduce(skipped, totals, 3, MPI_LONG_LONG, MPI_SUM, root, comm);
+    MPI_Reduce(&my_time, &stats->time, 1, MPI_DOUBLE, MPI_MAX, root, comm);
+
+    stats->tiles = totals[0];
+    stats->exterior_skipped = totals[1];
+    stats->interior_skipped = totals[2];
+
+    // Rank root collects the rows
+    unsigned char *image = NULL;
+    int *recv_counts = NULL, *offset = NULL;
+
+    if (rank == root){
+
+        image = malloc((size_t)xsize * ysize);
+        recv_counts = malloc(size * sizeof(int));
+        offset = malloc(size * sizeof(int));
+
+        for (int i = 0; i < size; i++){
+            recv_counts[i] = (rows_per_P + (i < rem ? 1 : 0)) * xsize;
+            offset[i] = (i * rows_per_P + ((i < rem) ? i : rem)) * xsize;
+        }
+    }
+
+    MPI_Gatherv(local_image, (end_row - start_row) * xsize, MPI_BYTE, image, recv_counts, offset, MPI_BYTE, root, comm);
+
+    free(local_image);
+    free(recv_counts);
+    free(offset);
+
+    return image;
+}
@@ -0,0 +1,28 @@
+#ifndef DISTANCE_H
+#define DISTANCE_H
+
+#include <complex.h>
+#include <mpi.h>
+
+// Side in pixels of the square tiles the distance render is organized in
+#define DE_TILE 16
+
+// Distance, in pixels, from which a point is drawn as plain background
+#define DE_SAT_PIXELS 4.0
+
+// Statistics of a distance-estimation render (meaningful on the root rank)
+typedef struct {
+    long long tiles;            // tiles over the whole image
+    long long exterior_skipped; // tiles whose distance bound proves them background everywhere
+    long long interior_skipped; // tiles assumed inside because no border pixel escaped
+    double time;                // slowest rank time, before the gather
+} distance_stats;
+
+// Function that renders the view with the exterior distance estimator and returns an 8-bit image on root
+// (NULL elsewhere): black on the set, shading up to white at DE_SAT_PIXELS pixels from it. Each rank renders
+// its block of rows tile by tile; a tile is filled without iterating its pixels when the distance at its
+// center bounds every pixel away from the set, or, heuristically, when no pixel of its border escapes.
+unsigned char *render_distance(int xsize, int ysize, double complex c_L, double complex c_R, int max_iter,
+                               int root, MPI_Comm comm, distance_stats *stats);
+
+#endif
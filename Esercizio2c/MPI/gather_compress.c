@@ -0,0 +1,287 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <mpi.h>
+#include <omp.h>
+
+#include "gather_compress.h"
+
+// Flag marking a block that is stored raw in the payload because encoding did not pay off
+#define RAW_BLOCK 0x80000000u
+
+// Room left after the raw size so that the last token of an incompressible block fits
+#define TOKEN_SLACK 16
+
+// Reads pixel i as an unsigned value, whatever the color depth
+static inline unsigned int load_pixel(const void *image, size_t i, int pixel_size){
+
+    return (pixel_size == 1) ? ((const unsigned char*)image)[i] : ((const unsigned short*)image)[i];
+}
+
+static inline void store_pixel(void *image, size_t i, unsigned int value, int pixel_size){
+
+    if (pixel_size == 1){
+        ((unsigned char*)image)[i] = (unsigned char)value;
+    } else {
+        ((unsigned short*)image)[i] = (unsigned short)value;
+    }
+}
+
+// Payloads of different ranks are packed back to back, so header words may be unaligned
+static inline uint32_t read_u32(const unsigned char *src, size_t i){
+
+    uint32_t value;
+    memcpy(&value, src + i * sizeof(uint32_t), sizeof(uint32_t));
+
+    return value;
+}
+
+static inline size_t put_varint(unsigned char *dst, uint64_t value){
+
+    size_t n = 0;
+    while (value >= 0x80){
+        dst[n++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    dst[n++] = (unsigned char)value;
+
+    return n;
+}
+
+static inline uint64_t get_varint(const unsigned char *src, size_t *pos){
+
+    uint64_t value = 0;
+    int shift = 0;
+    unsigned char byte;
+    do {
+        byte = src[(*pos)++];
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    return value;
+}
+
+// Function that encodes n pixels as a stream of tokens: a run of pixels equal to the previous one
+// is stored as (run << 1) | 1, any other pixel as the zigzag delta from the previous one shifted by one.
+// Returns the encoded size, or 0 when the result would not be smaller than the raw block.
+static size_t encode_block(const void *src, size_t n, int pixel_size, unsigned char *dst){
+
+    const size_t raw_bytes = n * pixel_size;
+    unsigned int prev = 0;
+    size_t pos = 0, i = 0;
+
+    while (i < n){
+
+        unsigned int value = load_pixel(src, i, pixel_size);
+
+        if (value == prev){
+            size_t run = 1;
+            while (i + run < n && load_pixel(src, i + run, pixel_size) == prev) run++;
+            pos += put_varint(dst + pos, ((uint64_t)run << 1) | 1);
+            i += run;
+        } else {
+            int delta = (int)value - (int)prev;
+            uint64_t zigzag = (uint32_t)((delta << 1) ^ (delta >> 31));
+            pos += put_varint(dst + pos, zigzag << 1);
+            prev = value;
+            i++;
+        }
+
+        if (pos >= raw_bytes) return 0;
+    }
+
+    return pos;
+}
+
+static void decode_block(const unsigned char *src, size_t n, int pixel_size, void *dst){
+
+    unsigned int prev = 0;
+    size_t pos = 0, i = 0;
+
+    while (i < n){
+
+        uint64_t token = get_varint(src, &pos);
+
+        if (token & 1){
+            size_t run = token >> 1;
+            for (size_t k = 0; k < run; k++) store_pixel(dst, i + k, prev, pixel_size);
+            i += run;
+        } else {
+            uint32_t zigzag = (uint32_t)(token >> 1);
+            int delta = (int)(zigzag >> 1) ^ -(int)(zigzag & 1);
+            prev = (unsigned int)((int)prev + delta);
+            store_pixel(dst, i, prev, pixel_size);
+            i++;
+        }
+    }
+}
+
+// Function that encodes the local rows block by block in parallel and packs them as
+// [nblocks][length of each block][block data...]. Returns the payload size in bytes.
+static size_t encode_rows(const void *local_image, int local_rows, int xsize, int pixel_size, int block_rows, unsigned char **payload){
+
+    const int nblocks = (local_rows + block_rows - 1) / block_rows;
+    const size_t block_raw = (size_t)block_rows * xsize * pixel_size;
+    const size_t header = (size_t)(nblocks + 1) * sizeof(uint32_t);
+
+    unsigned char *scratch = malloc((size_t)nblocks * (block_raw + TOKEN_SLACK));
+    uint32_t *lengths = malloc((nblocks + 1) * sizeof(uint32_t));
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int b = 0; b < nblocks; b++){
+
+        int rows = (b == nblocks - 1) ? local_rows - b * block_rows : block_rows;
+        size_t n = (size_t)rows * xsize;
+        const char *src = (const char*)local_image + (size_t)b * block_raw;
+        unsigned char *dst = scratch + (size_t)b * (block_raw + TOKEN_SLACK);
+
+        size_t len = encode_block(src, n, pixel_size, dst);
+        lengths[b + 1] = (len == 0) ? (uint32_t)(n * pixel_size) | RAW_BLOCK : (uint32_t)len;
+    }
+    lengths[0] = (uint32_t)nblocks;
+
+    size_t total = header;
+    for (int b = 0; b < nblocks; b++) total += lengths[b + 1] & ~RAW_BLOCK;
+
+    *payload = malloc(total);
+    memcpy(*payload, lengths, header);
+
+    size_t pos = header;
+    for (int b = 0; b < nblocks; b++){
+
+        size_t len = lengths[b + 1] & ~RAW_BLOCK;
+        const void *src = (lengths[b + 1] & RAW_BLOCK) ? (const char*)local_image + (size_t)b * block_raw : (const void*)(scratch + (size_t)b * (block_raw + TOKEN_SLACK));
+        memcpy(*payload + pos, src, len);
+        pos += len;
+    }
+
+    free(scratch);
+    free(lengths);
+
+    return total;
+}
+
+typedef struct {
+    const unsigned char *src;
+    uint32_t length;
+    size_t pixels;
+    char *dst;
+} block_ref;
+
+void compressed_gatherv(const void *local_image, int local_rows, void *final_image,
+                        const int *recv_counts, const int *offset, int xsize, int pixel_size,
+                        int block_rows, int root, MPI_Comm comm, compress_stats *stats){
+
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    if (block_rows < 1) block_rows = COMPRESS_BLOCK_ROWS;
+
+    // The root already owns its rows, so only the other ranks encode and send
+    unsigned char *payload = NULL;
+    long long my_sizes[2] = {0, 0};
+
+    double t0 = MPI_Wtime();
+    if (rank != root && local_rows > 0){
+        my_sizes[0] = (long long)local_rows * xsize * pixel_size;
+        my_sizes[1] = (long long)encode_rows(local_image, local_rows, xsize, pixel_size, block_rows, &payload);
+    }
+    double my_encode_time = MPI_Wtime() - t0;
+
+    long long totals[2];
+    MPI_Allreduce(my_sizes, totals, 2, MPI_LONG_LONG, MPI_SUM, comm);
+    MPI_Reduce(&my_encode_time, &stats->encode_time, 1, MPI_DOUBLE, MPI_MAX, root, comm);
+
+    stats->raw_bytes = totals[0];
+    stats->used = (totals[0] > 0 && totals[1] < COMPRESS_MIN_GAIN * totals[0]);
+    stats->sent_bytes = stats->used ? totals[1] : totals[0];
+    stats->decode_time = 0.0;
+
+    if (!stats->used){
+
+        int my_bytes = local_rows * xsize * pixel_size;
+        MPI_Gatherv(local_image, my_bytes, MPI_BYTE, final_image, recv_counts, offset, MPI_BYTE, root, comm);
+        free(payload);
+        return;
+    }
+
+    int send_bytes = (int)my_sizes[1];
+    int *payload_counts = NULL, *payload_displs = NULL;
+    unsigned char *recv_payload = NULL;
+
+    if (rank == root){
+        payload_counts = malloc(size * sizeof(int));
+        payload_displs = malloc(size * sizeof(int));
+    }
+
+    MPI_Gather(&send_bytes, 1, MPI_INT, payload_counts, 1, MPI_INT, root, comm);
+
+    if (rank == root){
+        int displ = 0;
+        for (int i = 0; i < size; i++){
+            payload_displs[i] = displ;
+            displ += payload_counts[i];
+        }
+        recv_payload = malloc(displ > 0 ? displ : 1);
+    }
+
+    MPI_Gatherv(payload, send_bytes, MPI_BYTE, recv_payload, payload_counts, payload_displs, MPI_BYTE, root, comm);
+    free(payload);
+
+    if (rank == root){
+
+        t0 = MPI_Wtime();
+
+        memcpy((char*)final_image + offset[root], local_image, recv_counts[root]);
+
+        // Index every block of every rank, then decode them all in parallel
+        int nblocks = 0;
+        for (int i = 0; i < size; i++){
+            if (payload_counts[i] > 0) nblocks += read_u32(recv_payload + payload_displs[i], 0);
+        }
+
+        block_ref *blocks = malloc((nblocks > 0 ? nblocks : 1) * sizeof(block_ref));
+        int nb = 0;
+
+        for (int i = 0; i < size; i++){
+
+            if (payload_counts[i] == 0) continue;
+
+            const unsigned char *base = recv_payload + payload_displs[i];
+            const int rank_blocks = read_u32(base, 0);
+            const int rows = recv_counts[i] / (xsize * pixel_size);
+            size_t pos = (size_t)(rank_blocks + 1) * sizeof(uint32_t);
+
+            for (int b = 0; b < rank_blocks; b++){
+
+                int block_r = (b == rank_blocks - 1) ? rows - b * block_rows : block_rows;
+                blocks[nb].src = base + pos;
+                blocks[nb].length = read_u32(base, b + 1);
+                blocks[nb].pixels = (size_t)block_r * xsize;
+                blocks[nb].dst = (char*)final_image + offset[i] + (size_t)b * block_rows * xsize * pixel_size;
+                pos += blocks[nb].length & ~RAW_BLOCK;
+                nb++;
+            }
+        }
+
+        #pragma omp parallel for schedule(dynamic)
+        for (int b = 0; b < nb; b++){
+
+            if (blocks[b].length & RAW_BLOCK){
+                memcpy(blocks[b].dst, blocks[b].src, blocks[b].length & ~RAW_BLOCK);
+            } else {
+                decode_block(blocks[b].src, blocks[b].pixels, pixel_size, blocks[b].dst);
+            }
+        }
+
+        stats->decode_time = MPI_Wtime() - t0;
+
+        free(blocks);
+        free(recv_payload);
+        free(payload_counts);
+        free(payload_displs);
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef GATHER_COMPRESS_H
+#define GATHER_COMPRESS_H
+
+#include <mpi.h>
+
+// Default number of image rows encoded together in one block
+#define COMPRESS_BLOCK_ROWS 16
+
+// The compressed path is taken only if it sends less than this fraction of the raw bytes
+#define COMPRESS_MIN_GAIN 0.9
+
+// Statistics of a compressed gather (meaningful on the root rank)
+typedef struct {
+    int used;               // 1 if the encoded payload was sent, 0 if the raw fallback was used
+    long long raw_bytes;    // bytes the plain MPI_Gatherv would have moved
+    long long sent_bytes;   // bytes actually moved
+    double encode_time;     // slowest rank encoding time
+    double decode_time;     // root decoding time
+} compress_stats;
+
+// Gathers the row blocks of every rank on root like MPI_Gatherv with MPI_BYTE, but each
+// block of block_rows rows is delta + run-length encoded before being sent and decoded
+// by the root threads. recv_counts and offset are in bytes and only read on root.
+void compressed_gatherv(const void *local_image, int local_rows, void *final_image,
+                        const int *recv_counts, const int *offset, int xsize, int pixel_size,
+                        int block_rows, int root, MPI_Comm comm, compress_stats *stats);
+
+#endif
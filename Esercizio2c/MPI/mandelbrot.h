@@ -0,0 +1,161 @@
+#ifndef MANDELBROT_H
+#define MANDELBROT_H
+
+#include <complex.h>
+#include <math.h>
+
+// Function computing the Mandelbrot set
+static inline int mandelbrot(double complex c, int max_iter){
+    
+    double complex z = 0 + 0 * I;
+    int n = 0;
+
+    while (n <= max_iter && cabs(z) < 2){
+        
+        z = z * z + c;
+        n++;
+    
+    }
+    
+    return (cabs(z) >= 2) ? n : 0;
+}
+
+// Same iteration as mandelbrot() written with real arithmetic and the |z|^2 < 4 test
+static inline int mandelbrot_real(double cr, double ci, int max_iter){
+
+    double zr = 0.0, zi = 0.0;
+    double zr2 = 0.0, zi2 = 0.0;
+    int n = 0;
+
+    while (n <= max_iter && zr2 + zi2 < 4.0){
+
+        zi = 2.0 * zr * zi + ci;
+        zr = zr2 - zi2 + cr;
+        zr2 = zr * zr;
+        zi2 = zi * zi;
+        n++;
+
+    }
+
+    return (zr2 + zi2 >= 4.0) ? n : 0;
+}
+
+// Same iteration as mandelbrot_real() returning the fractional escape count n + 1 - log2(log2|z|),
+// continuous across the bands of the integer count; 0 for the points that do not escape
+static inline double mandelbrot_smooth(double cr, double ci, int max_iter){
+
+    double zr = 0.0, zi = 0.0;
+    double zr2 = 0.0, zi2 = 0.0;
+    int n = 0;
+
+    while (n <= max_iter && zr2 + zi2 < 4.0){
+
+        zi = 2.0 * zr * zi + ci;
+        zr = zr2 - zi2 + cr;
+        zr2 = zr * zr;
+        zi2 = zi * zi;
+        n++;
+
+    }
+
+    if (zr2 + zi2 < 4.0) return 0.0;
+
+    double mu = n + 1 - log2(0.5 * log2(zr2 + zi2));
+
+    return (mu < 1.0) ? 1.0 : mu;
+}
+
+// Number of pixels iterated together by mandelbrot_row_simd()
+#define MANDEL_LANES 8
+
+// Function computing a whole row of pixels imag*I + x_l + xx*delta_x, MANDEL_LANES at a time in SIMD lanes.
+// Lanes that escaped stop updating; the block ends when every lane escaped or reached max_iter.
+static inline void mandelbrot_row_simd(double imag, double x_l, double delta_x, int xsize, int max_iter, int *out){
+
+    for (int x0 = 0; x0 < xsize; x0 += MANDEL_LANES){
+
+        double cr[MANDEL_LANES], zr[MANDEL_LANES], zi[MANDEL_LANES];
+        int n[MANDEL_LANES];
+
+        #pragma omp simd
+        for (int l = 0; l < MANDEL_LANES; l++){
+            cr[l] = x_l + (x0 + l) * delta_x;
+            zr[l] = 0.0;
+            zi[l] = 0.0;
+            n[l] = 0;
+        }
+
+        for (int it = 0; it <= max_iter; it++){
+
+            int active = 0;
+
+            #pragma omp simd reduction(+:active)
+            for (int l = 0; l < MANDEL_LANES; l++){
+
+                double zr2 = zr[l] * zr[l], zi2 = zi[l] * zi[l];
+                int go = (zr2 + zi2 < 4.0);
+
+                double new_zi = 2.0 * zr[l] * zi[l] + imag;
+                double new_zr = zr2 - zi2 + cr[l];
+                zr[l] = go ? new_zr : zr[l];
+                zi[l] = go ? new_zi : zi[l];
+                n[l] += go;
+                active += go;
+            }
+
+            if (active == 0) break;
+        }
+
+        for (int l = 0; l < MANDEL_LANES && x0 + l < xsize; l++){
+            out[x0 + l] = (zr[l] * zr[l] + zi[l] * zi[l] >= 4.0) ? n[l] : 0;
+        }
+    }
+}
+
+// Squared escape radius of the distance estimator, large so that the estimate converges
+#define DE_BAILOUT 65536.0
+
+// Function estimating for MANDEL_LANES points cr + ci*I their distance to the set, iterating z and dz/dc
+// (dz' = 2 z dz + 1) in SIMD lanes: d = 2 |z| log|z| / |dz|, the true distance lying in [d/4, d].
+// Points still bounded after max_iter iterations get a distance of 0.
+static inline void mandelbrot_distance_lanes(const double *cr, const double *ci, int max_iter, double *out){
+
+    double zr[MANDEL_LANES], zi[MANDEL_LANES], dr[MANDEL_LANES], di[MANDEL_LANES];
+
+    #pragma omp simd
+    for (int l = 0; l < MANDEL_LANES; l++){
+        zr[l] = zi[l] = dr[l] = di[l] = 0.0;
+    }
+
+    for (int it = 0; it <= max_iter; it++){
+
+        int active = 0;
+
+        #pragma omp simd reduction(+:active)
+        for (int l = 0; l < MANDEL_LANES; l++){
+
+            double zr2 = zr[l] * zr[l], zi2 = zi[l] * zi[l];
+            int go = (zr2 + zi2 < DE_BAILOUT);
+
+            double new_dr = 2.0 * (zr[l] * dr[l] - zi[l] * di[l]) + 1.0;
+            double new_di = 2.0 * (zr[l] * di[l] + zi[l] * dr[l]);
+            double new_zi = 2.0 * zr[l] * zi[l] + ci[l];
+            double new_zr = zr2 - zi2 + cr[l];
+            dr[l] = go ? new_dr : dr[l];
+            di[l] = go ? new_di : di[l];
+            zr[l] = go ? new_zr : zr[l];
+            zi[l] = go ? new_zi : zi[l];
+            active += go;
+        }
+
+        if (active == 0) break;
+    }
+
+    for (int l = 0; l < MANDEL_LANES; l++){
+        double r2 = zr[l] * zr[l] + zi[l] * zi[l];
+        double dz2 = dr[l] * dr[l] + di[l] * di[l];
+        out[l] = (r2 >= DE_BAILOUT) ? sqrt(r2 / dz2) * log(r2) : 0.0;
+    }
+}
+
+#endif
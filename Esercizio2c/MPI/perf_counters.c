@@ -0,0 +1,211 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <mpi.h>
+#include <omp.h>
+
+#include "perf_counters.h"
+
+static const char *event_names[PERF_NEVENTS] = {"cycles", "instructions", "branch-misses", "fp-ops", "llc-misses"};
+
+// Raw double precision FP events: Intel FP_ARITH_INST_RETIRED (scalar, 128-bit and 256-bit packed)
+// and AMD Zen RETIRED_SSE_AVX_FLOPS, which already counts flops
+static const uint64_t intel_fp[PERF_MAX_FP_EVENTS] = {0x01c7, 0x04c7, 0x10c7};
+static const int intel_fp_weight[PERF_MAX_FP_EVENTS] = {1, 2, 4};
+static const uint64_t amd_fp[PERF_MAX_FP_EVENTS] = {0xff03, 0, 0};
+static const int amd_fp_weight[PERF_MAX_FP_EVENTS] = {1, 0, 0};
+
+static const uint64_t *fp_events = NULL;
+static const int *fp_weights = NULL;
+
+static void detect_vendor(void){
+
+    static int done = 0;
+    if (done) return;
+    done = 1;
+
+    FILE *f = fopen("/proc/cpuinfo", "r");
+    if (f == NULL) return;
+
+    char line[256];
+    while (fgets(line, sizeof(line), f) != NULL){
+        if (strncmp(line, "vendor_id", 9) != 0) continue;
+        if (strstr(line, "GenuineIntel") != NULL){
+            fp_events = intel_fp;
+            fp_weights = intel_fp_weight;
+        } else if (strstr(line, "AuthenticAMD") != NULL){
+            fp_events = amd_fp;
+            fp_weights = amd_fp_weight;
+        }
+        break;
+    }
+
+    fclose(f);
+}
+
+// Function that opens one counter for the calling thread on any CPU, disabled; returns -1 on failure
+static int open_counter(uint32_t type, uint64_t config){
+
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+// Reads a counter scaled up for the time it was multiplexed out
+static long long read_counter(int fd){
+
+    uint64_t data[3];
+    if (read(fd, data, sizeof(data)) != sizeof(data) || data[2] == 0) return -1;
+
+    return (long long)((double)data[0] * data[1] / data[2]);
+}
+
+void perf_init(perf_session *session, int enabled){
+
+    session->enabled = enabled;
+    session->nthreads = omp_get_max_threads();
+    session->values = NULL;
+
+    if (!enabled) return;
+
+    detect_vendor();
+    session->values = malloc(session->nthreads * sizeof(*session->values));
+    for (int t = 0; t < session->nthreads; t++){
+        for (int e = 0; e < PERF_NEVENTS; e++) session->values[t][e] = -1;
+    }
+}
+
+void perf_thread_start(perf_session *session, int fds[PERF_NEVENTS][PERF_MAX_FP_EVENTS]){
+
+    for (int e = 0; e < PERF_NEVENTS; e++){
+        for (int k = 0; k < PERF_MAX_FP_EVENTS; k++) fds[e][k] = -1;
+    }
+
+    if (!session->enabled) return;
+
+    fds[PERF_CYCLES][0] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    fds[PERF_INSTRUCTIONS][0] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fds[PERF_BRANCH_MISSES][0] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    fds[PERF_LLC_MISSES][0] = open_counter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+
+    for (int k = 0; fp_events != NULL && k < PERF_MAX_FP_EVENTS; k++){
+        if (fp_events[k] != 0) fds[PERF_FP_OPS][k] = open_counter(PERF_TYPE_RAW, fp_events[k]);
+    }
+
+    for (int e = 0; e < PERF_NEVENTS; e++){
+        for (int k = 0; k < PERF_MAX_FP_EVENTS; k++){
+            if (fds[e][k] < 0) continue;
+            ioctl(fds[e][k], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fds[e][k], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+void perf_thread_stop(perf_session *session, int fds[PERF_NEVENTS][PERF_MAX_FP_EVENTS]){
+
+    if (!session->enabled) return;
+
+    const int t = omp_get_thread_num();
+
+    for (int e = 0; e < PERF_NEVENTS; e++){
+
+        long long total = -1;
+
+        for (int k = 0; k < PERF_MAX_FP_EVENTS; k++){
+
+            if (fds[e][k] < 0) continue;
+
+            ioctl(fds[e][k], PERF_EVENT_IOC_DISABLE, 0);
+            long long value = read_counter(fds[e][k]);
+            close(fds[e][k]);
+
+            if (value < 0) continue;
+            if (e == PERF_FP_OPS) value *= fp_weights[k];
+            total = (total < 0) ? value : total + value;
+        }
+
+        if (t < session->nthreads) session->values[t][e] = total;
+    }
+}
+
+void perf_report(const perf_session *session, int root, MPI_Comm comm){
+
+    if (!session->enabled) return;
+
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    // Per rank totals; an event counts as available only if every thread could read it
+    long long mine[PERF_NEVENTS];
+    int available[PERF_NEVENTS];
+
+    for (int e = 0; e < PERF_NEVENTS; e++){
+
+        mine[e] = 0;
+        available[e] = 1;
+        for (int t = 0; t < session->nthreads; t++){
+            if (session->values[t][e] < 0) available[e] = 0;
+            else mine[e] += session->values[t][e];
+        }
+        if (!available[e]) mine[e] = 0;
+    }
+
+    long long sum[PERF_NEVENTS], max[PERF_NEVENTS];
+    int all_available[PERF_NEVENTS];
+
+    MPI_Reduce(mine, sum, PERF_NEVENTS, MPI_LONG_LONG, MPI_SUM, root, comm);
+    MPI_Reduce(mine, max, PERF_NEVENTS, MPI_LONG_LONG, MPI_MAX, root, comm);
+    MPI_Reduce(available, all_available, PERF_NEVENTS, MPI_INT, MPI_MIN, root, comm);
+
+    if (rank != root) return;
+
+    printf("Hardware counters of the compute phase (%d ranks x %d threads):\n", size, session->nthreads);
+
+    int any = 0;
+    for (int e = 0; e < PERF_NEVENTS; e++){
+
+        if (all_available[e]){
+            printf("  %-14s %18lld total %18lld max per rank\n", event_names[e], sum[e], max[e]);
+            any = 1;
+        } else {
+            printf("  %-14s %18s\n", event_names[e], "n/a");
+        }
+    }
+
+    if (!any){
+        printf("  no counter could be opened (check /proc/sys/kernel/perf_event_paranoid)\n");
+        return;
+    }
+
+    if (all_available[PERF_CYCLES] && all_available[PERF_INSTRUCTIONS] && sum[PERF_CYCLES] > 0){
+        printf("  IPC %.2f", (double)sum[PERF_INSTRUCTIONS] / sum[PERF_CYCLES]);
+        if (all_available[PERF_BRANCH_MISSES] && sum[PERF_INSTRUCTIONS] > 0){
+            printf(", branch misses per 1000 instructions %.2f", 1000.0 * sum[PERF_BRANCH_MISSES] / sum[PERF_INSTRUCTIONS]);
+        }
+        if (all_available[PERF_FP_OPS]){
+            printf(", flops per cycle %.2f", (double)sum[PERF_FP_OPS] / sum[PERF_CYCLES]);
+        }
+        printf("\n");
+    }
+}
+
+void perf_free(perf_session *session){
+
+    free(session->values);
+    session->values = NULL;
+}
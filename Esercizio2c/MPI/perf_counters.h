@@ -0,0 +1,32 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <mpi.h>
+
+// Hardware events read around the compute phase
+enum perf_event_id { PERF_CYCLES, PERF_INSTRUCTIONS, PERF_BRANCH_MISSES, PERF_FP_OPS, PERF_LLC_MISSES, PERF_NEVENTS };
+
+// Raw FP events of one vendor are summed, each multiplied by the number of doubles it counts
+#define PERF_MAX_FP_EVENTS 3
+
+// Counters of every thread of a rank; a value of -1 marks an event that could not be opened
+typedef struct {
+    int enabled;
+    int nthreads;
+    long long (*values)[PERF_NEVENTS];
+} perf_session;
+
+// Function that prepares a session for up to omp_get_max_threads() threads
+void perf_init(perf_session *session, int enabled);
+
+// Functions called by every OpenMP thread at the start and at the end of its compute phase.
+// They do nothing when the session is disabled, and leave -1 for the events the kernel refuses.
+void perf_thread_start(perf_session *session, int fds[PERF_NEVENTS][PERF_MAX_FP_EVENTS]);
+void perf_thread_stop(perf_session *session, int fds[PERF_NEVENTS][PERF_MAX_FP_EVENTS]);
+
+// Function that sums the counters over threads and ranks and prints them on root with derived ratios
+void perf_report(const perf_session *session, int root, MPI_Comm comm);
+
+void perf_free(perf_session *session);
+
+#endif
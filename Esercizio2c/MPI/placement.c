@@ -0,0 +1,200 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/syscall.h>
+#include <pthread.h>
+#include <mpi.h>
+#include <omp.h>
+
+#include "placement.h"
+
+#define MAX_CPUS 1024
+#define HOST_LEN 64
+
+// Map from logical CPU to NUMA node, read once from sysfs. cpu_node is called from inside
+// parallel regions, so the first load is guarded by pthread_once
+static int node_of_cpu[MAX_CPUS];
+static pthread_once_t nodes_once = PTHREAD_ONCE_INIT;
+
+// Function that parses a sysfs cpulist such as "0-7,16-23" and marks its CPUs as belonging to node
+static void mark_cpulist(const char *list, int node){
+
+    const char *p = list;
+    while (*p){
+
+        char *end;
+        long lo = strtol(p, &end, 10);
+        long hi = lo;
+        if (end == p) break;
+        if (*end == '-') hi = strtol(end + 1, &end, 10);
+
+        for (long c = lo; c <= hi && c < MAX_CPUS; c++) node_of_cpu[c] = node;
+
+        p = (*end == ',') ? end + 1 : end;
+        if (*p == '\n') break;
+    }
+}
+
+static void load_nodes(void){
+
+    DIR *dir = opendir("/sys/devices/system/node");
+    if (dir == NULL) return;
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL){
+
+        int node;
+        if (sscanf(entry->d_name, "node%d", &node) != 1) continue;
+
+        char path[300], list[4096];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/%s/cpulist", entry->d_name);
+
+        FILE *f = fopen(path, "r");
+        if (f == NULL) continue;
+        if (fgets(list, sizeof(list), f) != NULL) mark_cpulist(list, node);
+        fclose(f);
+    }
+
+    closedir(dir);
+}
+
+int cpu_node(int cpu){
+
+    pthread_once(&nodes_once, load_nodes);
+
+    return (cpu >= 0 && cpu < MAX_CPUS) ? node_of_cpu[cpu] : 0;
+}
+
+int page_node(const void *addr){
+
+#ifdef SYS_move_pages
+    // move_pages with no target nodes only reports where each page currently is
+    void *pages[1] = { (void*)addr };
+    int status[1] = { -1 };
+
+    if (syscall(SYS_move_pages, 0, 1UL, pages, NULL, status, 0) != 0 || status[0] < 0) return -1;
+
+    return status[0];
+#else
+    return -1;
+#endif
+}
+
+enum bind_policy parse_bind_policy(const char *name){
+
+    if (strcmp(name, "compact") == 0) return BIND_COMPACT;
+    if (strcmp(name, "scatter") == 0) return BIND_SCATTER;
+
+    return BIND_INVALID;
+}
+
+int bind_threads(enum bind_policy policy){
+
+    if (policy == BIND_NONE) return 0;
+
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return -1;
+
+    int cpus[MAX_CPUS], ncpus = 0;
+    for (int c = 0; c < MAX_CPUS && c < CPU_SETSIZE; c++){
+        if (CPU_ISSET(c, &allowed)) cpus[ncpus++] = c;
+    }
+    if (ncpus == 0) return -1;
+
+    // Scatter order: first CPU of every node, then the second one of every node, and so on
+    int order[MAX_CPUS];
+    if (policy == BIND_SCATTER){
+
+        int taken[MAX_CPUS] = {0};
+        int n = 0;
+        while (n < ncpus){
+
+            int round_nodes[MAX_CPUS], nround = 0;
+            for (int i = 0; i < ncpus; i++){
+
+                if (taken[i]) continue;
+                int node = cpu_node(cpus[i]), seen = 0;
+                for (int k = 0; k < nround && !seen; k++) seen = (round_nodes[k] == node);
+                if (seen) continue;
+
+                round_nodes[nround++] = node;
+                order[n++] = cpus[i];
+                taken[i] = 1;
+            }
+        }
+    } else {
+        memcpy(order, cpus, ncpus * sizeof(int));
+    }
+
+    int failures = 0;
+
+    #pragma omp parallel reduction(+:failures)
+    {
+        cpu_set_t mine;
+        CPU_ZERO(&mine);
+        CPU_SET(order[omp_get_thread_num() % ncpus], &mine);
+
+        if (sched_setaffinity(0, sizeof(mine), &mine) != 0) failures++;
+    }
+
+    return failures ? -1 : 0;
+}
+
+void report_topology(enum bind_policy policy, int root, MPI_Comm comm){
+
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    const int nthreads = omp_get_max_threads();
+
+    // Every rank describes its threads as (cpu, node) pairs
+    int *mine = malloc(2 * nthreads * sizeof(int));
+    for (int t = 0; t < 2 * nthreads; t++) mine[t] = -1;
+
+    #pragma omp parallel
+    {
+        int t = omp_get_thread_num();
+        int cpu = sched_getcpu();
+        mine[2 * t] = cpu;
+        mine[2 * t + 1] = cpu_node(cpu);
+    }
+
+    char host[HOST_LEN] = {0};
+    gethostname(host, HOST_LEN - 1);
+
+    int *all = NULL;
+    char *hosts = NULL;
+    if (rank == root){
+        all = malloc((size_t)size * 2 * nthreads * sizeof(int));
+        hosts = malloc((size_t)size * HOST_LEN);
+    }
+
+    MPI_Gather(mine, 2 * nthreads, MPI_INT, all, 2 * nthreads, MPI_INT, root, comm);
+    MPI_Gather(host, HOST_LEN, MPI_CHAR, hosts, HOST_LEN, MPI_CHAR, root, comm);
+
+    if (rank == root){
+
+        const char *names[] = {"none", "compact", "scatter"};
+        printf("Topology: %d ranks x %d threads, binding %s\n", size, nthreads, names[policy]);
+
+        for (int r = 0; r < size; r++){
+
+            printf("  rank %3d on %s:", r, hosts + (size_t)r * HOST_LEN);
+            for (int t = 0; t < nthreads; t++){
+                const int *entry = all + ((size_t)r * nthreads + t) * 2;
+                printf(" t%d->cpu%d/node%d", t, entry[0], entry[1]);
+            }
+            printf("\n");
+        }
+
+        free(all);
+        free(hosts);
+    }
+
+    free(mine);
+}
@@ -0,0 +1,25 @@
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include <mpi.h>
+
+// Thread binding policies inside the CPU set that the launcher gave to each rank
+enum bind_policy { BIND_INVALID = -1, BIND_NONE, BIND_COMPACT, BIND_SCATTER };
+
+// Function that parses "compact" or "scatter"; returns BIND_INVALID for anything else
+enum bind_policy parse_bind_policy(const char *name);
+
+// Function that pins every OpenMP thread of the calling rank to one CPU of its affinity mask:
+// compact fills the CPUs in order, scatter alternates between NUMA nodes. Returns 0 on success.
+int bind_threads(enum bind_policy policy);
+
+// Function that returns the NUMA node of the CPU a logical CPU id belongs to (0 if unknown)
+int cpu_node(int cpu);
+
+// Function that returns the NUMA node holding the page of addr, or -1 if it cannot be queried
+int page_node(const void *addr);
+
+// Function that prints on root where every thread of every rank is running
+void report_topology(enum bind_policy policy, int root, MPI_Comm comm);
+
+#endif
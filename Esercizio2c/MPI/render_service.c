@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <mpi.h>
+
+#include "render_service.h"
+
+#define LINE_LEN 512
+
+// Seconds a client has to send its request line once connected
+#define CLIENT_TIMEOUT 2
+
+static void reply(int client, const char *message){
+
+    if (client < 0) return;
+
+    size_t len = strlen(message);
+    if (write(client, message, len) != (ssize_t)len) perror("render service reply");
+    close(client);
+}
+
+static int open_socket(const char *path){
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if (strlen(path) >= sizeof(addr.sun_path)){
+        fprintf(stderr, "Socket path %s too long\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0){
+        perror("socket");
+        return -1;
+    }
+
+    unlink(path);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, SERVICE_QUEUE_LEN) != 0){
+        perror(path);
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+// Function that reads the request line of a new client; returns 1 for a valid request,
+// 0 for "quit" and -1 (after answering the client) for anything else
+static int read_request(int client, render_request *request){
+
+    struct timeval timeout = {CLIENT_TIMEOUT, 0};
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    char line[LINE_LEN];
+    size_t len = 0;
+
+    while (len < LINE_LEN - 1){
+
+        ssize_t n = read(client, line + len, LINE_LEN - 1 - len);
+        if (n <= 0) break;
+        len += n;
+        if (memchr(line, '\n', len) != NULL) break;
+    }
+    line[len] = '\0';
+
+    if (strncmp(line, "quit", 4) == 0){
+        reply(client, "BYE\n");
+        return 0;
+    }
+
+    memset(request, 0, sizeof(*request));
+    int fields = sscanf(line, "%d %d %lf %lf %lf %lf %d %255s", &request->xsize, &request->ysize,
+                        &request->xl, &request->yl, &request->xr, &request->yr, &request->max_iter, request->output);
+
+    if (fields != 8 || request->xsize <= 0 || request->ysize <= 0 || request->max_iter <= 0 ||
+        (long long)request->xsize * request->ysize * 2 > INT_MAX){
+
+        reply(client, "ERR expected: xsize ysize xl yl xr yr max_iter output_path\n");
+        return -1;
+    }
+
+    return 1;
+}
+
+int serve_requests(const char *path, render_handler handler, void *context, int root, MPI_Comm comm){
+
+    int rank;
+    MPI_Comm_rank(comm, &rank);
+
+    int listen_fd = (rank == root) ? open_socket(path) : 0;
+    MPI_Bcast(&listen_fd, 1, MPI_INT, root, comm);
+    if (listen_fd < 0) return -1;
+
+    if (rank == root) printf("Render service listening on %s\n", path);
+
+    render_request queue[SERVICE_QUEUE_LEN];
+    int clients[SERVICE_QUEUE_LEN];
+    int served = 0, quit = 0;
+
+    while (1){
+
+        int count = 0;
+
+        if (rank == root){
+
+            // Block until the first request, then batch whatever arrives within the window
+            while (!quit && count < SERVICE_QUEUE_LEN){
+
+                struct pollfd pfd = {listen_fd, POLLIN, 0};
+                int ready = poll(&pfd, 1, (count == 0) ? -1 : SERVICE_BATCH_WINDOW_MS);
+                if (ready <= 0) break;
+
+                int client = accept(listen_fd, NULL, NULL);
+                if (client < 0) continue;
+
+                int status = read_request(client, &queue[count]);
+                if (status == 1){
+                    clients[count++] = client;
+                } else if (status == 0){
+                    quit = 1;
+                }
+            }
+
+            if (count == 0 && quit) count = -1;
+        }
+
+        MPI_Bcast(&count, 1, MPI_INT, root, comm);
+        if (count < 0) break;
+
+        MPI_Bcast(queue, count * (int)sizeof(render_request), MPI_BYTE, root, comm);
+
+        for (int r = 0; r < count; r++){
+
+            double t0 = MPI_Wtime();
+            int status = handler(&queue[r], context);
+            double elapsed = MPI_Wtime() - t0;
+
+            if (rank == root){
+
+                char message[LINE_LEN];
+                if (status == 0){
+                    snprintf(message, sizeof(message), "OK %s %.6f\n", queue[r].output, elapsed);
+                } else {
+                    snprintf(message, sizeof(message), "ERR could not write %s\n", queue[r].output);
+                }
+                reply(clients[r], message);
+            }
+        }
+
+        served += count;
+    }
+
+    if (rank == root){
+        close(listen_fd);
+        unlink(path);
+    }
+
+    return served;
+}
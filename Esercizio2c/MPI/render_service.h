@@ -0,0 +1,31 @@
+#ifndef RENDER_SERVICE_H
+#define RENDER_SERVICE_H
+
+#include <mpi.h>
+
+// Maximum number of requests waiting on rank 0 and rendered in one batch
+#define SERVICE_QUEUE_LEN 64
+
+// Once a request arrived, rank 0 keeps accepting for this long before starting the batch
+#define SERVICE_BATCH_WINDOW_MS 2
+
+#define SERVICE_PATH_LEN 256
+
+// One render request, as sent by a client on a single line:
+// "xsize ysize xl yl xr yr max_iter output_path" (or "quit" to stop the service)
+typedef struct {
+    int xsize, ysize, max_iter;
+    double xl, yl, xr, yr;
+    char output[SERVICE_PATH_LEN];
+} render_request;
+
+// Called on every rank for every request; returns 0 when the image was written
+typedef int (*render_handler)(const render_request *request, void *context);
+
+// Function that keeps the job alive serving render requests until a client sends "quit".
+// Rank 0 listens on the UNIX domain socket at path, queues the requests, broadcasts them in
+// batches to the other ranks and answers each client with "OK <output> <seconds>" or "ERR <reason>".
+// Returns the number of requests served, or -1 if the socket could not be opened.
+int serve_requests(const char *path, render_handler handler, void *context, int root, MPI_Comm comm);
+
+#endif
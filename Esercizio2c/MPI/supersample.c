@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <complex.h>
+#include <mpi.h>
+#include <omp.h>
+
+#include "mandelbrot.h"
+#include "supersample.h"
+
+static inline int get_pixel(const void *image, size_t i, int pixel_size){
+
+    return (pixel_size == 1) ? ((const unsigned char*)image)[i] : ((const unsigned short*)image)[i];
+}
+
+static inline void set_pixel(void *image, size_t i, int value, int pixel_size){
+
+    if (pixel_size == 1){
+        ((unsigned char*)image)[i] = (unsigned char)value;
+    } else {
+        ((unsigned short*)image)[i] = (unsigned short)value;
+    }
+}
+
+// Function that computes one row of the base image, used for the rows just outside the local block
+static void compute_row(int *row, int xsize, int yy, double x_l, double y_l, double delta_x, double delta_y, int max_iter){
+
+    double imag = y_l + yy * delta_y;
+
+    #pragma omp parallel for schedule(dynamic, 64)
+    for (int xx = 0; xx < xsize; xx++){
+        row[xx] = mandelbrot((x_l + xx * delta_x) + imag * I, max_iter);
+    }
+}
+
+// Function that returns the mean iteration count over a samples x samples grid centred on the pixel
+static int refine_pixel(long long gidx, int xsize, double x_l, double y_l, double delta_x, double delta_y, int max_iter, int samples){
+
+    const int yy = (int)(gidx / xsize);
+    const int xx = (int)(gidx % xsize);
+    long sum = 0;
+
+    for (int j = 0; j < samples; j++){
+
+        double imag = y_l + (yy + (j + 0.5) / samples - 0.5) * delta_y;
+
+        for (int i = 0; i < samples; i++){
+
+            double real = x_l + (xx + (i + 0.5) / samples - 0.5) * delta_x;
+            sum += mandelbrot(real + imag * I, max_iter);
+        }
+    }
+
+    return (int)((sum + samples * samples / 2) / (samples * samples));
+}
+
+void adaptive_supersample(void *local_image, int xsize, int ysize, int start_row, int end_row,
+                          double complex c_L, double complex c_R, int max_iter,
+                          int samples, int threshold, MPI_Comm comm, supersample_stats *stats){
+
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    const int pixel_size = (max_iter < 256) ? sizeof(char) : sizeof(short int);
+    const int rows = end_row - start_row;
+
+    const double x_l = creal(c_L), y_l = cimag(c_L);
+    const double delta_x = (creal(c_R) - x_l) / xsize;
+    const double delta_y = (cimag(c_R) - y_l) / ysize;
+
+    double t0 = MPI_Wtime();
+
+    // The neighbours of the first and last local rows are recomputed instead of exchanged
+    int *above = malloc(xsize * sizeof(int));
+    int *below = malloc(xsize * sizeof(int));
+    if (rows > 0 && start_row > 0) compute_row(above, xsize, start_row - 1, x_l, y_l, delta_x, delta_y, max_iter);
+    if (rows > 0 && end_row < ysize) compute_row(below, xsize, end_row, x_l, y_l, delta_x, delta_y, max_iter);
+
+    // Edge detection: every thread marks its rows, then the marks are compacted in row order
+    unsigned char *edge = calloc((size_t)rows * xsize + 1, 1);
+
+    #pragma omp parallel for schedule(static)
+    for (int r = 0; r < rows; r++){
+
+        for (int xx = 0; xx < xsize; xx++){
+
+            size_t idx = (size_t)r * xsize + xx;
+            int v = get_pixel(local_image, idx, pixel_size);
+            int n[4];
+
+            n[0] = (xx > 0) ? get_pixel(local_image, idx - 1, pixel_size) : v;
+            n[1] = (xx < xsize - 1) ? get_pixel(local_image, idx + 1, pixel_size) : v;
+
+            if (r > 0) n[2] = get_pixel(local_image, idx - xsize, pixel_size);
+            else n[2] = (start_row > 0) ? above[xx] : v;
+
+            if (r < rows - 1) n[3] = get_pixel(local_image, idx + xsize, pixel_size);
+            else n[3] = (end_row < ysize) ? below[xx] : v;
+
+            for (int k = 0; k < 4; k++){
+                if (abs(v - n[k]) > threshold){
+                    edge[idx] = 1;
+                    break;
+                }
+            }
+        }
+    }
+
+    free(above);
+    free(below);
+
+    long long my_edges = 0;
+    for (size_t i = 0; i < (size_t)rows * xsize; i++) my_edges += edge[i];
+
+    long long *my_list = malloc((my_edges > 0 ? my_edges : 1) * sizeof(long long));
+    long long n_edges = 0;
+    for (size_t i = 0; i < (size_t)rows * xsize; i++){
+        if (edge[i]) my_list[n_edges++] = (long long)start_row * xsize + i;
+    }
+    free(edge);
+
+    // Load balancing: the edge lists concatenated in rank order are cut into equal shares
+    long long *counts = malloc((size_t)size * sizeof(long long));
+    MPI_Allgather(&my_edges, 1, MPI_LONG_LONG, counts, 1, MPI_LONG_LONG, comm);
+
+    long long total = 0, my_first = 0;
+    for (int i = 0; i < size; i++){
+        if (i < rank) my_first += counts[i];
+        total += counts[i];
+    }
+
+    int *send_counts = calloc((size_t)size, sizeof(int));
+    int *send_displs = calloc((size_t)size, sizeof(int));
+    int *recv_counts = calloc((size_t)size, sizeof(int));
+    int *recv_displs = calloc((size_t)size, sizeof(int));
+
+    for (int i = 0; i < size; i++){
+
+        long long share_start = total * i / size;
+        long long share_end = total * (i + 1) / size;
+        long long lo = (share_start > my_first) ? share_start : my_first;
+        long long hi = (share_end < my_first + my_edges) ? share_end : my_first + my_edges;
+
+        send_counts[i] = (hi > lo) ? (int)(hi - lo) : 0;
+        send_displs[i] = (hi > lo) ? (int)(lo - my_first) : 0;
+    }
+
+    MPI_Alltoall(send_counts, 1, MPI_INT, recv_counts, 1, MPI_INT, comm);
+
+    int my_work = 0;
+    for (int i = 0; i < size; i++){
+        recv_displs[i] = my_work;
+        my_work += recv_counts[i];
+    }
+
+    long long *work = malloc((my_work > 0 ? my_work : 1) * sizeof(long long));
+    MPI_Alltoallv(my_list, send_counts, send_displs, MPI_LONG_LONG, work, recv_counts, recv_displs, MPI_LONG_LONG, comm);
+
+    // Refinement of the assigned pixels: the cost per pixel varies a lot, hence the dynamic schedule
+    int *work_values = malloc((my_work > 0 ? my_work : 1) * sizeof(int));
+
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (int w = 0; w < my_work; w++){
+        work_values[w] = refine_pixel(work[w], xsize, x_l, y_l, delta_x, delta_y, max_iter, samples);
+    }
+
+    // The refined values travel back to the owners in the order the pixels were sent
+    int *values = malloc((my_edges > 0 ? my_edges : 1) * sizeof(int));
+    MPI_Alltoallv(work_values, recv_counts, recv_displs, MPI_INT, values, send_counts, send_displs, MPI_INT, comm);
+
+    for (long long e = 0; e < my_edges; e++){
+        set_pixel(local_image, (size_t)(my_list[e] - (long long)start_row * xsize), values[e], pixel_size);
+    }
+
+    double my_time = MPI_Wtime() - t0;
+    long long my_work_ll = my_work;
+
+    stats->edge_pixels = total;
+    MPI_Reduce(&my_work_ll, &stats->max_work, 1, MPI_LONG_LONG, MPI_MAX, 0, comm);
+    MPI_Reduce(&my_time, &stats->time, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+
+    free(my_list);
+    free(counts);
+    free(send_counts);
+    free(send_displs);
+    free(recv_counts);
+    free(recv_displs);
+    free(work);
+    free(work_values);
+    free(values);
+}
@@ -0,0 +1,25 @@
+#ifndef SUPERSAMPLE_H
+#define SUPERSAMPLE_H
+
+#include <complex.h>
+#include <mpi.h>
+
+// Default samples per axis of a refined pixel and iteration difference that marks an edge
+#define AA_SAMPLES 3
+#define AA_THRESHOLD 4
+
+// Statistics of the refinement stage (meaningful on the root rank)
+typedef struct {
+    long long edge_pixels;  // pixels supersampled over the whole image
+    long long max_work;     // largest number of pixels refined by a single rank
+    double time;            // slowest rank refinement time
+} supersample_stats;
+
+// Replaces the pixels of the local rows [start_row, end_row) whose iteration count differs from
+// a 4-neighbour by more than threshold with the mean of samples x samples sub-pixel evaluations.
+// The edge pixels of all ranks are redistributed evenly before being refined.
+void adaptive_supersample(void *local_image, int xsize, int ysize, int start_row, int end_row,
+                          double complex c_L, double complex c_R, int max_iter,
+                          int samples, int threshold, MPI_Comm comm, supersample_stats *stats);
+
+#endif
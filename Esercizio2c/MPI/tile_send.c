@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <mpi.h>
+#include <omp.h>
+
+#include "tile_send.h"
+
+// First row of rank r, with the rows split as evenly as in the funneled gather
+static int block_start(int r, int ysize, int size){
+
+    const int rows_per_P = ysize / size;
+    const int rem = ysize % size;
+
+    return r * rows_per_P + ((r < rem) ? r : rem);
+}
+
+static int count_tiles(int ysize, int size, int tile_rows){
+
+    int tiles = 0;
+    for (int r = 0; r < size; r++){
+        int rows = block_start(r + 1, ysize, size) - block_start(r, ysize, size);
+        tiles += (rows + tile_rows - 1) / tile_rows;
+    }
+
+    return tiles;
+}
+
+// Per tile timestamps, filled by the thread that owns the tile
+typedef struct {
+    double computed;
+    double send_start;
+    double send_end;
+} tile_times;
+
+// Function that computes local tile t and, outside root, sends it with the global tile index as tag
+static inline void process_tile(int t, char *buffer, int start_row, int end_row, int first_tile, int tile_rows, size_t row_bytes,
+                                tile_kernel kernel, void *context, int is_root, int root, MPI_Comm comm, tile_times *times){
+
+    const int first_row = start_row + t * tile_rows;
+    const int rows = (end_row - first_row < tile_rows) ? end_row - first_row : tile_rows;
+    char *tile = buffer + (size_t)t * tile_rows * row_bytes;
+
+    kernel(tile, first_row, rows, context);
+    times[t].computed = MPI_Wtime();
+
+    if (!is_root){
+        times[t].send_start = times[t].computed;
+        MPI_Send(tile, (int)(rows * row_bytes), MPI_BYTE, root, first_tile + t, comm);
+        times[t].send_end = MPI_Wtime();
+    } else {
+        times[t].send_start = times[t].send_end = times[t].computed;
+    }
+}
+
+void *render_tiles_multiple(int xsize, int ysize, int pixel_size, int tile_rows, tile_kernel kernel, void *context,
+                            perf_session *perf, int runtime_schedule, int root, MPI_Comm comm, tile_send_stats *stats){
+
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    if (tile_rows < 1) tile_rows = TILE_ROWS;
+
+    // Private communicator, so that the tile tags cannot match any other message
+    MPI_Comm tile_comm;
+    MPI_Comm_dup(comm, &tile_comm);
+
+    // Tiles are made larger until every global index fits in a tag
+    int *tag_ub, flag;
+    MPI_Comm_get_attr(tile_comm, MPI_TAG_UB, &tag_ub, &flag);
+    while (flag && count_tiles(ysize, size, tile_rows) > *tag_ub) tile_rows *= 2;
+
+    const size_t row_bytes = (size_t)xsize * pixel_size;
+    const int start_row = block_start(rank, ysize, size);
+    const int end_row = block_start(rank + 1, ysize, size);
+    const int ntiles = (end_row - start_row + tile_rows - 1) / tile_rows;
+    const int total_tiles = count_tiles(ysize, size, tile_rows);
+
+    int first_tile = 0;
+    for (int r = 0; r < rank; r++){
+        first_tile += (block_start(r + 1, ysize, size) - block_start(r, ysize, size) + tile_rows - 1) / tile_rows;
+    }
+
+    // Root receives every remote tile straight into its place in the image and computes its own rows in place
+    char *image = NULL, *buffer;
+    MPI_Request *requests = NULL;
+    int nrequests = 0;
+
+    if (rank == root){
+
+        image = malloc((size_t)ysize * row_bytes);
+        requests = malloc((total_tiles > 0 ? total_tiles : 1) * sizeof(MPI_Request));
+
+        int tile = 0;
+        for (int r = 0; r < size; r++){
+
+            const int rs = block_start(r, ysize, size);
+            const int re = block_start(r + 1, ysize, size);
+
+            for (int row = rs; row < re; row += tile_rows, tile++){
+                if (r == root) continue;
+                int rows = (re - row < tile_rows) ? re - row : tile_rows;
+                MPI_Irecv(image + (size_t)row * row_bytes, (int)(rows * row_bytes), MPI_BYTE, r, tile, tile_comm, &requests[nrequests++]);
+            }
+        }
+
+        buffer = image + (size_t)start_row * row_bytes;
+
+    } else {
+        buffer = malloc((end_row > start_row ? end_row - start_row : 1) * row_bytes);
+    }
+
+    tile_times *times = malloc((ntiles > 0 ? ntiles : 1) * sizeof(tile_times));
+    const double t0 = MPI_Wtime();
+
+    #pragma omp parallel
+    {
+        int perf_fds[PERF_NEVENTS][PERF_MAX_FP_EVENTS];
+        perf_thread_start(perf, perf_fds);
+
+        if (runtime_schedule){
+            #pragma omp for schedule(runtime)
+            for (int t = 0; t < ntiles; t++){
+                process_tile(t, buffer, start_row, end_row, first_tile, tile_rows, row_bytes, kernel, context, rank == root, root, tile_comm, times);
+            }
+        } else {
+            #pragma omp for schedule(dynamic)
+            for (int t = 0; t < ntiles; t++){
+                process_tile(t, buffer, start_row, end_row, first_tile, tile_rows, row_bytes, kernel, context, rank == root, root, tile_comm, times);
+            }
+        }
+
+        perf_thread_stop(perf, perf_fds);
+    }
+
+    // The rank stops computing when its last tile is done; sends before that point overlapped compute
+    double compute_end = t0, last_send = t0;
+    for (int t = 0; t < ntiles; t++){
+        if (times[t].computed > compute_end) compute_end = times[t].computed;
+        if (times[t].send_end > last_send) last_send = times[t].send_end;
+    }
+
+    double my_times[2] = {0.0, 0.0};
+    for (int t = 0; t < ntiles; t++){
+        double overlap_end = (times[t].send_end < compute_end) ? times[t].send_end : compute_end;
+        my_times[0] += times[t].send_end - times[t].send_start;
+        if (overlap_end > times[t].send_start) my_times[1] += overlap_end - times[t].send_start;
+    }
+
+    if (rank == root){
+        MPI_Waitall(nrequests, requests, MPI_STATUSES_IGNORE);
+        last_send = MPI_Wtime();
+    }
+
+    double my_exposed = (last_send > compute_end) ? last_send - compute_end : 0.0;
+
+    double sums[2];
+    MPI_Reduce(my_times, sums, 2, MPI_DOUBLE, MPI_SUM, root, tile_comm);
+    MPI_Reduce(&my_exposed, &stats->exposed_time, 1, MPI_DOUBLE, MPI_MAX, root, tile_comm);
+
+    stats->tiles = total_tiles;
+    stats->tile_rows = tile_rows;
+    stats->send_time = sums[0];
+    stats->hidden_time = sums[1];
+
+    if (rank != root) free(buffer);
+    free(times);
+    free(requests);
+    MPI_Comm_free(&tile_comm);
+
+    return image;
+}
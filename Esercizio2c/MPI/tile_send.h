@@ -0,0 +1,30 @@
+#ifndef TILE_SEND_H
+#define TILE_SEND_H
+
+#include <mpi.h>
+
+#include "perf_counters.h"
+
+// Default number of image rows computed and sent together as one tile
+#define TILE_ROWS 8
+
+// Statistics of a threaded tile render (meaningful on the root rank)
+typedef struct {
+    int tiles;              // tiles over the whole image
+    int tile_rows;
+    double send_time;       // time spent by all threads of all ranks inside MPI_Send
+    double hidden_time;     // part of send_time that ran while another thread of the rank was still computing
+    double exposed_time;    // slowest rank time between the end of its compute and its last tile delivered
+} tile_send_stats;
+
+// Function computing rows [first_row, first_row + rows) of the image into buffer, row first_row at its start
+typedef void (*tile_kernel)(void *buffer, int first_row, int rows, void *context);
+
+// Renders the image with the same block of rows per rank as the funneled gather, but every OpenMP
+// thread sends each tile to root as soon as it is computed, tagged with the global tile index,
+// while the root threads compute their rows in place and receive into pre-posted requests.
+// Requires MPI_THREAD_MULTIPLE. Returns the full image on root, NULL elsewhere.
+void *render_tiles_multiple(int xsize, int ysize, int pixel_size, int tile_rows, tile_kernel kernel, void *context,
+                            perf_session *perf, int runtime_schedule, int root, MPI_Comm comm, tile_send_stats *stats);
+
+#endif